@@ -0,0 +1,85 @@
+# Compile-time benchmark, run through the `compile-bench` target or directly:
+#
+#     cmake -DSOURCE_DIR=<repo> -DBINARY_DIR=<scratch dir> [-DGENERATOR=Ninja] [-DJOBS=8] -P cmake/CompileBench.cmake
+#
+# Configures a fresh build tree per header strategy, then reports the time of a clean build of
+# btc-price-tracker and of an incremental rebuild after touching one source that includes
+# json.hpp and httplib.h (src/backfill.cpp).
+cmake_minimum_required(VERSION 3.16)
+
+if (NOT SOURCE_DIR OR NOT BINARY_DIR)
+    message(FATAL_ERROR "CompileBench: pass -DSOURCE_DIR=<repo> -DBINARY_DIR=<scratch dir>")
+endif()
+if (NOT JOBS)
+    cmake_host_system_information(RESULT JOBS QUERY NUMBER_OF_LOGICAL_CORES)
+endif()
+set(generator_args)
+if (GENERATOR)
+    set(generator_args -G "${GENERATOR}")
+endif()
+
+# Milliseconds since the epoch (whole seconds before CMake 3.23, which added %f)
+function(now_ms out)
+    if (CMAKE_VERSION VERSION_GREATER_EQUAL 3.23)
+        string(TIMESTAMP seconds "%s" UTC)
+        string(TIMESTAMP micros "%f" UTC)
+        math(EXPR ms "${seconds} * 1000 + ${micros} / 1000")
+    else()
+        string(TIMESTAMP seconds "%s" UTC)
+        math(EXPR ms "${seconds} * 1000")
+    endif()
+    set(${out} ${ms} PARENT_SCOPE)
+endfunction()
+
+function(format_seconds ms out)
+    math(EXPR whole "${ms} / 1000")
+    math(EXPR tenths "(${ms} % 1000) / 100")
+    set(${out} "${whole}.${tenths}s" PARENT_SCOPE)
+endfunction()
+
+function(timed_build dir out)
+    now_ms(start)
+    execute_process(COMMAND ${CMAKE_COMMAND} --build "${dir}" --target btc-price-tracker --parallel ${JOBS}
+                    RESULT_VARIABLE result OUTPUT_QUIET ERROR_VARIABLE errors)
+    now_ms(finish)
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "CompileBench: build in ${dir} failed:\n${errors}")
+    endif()
+    math(EXPR elapsed "${finish} - ${start}")
+    set(${out} ${elapsed} PARENT_SCOPE)
+endfunction()
+
+# name|option,option,...
+set(variants
+    "single-header|-DBTC_PRECOMPILED_HEADERS=OFF,-DBTC_SPLIT_HTTPLIB=OFF,-DBTC_UNITY_BUILD=OFF"
+    "pch|-DBTC_PRECOMPILED_HEADERS=ON,-DBTC_SPLIT_HTTPLIB=OFF,-DBTC_UNITY_BUILD=OFF"
+    "split|-DBTC_PRECOMPILED_HEADERS=OFF,-DBTC_SPLIT_HTTPLIB=ON,-DBTC_UNITY_BUILD=OFF"
+    "split+pch|-DBTC_PRECOMPILED_HEADERS=ON,-DBTC_SPLIT_HTTPLIB=ON,-DBTC_UNITY_BUILD=OFF"
+    "split+unity|-DBTC_PRECOMPILED_HEADERS=OFF,-DBTC_SPLIT_HTTPLIB=ON,-DBTC_UNITY_BUILD=ON"
+)
+
+message(STATUS "Compile-time benchmark, ${JOBS} jobs")
+foreach(variant IN LISTS variants)
+    string(FIND "${variant}" "|" separator)
+    string(SUBSTRING "${variant}" 0 ${separator} name)
+    math(EXPR separator "${separator} + 1")
+    string(SUBSTRING "${variant}" ${separator} -1 options)
+    string(REPLACE "," ";" options "${options}")
+    string(REPLACE "+" "-" dir_name "${name}")
+    set(dir "${BINARY_DIR}/${dir_name}")
+    file(REMOVE_RECURSE "${dir}")
+    execute_process(COMMAND ${CMAKE_COMMAND} -S "${SOURCE_DIR}" -B "${dir}" ${generator_args} ${options}
+                    RESULT_VARIABLE result OUTPUT_QUIET ERROR_VARIABLE errors)
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "CompileBench: configuring ${name} failed:\n${errors}")
+    endif()
+    timed_build("${dir}" clean_ms)
+    file(TOUCH "${SOURCE_DIR}/src/backfill.cpp")
+    timed_build("${dir}" incremental_ms)
+    format_seconds(${clean_ms} clean)
+    format_seconds(${incremental_ms} incremental)
+    string(LENGTH "${name}" length)
+    math(EXPR padding "18 - ${length}")
+    string(REPEAT " " ${padding} pad)
+    message(STATUS "  ${name}${pad}clean ${clean}  incremental ${incremental}")
+endforeach()
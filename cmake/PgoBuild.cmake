@@ -0,0 +1,51 @@
+# Profile-guided, link-time optimized build in one command:
+#
+#     cmake -DSOURCE_DIR=<repo> -DBINARY_DIR=<build dir> [-DRECORDING=<file>] [-DCONFIG=<file>]
+#           [-DGENERATOR=Ninja] [-DJOBS=8] [-DLTO=OFF] -P cmake/PgoBuild.cmake
+#
+# Builds an instrumented Release tree (BTC_PGO=GENERATE), trains it with the pgo-train target
+# (btc-bench stages, plus RECORDING replayed through the tracker when given), then rebuilds the
+# same tree with the profile (BTC_PGO=USE) and link-time optimization.
+cmake_minimum_required(VERSION 3.16)
+
+if (NOT SOURCE_DIR OR NOT BINARY_DIR)
+    message(FATAL_ERROR "PgoBuild: pass -DSOURCE_DIR=<repo> -DBINARY_DIR=<build dir>")
+endif()
+if (NOT JOBS)
+    cmake_host_system_information(RESULT JOBS QUERY NUMBER_OF_LOGICAL_CORES)
+endif()
+if (NOT DEFINED LTO)
+    set(LTO ON)
+endif()
+set(generator_args)
+if (GENERATOR)
+    set(generator_args -G "${GENERATOR}")
+endif()
+get_filename_component(BINARY_DIR "${BINARY_DIR}" ABSOLUTE)
+set(profile_dir "${BINARY_DIR}/pgo")
+
+function(run step)
+    message(STATUS "PgoBuild: ${step}")
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result)
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "PgoBuild: ${step} failed")
+    endif()
+endfunction()
+
+function(configure pgo lto)
+    run("configuring with BTC_PGO=${pgo} BTC_LTO=${lto}"
+        ${CMAKE_COMMAND} -S "${SOURCE_DIR}" -B "${BINARY_DIR}" ${generator_args}
+        -DCMAKE_BUILD_TYPE=Release -DBTC_PGO=${pgo} -DBTC_LTO=${lto} "-DBTC_PGO_DIR=${profile_dir}"
+        "-DBTC_PGO_RECORDING=${RECORDING}" "-DBTC_PGO_CONFIG=${CONFIG}")
+endfunction()
+
+# Instrumented build; profiles of an earlier training would be merged into the new ones
+file(REMOVE_RECURSE "${profile_dir}")
+configure(GENERATE OFF)
+run("building the instrumented programs" ${CMAKE_COMMAND} --build "${BINARY_DIR}" --parallel ${JOBS})
+
+run("training" ${CMAKE_COMMAND} --build "${BINARY_DIR}" --target pgo-train)
+
+configure(USE ${LTO})
+run("building the optimized programs" ${CMAKE_COMMAND} --build "${BINARY_DIR}" --parallel ${JOBS})
+message(STATUS "PgoBuild: done, programs are in ${BINARY_DIR}")
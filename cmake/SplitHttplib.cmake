@@ -0,0 +1,34 @@
+# Split the single-header cpp-httplib into a declarations header and an implementation
+# source, the same way upstream's split.py does: everything between the two border lines
+# is implementation, moved to httplib.cc with the `inline` keywords removed.
+#
+# split_httplib(<input header> <output directory>) writes <output directory>/httplib.h and
+# <output directory>/httplib.cc; unchanged outputs keep their timestamps.
+function(split_httplib input output_dir)
+    set(border "// ----------------------------------------------------------------------------\n")
+    string(LENGTH "${border}" border_length)
+    file(READ "${input}" content)
+
+    string(FIND "${content}" "${border}" first)
+    if (first EQUAL -1)
+        message(FATAL_ERROR "split_httplib: no implementation border in ${input}")
+    endif()
+    string(SUBSTRING "${content}" 0 ${first} head)
+    math(EXPR rest_start "${first} + ${border_length}")
+    string(SUBSTRING "${content}" ${rest_start} -1 rest)
+
+    string(FIND "${rest}" "${border}" second)
+    if (second EQUAL -1)
+        message(FATAL_ERROR "split_httplib: unterminated implementation section in ${input}")
+    endif()
+    string(SUBSTRING "${rest}" 0 ${second} implementation)
+    math(EXPR tail_start "${second} + ${border_length}")
+    string(SUBSTRING "${rest}" ${tail_start} -1 tail)
+    string(REPLACE "inline " "" implementation "${implementation}")
+
+    file(WRITE "${output_dir}/httplib.h.tmp" "${head}${tail}")
+    file(WRITE "${output_dir}/httplib.cc.tmp" "#include \"httplib.h\"\nnamespace httplib {\n${implementation}} // namespace httplib\n")
+    configure_file("${output_dir}/httplib.h.tmp" "${output_dir}/httplib.h" COPYONLY)
+    configure_file("${output_dir}/httplib.cc.tmp" "${output_dir}/httplib.cc" COPYONLY)
+    file(REMOVE "${output_dir}/httplib.h.tmp" "${output_dir}/httplib.cc.tmp")
+endfunction()
@@ -0,0 +1,418 @@
+/*
+ * Price alerts
+ * See alerts.h for an overview and the rules file format.
+ */
+
+#include "alerts.h"
+
+#include <httplib.h> // For webhook delivery
+#include "json.h" // For the rules file
+#include <algorithm> // For std::max and binary search over price levels
+#include <chrono> // For alert timestamps
+#include <cmath> // For log returns and standard deviation
+#include <cstdio> // For the alert file
+#include <fstream> // For reading the rules file
+#include <iostream> // For the terminal bell
+#include <limits> // For quiet NaN
+#include <memory> // For the webhook client
+
+#include "logger.h" // For delivery errors
+#include "placement.h" // For the dispatcher thread's placement
+#include "timefmt.h" // For alert timestamps
+
+namespace Alerts {
+
+    namespace {
+
+        // Split "http://host:port/path" into "http://host:port" and "/path"
+        void splitUrl(const std::string& url, std::string& base, std::string& path) {
+            const auto scheme = url.find("://");
+            const auto slash = url.find('/', scheme == std::string::npos ? 0 : scheme + 3);
+            base = slash == std::string::npos ? url : url.substr(0, slash);
+            path = slash == std::string::npos ? "/" : url.substr(slash);
+        }
+
+        // JSON text for an alert, shared by the file and webhook actions
+        std::string eventJson(const Rule& rule, const AlertEvent& event) {
+            const auto time = std::chrono::system_clock::time_point(std::chrono::milliseconds(event.timestampMs));
+            char price[Pricing::MAX_PRICE_CHARS];
+            const std::size_t priceLength = Pricing::formatPrice(price, sizeof(price), event.price, event.price.scale, '\0');
+            nlohmann::ordered_json j = {
+                { "ts", std::string(TimeFormat::iso8601Utc(time).view()) },
+                { "rule", rule.name },
+                { "asset", rule.asset },
+                { "type", ruleTypeName(rule.type) },
+                { "price", std::string(price, priceLength) },
+            };
+            if (rule.type == RuleType::PercentMove) {
+                j["move_percent"] = event.value;
+            } else if (rule.type == RuleType::VolatilitySpike) {
+                j["z_score"] = event.value;
+            }
+            return j.dump();
+        }
+
+    } // namespace
+
+    const char* ruleTypeName(RuleType type) {
+        switch (type) {
+            case RuleType::CrossAbove: return "cross_above";
+            case RuleType::CrossBelow: return "cross_below";
+            case RuleType::PercentMove: return "percent_move";
+            case RuleType::VolatilitySpike: return "volatility_spike";
+        }
+        return "unknown";
+    }
+
+    bool loadRules(const std::string& path, const Pricing::CurrencySpec& currency,
+                   std::vector<Rule>& rules, SinkConfig& sinks, std::string& error) {
+        std::ifstream input(path);
+        if (!input) {
+            error = "cannot open " + path;
+            return false;
+        }
+        try {
+            const nlohmann::json root = nlohmann::json::parse(input);
+            if (root.contains("sinks")) {
+                const auto& sinkJson = root.at("sinks");
+                sinks.filePath = sinkJson.value("file", sinks.filePath);
+                sinks.webhookUrl = sinkJson.value("webhook", sinks.webhookUrl);
+            }
+            for (const auto& item : root.at("rules")) {
+                Rule rule;
+                rule.asset = item.at("asset").get<std::string>();
+                const std::string type = item.at("type").get<std::string>();
+                rule.name = item.value("name", rule.asset + ":" + type + ":" + std::to_string(rules.size()));
+                if (type == "cross_above" || type == "cross_below") {
+                    rule.type = type == "cross_above" ? RuleType::CrossAbove : RuleType::CrossBelow;
+                    // Re-read the threshold from its JSON text so it is exact in fixed point
+                    if (!Pricing::parsePrice(item.at("threshold").dump(), currency.scale, rule.threshold)) {
+                        error = "rule '" + rule.name + "': invalid threshold";
+                        return false;
+                    }
+                } else if (type == "percent_move" || type == "volatility_spike") {
+                    rule.type = type == "percent_move" ? RuleType::PercentMove : RuleType::VolatilitySpike;
+                    (rule.type == RuleType::PercentMove ? rule.percent : rule.sigma) =
+                        item.at(rule.type == RuleType::PercentMove ? "percent" : "sigma").get<double>();
+                    rule.windowMs = static_cast<std::int64_t>(item.at("window_s").get<double>() * 1000.0);
+                    if (rule.windowMs <= 0) {
+                        error = "rule '" + rule.name + "': window_s must be positive";
+                        return false;
+                    }
+                } else {
+                    error = "rule '" + rule.name + "': unknown type '" + type + "'";
+                    return false;
+                }
+                if (item.contains("actions")) {
+                    rule.actions = 0;
+                    for (const auto& action : item.at("actions")) {
+                        const std::string name = action.get<std::string>();
+                        rule.actions |= name == "file" ? ACTION_FILE : name == "webhook" ? ACTION_WEBHOOK : name == "bell" ? ACTION_BELL : 0;
+                    }
+                }
+                rules.push_back(std::move(rule));
+            }
+        } catch (const nlohmann::json::exception& e) {
+            error = path + ": " + e.what();
+            return false;
+        }
+        return true;
+    }
+
+    AlertDispatcher::~AlertDispatcher() {
+        stop();
+    }
+
+    void AlertDispatcher::start(const std::vector<Rule>& rules, SinkConfig sinks) {
+        rules_ = &rules;
+        sinks_ = std::move(sinks);
+        running_ = true;
+        worker_ = std::thread(&AlertDispatcher::run, this);
+    }
+
+    void AlertDispatcher::stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        wake_.notify_all();
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+    }
+
+    void AlertDispatcher::dispatch(const AlertEvent& event) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) {
+                return;
+            }
+            queue_.push_back(event);
+        }
+        wake_.notify_one();
+    }
+
+    void AlertDispatcher::run() {
+        Placement::enter(Placement::Stage::Alerts);
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this] { return !queue_.empty() || !running_; });
+            if (queue_.empty()) {
+                return; // Stopped and drained
+            }
+            const AlertEvent event = queue_.front();
+            queue_.pop_front();
+            lock.unlock();
+            deliver(event);
+            lock.lock();
+        }
+    }
+
+    void AlertDispatcher::deliver(const AlertEvent& event) {
+        const Rule& rule = (*rules_)[event.ruleId];
+        const std::string json = eventJson(rule, event);
+        if ((rule.actions & ACTION_FILE) && !sinks_.filePath.empty()) {
+            if (std::FILE* file = std::fopen(sinks_.filePath.c_str(), "a")) {
+                std::fprintf(file, "%s\n", json.c_str());
+                std::fclose(file);
+            } else {
+                Logging::error("Cannot write alert file", { { "path", sinks_.filePath } });
+            }
+        }
+        if ((rule.actions & ACTION_WEBHOOK) && !sinks_.webhookUrl.empty()) {
+            static std::unique_ptr<httplib::Client> client; // Only used from the dispatcher thread
+            static std::string clientBase;
+            std::string base;
+            std::string path;
+            splitUrl(sinks_.webhookUrl, base, path);
+            if (!client || clientBase != base) {
+                client = std::make_unique<httplib::Client>(base);
+                client->set_connection_timeout(2);
+                client->set_read_timeout(2);
+                clientBase = base;
+            }
+            auto res = client->Post(path, json, "application/json");
+            if (!res || res->status >= 300) {
+                Logging::error("Alert webhook failed", { { "url", sinks_.webhookUrl }, { "status", res ? res->status : 0 } });
+            }
+        }
+        if (rule.actions & ACTION_BELL) {
+            std::cout << '\a' << std::flush;
+        }
+    }
+
+    void PriceLevelIndex::add(std::int64_t level, std::uint32_t ruleId) {
+        levels_.push_back(level);
+        ruleIds_.push_back(ruleId);
+    }
+
+    void PriceLevelIndex::build() {
+        std::vector<std::size_t> order(levels_.size());
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) { return levels_[a] < levels_[b]; });
+        std::vector<std::int64_t> levels(levels_.size());
+        std::vector<std::uint32_t> ruleIds(ruleIds_.size());
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            levels[i] = levels_[order[i]];
+            ruleIds[i] = ruleIds_[order[i]];
+        }
+        levels_ = std::move(levels);
+        ruleIds_ = std::move(ruleIds);
+    }
+
+    void PriceLevelIndex::crossedUp(std::int64_t previous, std::int64_t current, std::vector<std::uint32_t>& out) const {
+        auto it = std::upper_bound(levels_.begin(), levels_.end(), previous);
+        const auto end = std::upper_bound(it, levels_.end(), current);
+        out.insert(out.end(), ruleIds_.begin() + (it - levels_.begin()), ruleIds_.begin() + (end - levels_.begin()));
+    }
+
+    void PriceLevelIndex::crossedDown(std::int64_t previous, std::int64_t current, std::vector<std::uint32_t>& out) const {
+        auto it = std::lower_bound(levels_.begin(), levels_.end(), current);
+        const auto end = std::lower_bound(it, levels_.end(), previous);
+        out.insert(out.end(), ruleIds_.begin() + (it - levels_.begin()), ruleIds_.begin() + (end - levels_.begin()));
+    }
+
+    AlertEngine::AlertEngine(const std::vector<Rule>& rules, AlertDispatcher& dispatcher)
+        : dispatcher_(dispatcher), ruleCount_(rules.size()) {
+        assets_.reserve(rules.size()); // At most one table per rule, so tables_ never dangles
+        for (std::uint32_t id = 0; id < rules.size(); ++id) {
+            const Rule& rule = rules[id];
+            const Symbols::Id asset = Symbols::intern(rule.asset);
+            AssetTable*& table = tables_[asset];
+            if (table == nullptr) {
+                table = &assets_.emplace_back();
+                table->asset = asset;
+            }
+            switch (rule.type) {
+                case RuleType::CrossAbove:
+                case RuleType::CrossBelow: {
+                    (rule.type == RuleType::CrossAbove ? table->above : table->below).add(rule.threshold.units, id);
+                    break;
+                }
+                case RuleType::PercentMove:
+                case RuleType::VolatilitySpike: {
+                    auto& groups = rule.type == RuleType::PercentMove ? table->percentGroups : table->volatilityGroups;
+                    WindowGroup& group = groupFor(groups, rule.windowMs);
+                    group.limits.push_back(rule.type == RuleType::PercentMove ? rule.percent : rule.sigma);
+                    group.ruleIds.push_back(id);
+                    group.active.push_back(0);
+                    table->maxWindowMs = std::max(table->maxWindowMs, rule.windowMs);
+                    break;
+                }
+            }
+        }
+        for (auto& table : assets_) {
+            table.above.build();
+            table.below.build();
+        }
+    }
+
+    AlertEngine::WindowGroup& AlertEngine::groupFor(std::vector<WindowGroup>& groups, std::int64_t windowMs) {
+        for (auto& group : groups) {
+            if (group.windowMs == windowMs) {
+                return group;
+            }
+        }
+        WindowGroup& group = groups.emplace_back();
+        group.windowMs = windowMs;
+        return group;
+    }
+
+    double AlertEngine::percentMove(AssetTable& table, WindowGroup& group, std::int64_t timestampMs) {
+        // Reference price: the oldest tick inside the window (needs an earlier tick than the latest)
+        const auto& history = table.history;
+        const std::uint64_t latest = table.firstSeq + history.size() - 1;
+        const std::int64_t windowStart = timestampMs - group.windowMs;
+        group.start = std::max(group.start, table.firstSeq);
+        while (group.start < latest && history[group.start - table.firstSeq].timestampMs < windowStart) {
+            ++group.start;
+        }
+        const std::int64_t reference = history[group.start - table.firstSeq].units;
+        if (group.start == latest || reference <= 0) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        return std::fabs(static_cast<double>(history.back().units - reference)) * 100.0 / static_cast<double>(reference);
+    }
+
+    void AlertEngine::addReturn(WindowGroup& group, double r, int sign) {
+        // A drop to a zero price is an infinite return; keep it out of the sums so they
+        // recover once it leaves the window
+        if (std::isinf(r)) {
+            group.infinite += sign;
+            return;
+        }
+        group.sum += sign * r;
+        group.sumSquares += sign * r * r;
+        group.count += sign;
+    }
+
+    double AlertEngine::volatilityScore(AssetTable& table, WindowGroup& group, std::int64_t timestampMs) {
+        // z-score of the latest log return against the earlier returns in the window
+        const auto& history = table.history;
+        auto at = [&](std::uint64_t seq) { return history[seq - table.firstSeq].units; };
+        auto logReturn = [&](std::uint64_t end) { return std::log(static_cast<double>(at(end)) / static_cast<double>(at(end - 1))); };
+        const std::uint64_t latest = table.firstSeq + history.size() - 1;
+        // Add the returns that became "earlier" than the latest one; a return whose start already
+        // left the longest window is outside this one too
+        group.start = std::max(group.start, table.firstSeq);
+        for (; group.next < latest; ++group.next) {
+            if (group.next - 1 >= group.start && at(group.next - 1) > 0) {
+                addReturn(group, logReturn(group.next), 1);
+            }
+        }
+        // Evict the returns starting before the window
+        const std::int64_t windowStart = timestampMs - group.windowMs;
+        while (group.start + 1 < group.next && history[group.start - table.firstSeq].timestampMs < windowStart) {
+            if (at(group.start) > 0) {
+                addReturn(group, logReturn(group.start + 1), -1);
+            }
+            ++group.start;
+        }
+        if (group.count == 0) {
+            group.sum = group.sumSquares = 0.0; // Drop accumulated rounding
+        }
+        const std::size_t n = history.size();
+        if (group.infinite > 0 || group.count < 3 || n < 2 || history[n - 2].units <= 0) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        const double mean = group.sum / static_cast<double>(group.count);
+        const double variance = group.sumSquares / static_cast<double>(group.count) - mean * mean;
+        const double latestReturn = std::log(static_cast<double>(history[n - 1].units) / static_cast<double>(history[n - 2].units));
+        return variance > 0.0 ? std::fabs(latestReturn - mean) / std::sqrt(variance) : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    void AlertEngine::evaluateGroup(WindowGroup& group, double value) {
+        const std::size_t base = firedIds_.size();
+        firedIds_.resize(base + group.limits.size());
+        std::size_t count = base;
+        for (std::size_t i = 0; i < group.limits.size(); ++i) {
+            const std::uint8_t condition = value >= group.limits[i] ? 1 : 0; // NaN never fires
+            firedIds_[count] = group.ruleIds[i];
+            count += condition & (group.active[i] ^ 1);
+            group.active[i] = condition;
+        }
+        firedIds_.resize(count);
+        firedValues_.resize(count, value);
+    }
+
+    void AlertEngine::onTick(Symbols::Id asset, std::int64_t timestampMs, Pricing::Price price) {
+        evaluate(asset, timestampMs, price, true);
+    }
+
+    void AlertEngine::warm(Symbols::Id asset, std::int64_t timestampMs, Pricing::Price price) {
+        evaluate(asset, timestampMs, price, false);
+    }
+
+    void AlertEngine::evaluate(Symbols::Id asset, std::int64_t timestampMs, Pricing::Price price, bool dispatch) {
+        auto* const* slot = tables_.find(asset);
+        AssetTable* table = slot != nullptr ? *slot : nullptr;
+        if (table == nullptr || !price.valid()) {
+            return;
+        }
+        firedIds_.clear();
+        firedValues_.clear();
+        const std::int64_t current = price.units;
+
+        // Only the levels between the previous and the current price can have been crossed
+        if (table->hasPrevious && current != table->previous) {
+            if (current > table->previous) {
+                table->above.crossedUp(table->previous, current, firedIds_);
+            } else {
+                table->below.crossedDown(table->previous, current, firedIds_);
+            }
+            firedValues_.resize(firedIds_.size(), 0.0);
+        }
+        table->previous = current;
+        table->hasPrevious = true;
+
+        if (table->maxWindowMs > 0) {
+            auto& history = table->history;
+            history.push_back({ timestampMs, current });
+            for (auto& group : table->percentGroups) {
+                evaluateGroup(group, percentMove(*table, group, timestampMs));
+            }
+            for (auto& group : table->volatilityGroups) {
+                evaluateGroup(group, volatilityScore(*table, group, timestampMs));
+            }
+            // Every group has already moved past what leaves the longest window
+            while (history.size() > 1 && history.front().timestampMs < timestampMs - table->maxWindowMs) {
+                history.pop_front();
+                ++table->firstSeq;
+            }
+        }
+
+        if (dispatch) {
+            flushFired(timestampMs, price);
+        }
+    }
+
+    void AlertEngine::flushFired(std::int64_t timestampMs, Pricing::Price price) {
+        for (std::size_t i = 0; i < firedIds_.size(); ++i) {
+            dispatcher_.dispatch({ firedIds_[i], timestampMs, price, firedValues_[i] });
+        }
+        fired_ += firedIds_.size();
+    }
+
+} // namespace Alerts
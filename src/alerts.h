@@ -0,0 +1,192 @@
+/*
+ * Price alerts
+ * User-defined rules (crosses above/below, % move in a window, volatility spike) are
+ * compiled into flat per-asset tables, indexed by interned asset id: crossing thresholds go into a sorted price-level
+ * index, window rules into arrays evaluated on every tick with branch-light loops. Each window keeps its
+ * statistic up to date as ticks enter and leave it, so a tick costs O(1) amortized per window rather
+ * than a rescan of the window. Fired alerts are handed to a background dispatcher that runs the
+ * actions (append to a file, POST to a local webhook, terminal bell).
+ */
+
+#pragma once
+
+#include <condition_variable> // For the dispatcher queue
+#include <cstddef> // For std::size_t
+#include <cstdint> // For fixed-width integers
+#include <deque> // For the dispatcher queue and price windows
+#include <mutex> // For the dispatcher queue
+#include <string> // For names and paths
+#include <thread> // For the dispatcher thread
+#include <vector> // For rule tables
+
+#include "price.h" // For fixed-point prices
+#include "symbols.h" // For the per-asset table index
+
+namespace Alerts {
+
+    enum class RuleType : std::uint8_t { CrossAbove, CrossBelow, PercentMove, VolatilitySpike };
+
+    // Actions to run when a rule fires (bit flags)
+    enum Action : std::uint8_t { ACTION_FILE = 1, ACTION_WEBHOOK = 2, ACTION_BELL = 4 };
+
+    // A rule as written by the user
+    struct Rule {
+        std::string name;
+        std::string asset; // CoinGecko id, e.g. "bitcoin"
+        RuleType type = RuleType::CrossAbove;
+        Pricing::Price threshold; // CrossAbove / CrossBelow
+        double percent = 0.0; // PercentMove: absolute move in percent
+        double sigma = 0.0; // VolatilitySpike: latest return in standard deviations
+        std::int64_t windowMs = 0; // PercentMove / VolatilitySpike look-back window
+        std::uint8_t actions = ACTION_FILE;
+    };
+
+    // Where the actions deliver
+    struct SinkConfig {
+        std::string filePath = "alerts.log"; // ACTION_FILE appends one JSON line per alert
+        std::string webhookUrl; // ACTION_WEBHOOK target, e.g. "http://127.0.0.1:9000/alerts"
+    };
+
+    // One fired alert
+    struct AlertEvent {
+        std::uint32_t ruleId = 0;
+        std::int64_t timestampMs = 0;
+        Pricing::Price price;
+        double value = 0.0; // Move in percent or z-score for window rules, 0 for crosses
+    };
+
+    // Load rules and sink settings from a JSON file:
+    // {"sinks": {"file": "alerts.log", "webhook": "http://127.0.0.1:9000/alerts"},
+    //  "rules": [{"name": "btc-100k", "asset": "bitcoin", "type": "cross_above", "threshold": 100000,
+    //             "actions": ["file", "bell"]},
+    //            {"asset": "bitcoin", "type": "percent_move", "percent": 5, "window_s": 3600},
+    //            {"asset": "bitcoin", "type": "volatility_spike", "sigma": 3, "window_s": 1800}]}
+    // Thresholds are read in `currency` units. Returns false and fills `error` on invalid input.
+    bool loadRules(const std::string& path, const Pricing::CurrencySpec& currency,
+                   std::vector<Rule>& rules, SinkConfig& sinks, std::string& error);
+
+    // Runs alert actions on a background thread so evaluation never waits on I/O
+    class AlertDispatcher {
+    public:
+        AlertDispatcher() = default;
+        AlertDispatcher(const AlertDispatcher&) = delete;
+        AlertDispatcher& operator=(const AlertDispatcher&) = delete;
+        ~AlertDispatcher();
+
+        // Start the worker; `rules` must outlive the dispatcher (events refer to them by id)
+        void start(const std::vector<Rule>& rules, SinkConfig sinks);
+
+        // Run pending actions and stop the worker
+        void stop();
+
+        // Queue an event; returns immediately
+        void dispatch(const AlertEvent& event);
+
+    private:
+        void run();
+        void deliver(const AlertEvent& event);
+
+        const std::vector<Rule>* rules_ = nullptr;
+        SinkConfig sinks_;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::deque<AlertEvent> queue_;
+        bool running_ = false;
+        std::thread worker_;
+    };
+
+    // Sorted price levels of one asset's crossing rules
+    // A move from `previous` to `current` only visits the levels between the two prices,
+    // found by binary search, so a tick costs O(log n + k) for n levels and k crossings.
+    class PriceLevelIndex {
+    public:
+        // Add a level; call build() once all levels are added
+        void add(std::int64_t level, std::uint32_t ruleId);
+
+        // Sort the levels (ties keep insertion order)
+        void build();
+
+        // Append the ids of levels with previous < level <= current (upward crossings)
+        void crossedUp(std::int64_t previous, std::int64_t current, std::vector<std::uint32_t>& out) const;
+
+        // Append the ids of levels with current <= level < previous (downward crossings)
+        void crossedDown(std::int64_t previous, std::int64_t current, std::vector<std::uint32_t>& out) const;
+
+        std::size_t size() const { return levels_.size(); }
+
+    private:
+        std::vector<std::int64_t> levels_; // Sorted ascending after build()
+        std::vector<std::uint32_t> ruleIds_; // Parallel to levels_
+    };
+
+    // Evaluates compiled rules on every tick
+    class AlertEngine {
+    public:
+        // Compile `rules` into per-asset tables; `rules` and `dispatcher` must outlive the engine
+        AlertEngine(const std::vector<Rule>& rules, AlertDispatcher& dispatcher);
+
+        // Evaluate every rule of `asset` against a new price
+        void onTick(Symbols::Id asset, std::int64_t timestampMs, Pricing::Price price);
+
+        // Feed a past price (e.g. restored from a snapshot) to fill the windows and edge
+        // states without firing anything
+        void warm(Symbols::Id asset, std::int64_t timestampMs, Pricing::Price price);
+
+        std::size_t ruleCount() const { return ruleCount_; }
+        std::uint64_t firedCount() const { return fired_; }
+
+    private:
+        // Window rules sharing one look-back window, so the window statistic is computed once
+        // Samples are addressed by sequence number (AssetTable::firstSeq is history.front()'s)
+        struct WindowGroup {
+            std::int64_t windowMs = 0;
+            std::vector<double> limits; // Percent or sigma
+            std::vector<std::uint32_t> ruleIds;
+            std::vector<std::uint8_t> active; // Edge trigger: fire only when the condition becomes true
+            std::uint64_t start = 0; // Oldest sample in the window: the percent reference, or the first return's start
+            std::uint64_t next = 1; // Volatility: end sample of the next return to add
+            double sum = 0.0; // Volatility: running sum and sum of squares of the window's log returns
+            double sumSquares = 0.0;
+            std::int64_t count = 0;
+            std::int64_t infinite = 0; // Volatility: returns to a zero price, kept out of the sums
+        };
+
+        struct Sample {
+            std::int64_t timestampMs;
+            std::int64_t units;
+        };
+
+        struct AssetTable {
+            Symbols::Id asset = Symbols::NONE;
+            PriceLevelIndex above; // cross_above thresholds
+            PriceLevelIndex below; // cross_below thresholds
+            std::vector<WindowGroup> percentGroups;
+            std::vector<WindowGroup> volatilityGroups;
+            std::deque<Sample> history; // Ticks covering the longest window
+            std::uint64_t firstSeq = 0; // Sequence number of history.front()
+            std::int64_t maxWindowMs = 0;
+            std::int64_t previous = 0;
+            bool hasPrevious = false;
+        };
+
+        void evaluate(Symbols::Id asset, std::int64_t timestampMs, Pricing::Price price, bool dispatch);
+        static WindowGroup& groupFor(std::vector<WindowGroup>& groups, std::int64_t windowMs);
+        static double percentMove(AssetTable& table, WindowGroup& group, std::int64_t timestampMs);
+        static void addReturn(WindowGroup& group, double r, int sign);
+        static double volatilityScore(AssetTable& table, WindowGroup& group, std::int64_t timestampMs);
+        void evaluateGroup(WindowGroup& group, double value);
+        void flushFired(std::int64_t timestampMs, Pricing::Price price);
+
+        std::vector<AssetTable> assets_;
+        Symbols::IdMap<AssetTable*> tables_; // Into assets_, null for assets without rules
+        AlertDispatcher& dispatcher_;
+        std::vector<std::uint32_t> firedIds_; // Scratch, reused across ticks
+        std::vector<double> firedValues_;
+        std::size_t ruleCount_ = 0;
+        std::uint64_t fired_ = 0;
+    };
+
+    // Lowercase name of a rule type as used in the rules file
+    const char* ruleTypeName(RuleType type);
+
+} // namespace Alerts
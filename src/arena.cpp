@@ -0,0 +1,53 @@
+/*
+ * Tick arena
+ * See arena.h for an overview.
+ */
+
+#include "arena.h"
+
+namespace Arena {
+
+    namespace {
+        thread_local std::pmr::memory_resource* currentResource = nullptr;
+    }
+
+    std::pmr::memory_resource* current() {
+        return currentResource != nullptr ? currentResource : std::pmr::new_delete_resource();
+    }
+
+    void* TickArena::Overflow::do_allocate(std::size_t bytes, std::size_t alignment) {
+        this->bytes += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void TickArena::Overflow::do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) {
+        std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+    }
+
+    TickArena::TickArena(std::size_t initialBytes)
+        : buffer_(std::make_unique<std::byte[]>(initialBytes)), capacity_(initialBytes) {
+        monotonic_.emplace(buffer_.get(), capacity_, &overflow_);
+    }
+
+    void TickArena::reset() {
+        monotonic_.reset(); // Returns the overflow blocks to the heap
+        if (overflow_.bytes > 0) {
+            // Cover the largest update so far with room to spare
+            capacity_ += 2 * overflow_.bytes;
+            buffer_ = std::make_unique<std::byte[]>(capacity_);
+            overflow_.bytes = 0;
+            ++grows_;
+        }
+        monotonic_.emplace(buffer_.get(), capacity_, &overflow_);
+    }
+
+    TickScope::TickScope(TickArena& arena) : arena_(arena), previous_(currentResource) {
+        currentResource = arena_.resource();
+    }
+
+    TickScope::~TickScope() {
+        currentResource = previous_;
+        arena_.reset();
+    }
+
+} // namespace Arena
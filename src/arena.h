@@ -0,0 +1,103 @@
+/*
+ * Tick arena
+ * Transient allocations of one update (status lines, the JSON fallback parser's tokens,
+ * scratch strings) come from a monotonic buffer that is released wholesale when the update
+ * ends, instead of going through the global heap one object at a time. The buffer grows
+ * to the largest update seen, so in the steady state the update's transient text and
+ * tokens allocate nothing. The engine's stored history still does: node churn of the
+ * bounded 1-second candle and recent-tick deques and the tick store's chunk growth, about
+ * 0.2 allocations per asset per update (checked by btc-bench --check).
+ *
+ * Containers opt in through Arena::Allocator, whose default constructor picks the arena of
+ * the innermost TickScope on the calling thread (the heap outside any scope). That is also
+ * how nlohmann::json default-constructs its allocators, which makes Arena::Json (json.h)
+ * arena-backed without threading a resource through every call.
+ */
+
+#pragma once
+
+#include <cstddef> // For std::size_t
+#include <memory> // For the owned buffer
+#include <memory_resource> // For the monotonic resource and polymorphic allocators
+#include <optional> // For re-creating the resource over a new buffer
+#include <string> // For Arena::String
+#include <vector> // For Arena::Vector
+
+namespace Arena {
+
+    // Resource of the innermost TickScope on this thread, or the global heap outside any scope
+    std::pmr::memory_resource* current();
+
+    // Polymorphic allocator bound to current() when default-constructed (and when a container is copied)
+    // A container must be destroyed inside the scope it was filled in: its memory belongs to that arena.
+    template <typename T>
+    class Allocator : public std::pmr::polymorphic_allocator<T> {
+    public:
+        using value_type = T;
+
+        Allocator() noexcept : std::pmr::polymorphic_allocator<T>(current()) {}
+        Allocator(std::pmr::memory_resource* resource) noexcept : std::pmr::polymorphic_allocator<T>(resource) {}
+
+        template <typename U>
+        Allocator(const Allocator<U>& other) noexcept : std::pmr::polymorphic_allocator<T>(other.resource()) {}
+
+        Allocator select_on_container_copy_construction() const { return Allocator(); }
+    };
+
+    using String = std::basic_string<char, std::char_traits<char>, Allocator<char>>;
+
+    template <typename T>
+    using Vector = std::vector<T, Allocator<T>>;
+
+    // Monotonic buffer for the allocations of one update
+    // Allocations past the buffer fall through to the heap; the next reset() then grows the
+    // buffer to cover them, so a repeating workload stops touching the heap after one update.
+    class TickArena {
+    public:
+        explicit TickArena(std::size_t initialBytes = 64 * 1024);
+
+        TickArena(const TickArena&) = delete;
+        TickArena& operator=(const TickArena&) = delete;
+
+        std::pmr::memory_resource* resource() { return &*monotonic_; }
+
+        // Release every allocation at once; memory handed out before is invalid afterwards
+        void reset();
+
+        std::size_t capacity() const { return capacity_; }
+        std::size_t grows() const { return grows_; } // Resets that had to enlarge the buffer
+
+    private:
+        // Heap fallback that remembers how much the buffer was short by
+        class Overflow : public std::pmr::memory_resource {
+        public:
+            std::size_t bytes = 0;
+
+        private:
+            void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+            void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override;
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+        };
+
+        std::unique_ptr<std::byte[]> buffer_;
+        std::size_t capacity_;
+        std::size_t grows_ = 0;
+        Overflow overflow_;
+        std::optional<std::pmr::monotonic_buffer_resource> monotonic_;
+    };
+
+    // Routes this thread's Arena::Allocator allocations to `arena` while alive, then resets the arena
+    class TickScope {
+    public:
+        explicit TickScope(TickArena& arena);
+        ~TickScope();
+
+        TickScope(const TickScope&) = delete;
+        TickScope& operator=(const TickScope&) = delete;
+
+    private:
+        TickArena& arena_;
+        std::pmr::memory_resource* previous_;
+    };
+
+} // namespace Arena
@@ -0,0 +1,338 @@
+/*
+ * Historical backfill
+ * See backfill.h for an overview.
+ */
+
+#include "backfill.h"
+
+#include <httplib.h> // For the range requests
+#include "json.h" // For the SAX parser
+#include <algorithm> // For std::min and std::max
+#include <atomic> // For the shared job cursor
+#include <charconv> // For integer prices
+#include <thread> // For the workers
+
+#include "buffers.h" // For pooled response bodies
+#include "logger.h" // For chunk failures
+#include "placement.h" // For the workers' placement
+#include "price.h" // For parsing prices from the number text
+#include "scan.h" // For the structural index
+#include "schema.h" // For the endpoint and response fields
+#include "symbols.h" // For the asset ids of backfilled series
+
+namespace Backfill {
+
+    namespace {
+
+        // SAX handler for {"prices":[[ms,price],...],"market_caps":[...],"total_volumes":[...]}
+        // Only the "prices" array is read; parsing stops at its end
+        class MarketChartHandler : public nlohmann::json_sax<nlohmann::json> {
+        public:
+            MarketChartHandler(std::uint8_t scale, std::vector<Ticks::Tick>& out) : scale_(scale), out_(out) {}
+
+            bool null() override { return skip(); }
+            bool boolean(bool) override { return skip(); }
+            bool number_integer(number_integer_t val) override {
+                char text[24];
+                const auto end = std::to_chars(text, text + sizeof(text), val).ptr;
+                return number(static_cast<double>(val), std::string_view(text, static_cast<std::size_t>(end - text)));
+            }
+            bool number_unsigned(number_unsigned_t val) override {
+                char text[24];
+                const auto end = std::to_chars(text, text + sizeof(text), val).ptr;
+                return number(static_cast<double>(val), std::string_view(text, static_cast<std::size_t>(end - text)));
+            }
+            bool number_float(number_float_t val, const string_t& text) override { return number(val, text); }
+            bool string(string_t&) override { return skip(); }
+            bool binary(binary_t&) override { return skip(); }
+            bool start_object(std::size_t) override {
+                ++depth_;
+                pricesKey_ = false;
+                return true;
+            }
+            bool key(string_t& val) override {
+                pricesKey_ = depth_ == 1 && Schema::MarketChartFields::find(val) == Schema::MarketChartFields::index<"prices">;
+                return true;
+            }
+            bool end_object() override {
+                --depth_;
+                return true;
+            }
+            bool start_array(std::size_t) override {
+                ++depth_;
+                if (depth_ == 2 && pricesKey_) {
+                    inPrices_ = true;
+                    found_ = true;
+                } else if (depth_ == 3 && inPrices_) {
+                    element_ = 0;
+                    tick_ = Ticks::Tick{ 0, -1 };
+                }
+                pricesKey_ = false;
+                return true;
+            }
+            bool end_array() override {
+                --depth_;
+                if (inPrices_ && depth_ == 2 && tick_.units >= 0 && element_ >= 2) {
+                    out_.push_back(tick_);
+                } else if (inPrices_ && depth_ == 1) {
+                    done_ = true;
+                    return false; // Market caps and volumes are not needed
+                }
+                return true;
+            }
+            bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+                error_ = "Failed to parse market chart: ";
+                error_ += ex.what();
+                return false;
+            }
+
+            bool succeeded() const { return done_ || (found_ && error_.empty()); }
+            bool found() const { return found_; }
+            const std::string& error() const { return error_; }
+
+        private:
+            // [timestamp, price]: the timestamp is an integer in milliseconds, the price any number
+            bool number(double value, std::string_view text) {
+                if (inPrices_ && depth_ == 3) {
+                    if (element_ == 0) {
+                        tick_.timestampMs = static_cast<std::int64_t>(value);
+                    } else if (element_ == 1) {
+                        Pricing::Price price;
+                        if (Pricing::parsePrice(text, scale_, price)) {
+                            tick_.units = price.units;
+                        }
+                    }
+                    ++element_;
+                }
+                pricesKey_ = false;
+                return true;
+            }
+
+            bool skip() {
+                if (inPrices_ && depth_ == 3) {
+                    ++element_; // e.g. a null price: the pair is dropped
+                }
+                pricesKey_ = false;
+                return true;
+            }
+
+            std::uint8_t scale_;
+            std::vector<Ticks::Tick>& out_;
+            Ticks::Tick tick_{ 0, -1 };
+            int depth_ = 0;
+            int element_ = 0;
+            bool pricesKey_ = false;
+            bool inPrices_ = false;
+            bool found_ = false;
+            bool done_ = false;
+            std::string error_;
+        };
+
+        // Fast path over the structural index for {"prices":[[ms,price],...],...}
+        // Returns false when the SAX handler has to decide; the caller then drops what was appended
+        bool scanMarketChart(std::string_view body, std::uint8_t scale, std::vector<Ticks::Tick>& out) {
+            thread_local Scan::StructuralIndex index; // Keeps its capacity between bodies
+            if (!index.build(body)) {
+                return false;
+            }
+            Scan::Cursor cursor(body, index);
+            if (!cursor.consume('{')) {
+                return false;
+            }
+            do {
+                std::string_view key;
+                if (!cursor.string(key) || !cursor.consume(':')) {
+                    return false;
+                }
+                if (Schema::MarketChartFields::find(key) != Schema::MarketChartFields::index<"prices">) {
+                    if (!cursor.skipValue()) {
+                        return false;
+                    }
+                    continue;
+                }
+                if (!cursor.consume('[')) {
+                    return false;
+                }
+                if (cursor.consume(']')) {
+                    return true;
+                }
+                do {
+                    std::string_view time;
+                    std::string_view value;
+                    if (!cursor.consume('[') || !cursor.scalar(time) || !cursor.consume(',') || !cursor.scalar(value) || !cursor.consume(']')) {
+                        return false;
+                    }
+                    Ticks::Tick tick{ 0, -1 };
+                    const auto parsed = std::from_chars(time.data(), time.data() + time.size(), tick.timestampMs);
+                    if (parsed.ec != std::errc() || parsed.ptr != time.data() + time.size()) {
+                        return false; // e.g. a timestamp in exponent notation
+                    }
+                    if (value == "null") {
+                        continue; // Dropped, like the SAX handler does
+                    }
+                    Pricing::Price price;
+                    if (!Scan::isNumber(value)) {
+                        return false;
+                    }
+                    if (Pricing::parsePrice(value, scale, price) && price.units >= 0) {
+                        tick.units = price.units;
+                        out.push_back(tick);
+                    }
+                } while (cursor.consume(','));
+                return cursor.consume(']'); // Market caps and volumes are not needed
+            } while (cursor.consume(','));
+            return false; // No "prices": the SAX handler reports it
+        }
+
+        // One request: an asset over [from, to] in Unix seconds
+        struct Chunk {
+            std::size_t asset;
+            std::int64_t from;
+            std::int64_t to;
+        };
+
+    } // namespace
+
+    RateLimiter::RateLimiter(double requestsPerMinute)
+        : interval_(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(60.0 / std::max(requestsPerMinute, 0.001)))),
+          next_(std::chrono::steady_clock::now()) {
+    }
+
+    void RateLimiter::acquire() {
+        std::chrono::steady_clock::time_point slot;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            slot = std::max(next_, std::chrono::steady_clock::now());
+            next_ = slot + interval_;
+        }
+        std::this_thread::sleep_until(slot);
+    }
+
+    void RateLimiter::pause(std::chrono::milliseconds duration) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        next_ = std::max(next_, std::chrono::steady_clock::now() + duration);
+    }
+
+    bool parseMarketChart(std::string_view body, std::uint8_t scale, std::vector<Ticks::Tick>& out, std::string& error) {
+        const std::size_t kept = out.size();
+        if (scanMarketChart(body, scale, out)) {
+            return true;
+        }
+        out.resize(kept);
+        MarketChartHandler handler(scale, out);
+        nlohmann::json::sax_parse(body, &handler);
+        if (!handler.succeeded()) {
+            error = !handler.error().empty() ? handler.error() : "missing 'prices' array";
+            out.resize(kept); // Drop the ticks parsed before the error
+            return false;
+        }
+        return true;
+    }
+
+    Result run(const std::string& baseUrl, const std::vector<std::string>& assets, const std::string& currency, std::uint8_t scale,
+               const Settings& settings, Ticks::TickStore& store, const ProgressFunction& progress) {
+        const auto started = std::chrono::steady_clock::now();
+        Result result;
+
+        // Cut [now - days, now] into chunks for every asset
+        const std::int64_t end = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        const std::int64_t start = end - static_cast<std::int64_t>(settings.days) * 86400;
+        const std::int64_t span = static_cast<std::int64_t>(std::max(settings.chunkDays, 1)) * 86400;
+        std::vector<Chunk> chunks;
+        for (std::size_t a = 0; a < assets.size(); ++a) {
+            for (std::int64_t from = start; from < end; from += span) {
+                chunks.push_back({ a, from, std::min(from + span, end) });
+            }
+        }
+        result.chunks = chunks.size();
+
+        RateLimiter limiter(settings.requestsPerMinute);
+        std::atomic<std::size_t> nextChunk{ 0 };
+        std::atomic<std::size_t> done{ 0 };
+        std::atomic<std::size_t> failed{ 0 };
+        std::atomic<bool> cancelled{ false };
+        const int workerCount = std::max(1, std::min(settings.connections, static_cast<int>(chunks.size())));
+        // Each worker keeps its ticks per asset; they are merged once all chunks are in
+        std::vector<std::vector<std::vector<Ticks::Tick>>> collected(static_cast<std::size_t>(workerCount), std::vector<std::vector<Ticks::Tick>>(assets.size()));
+
+        auto worker = [&](std::size_t index) {
+            Placement::enter(Placement::Stage::Backfill);
+            httplib::Client client(baseUrl);
+            client.set_connection_timeout(settings.connectionTimeoutSeconds);
+            client.set_read_timeout(settings.readTimeoutSeconds);
+            client.set_keep_alive(true);
+            auto& ticks = collected[index];
+            for (std::size_t i = nextChunk++; i < chunks.size() && !cancelled; i = nextChunk++) {
+                const Chunk& chunk = chunks[i];
+                const std::string target = Schema::MarketChartRange::target(assets[chunk.asset], currency, chunk.from, chunk.to);
+                bool ok = false;
+                for (int attempt = 1; attempt <= settings.maxRetries && !ok; ++attempt) {
+                    limiter.acquire();
+                    Buffers::BufferPool::Lease body = Buffers::responsePool().acquire(); // Chunks of hundreds of KiB reuse the same buffers
+                    auto res = client.Get(target, [&body](const char* data, size_t length) {
+                        body->append(data, length);
+                        return true;
+                    });
+                    if (!res) {
+                        Logging::warning("Backfill request failed", { { "asset", assets[chunk.asset] }, { "attempt", attempt }, { "error", httplib::to_string(res.error()) } });
+                        continue;
+                    }
+                    if (res->status == 429) {
+                        // Slow every worker down, not just this one
+                        limiter.pause(std::chrono::seconds(settings.rateLimitDelaySeconds));
+                        Logging::warning("Backfill rate limited", { { "asset", assets[chunk.asset] }, { "attempt", attempt } });
+                        continue;
+                    }
+                    if (res->status != 200) {
+                        Logging::warning("Backfill HTTP error", { { "asset", assets[chunk.asset] }, { "status", res->status }, { "attempt", attempt } });
+                        continue;
+                    }
+                    std::string error;
+                    ok = parseMarketChart(body->view(), scale, ticks[chunk.asset], error);
+                    if (!ok) {
+                        Logging::error("Invalid backfill response", { { "asset", assets[chunk.asset] }, { "error", error } });
+                        break; // A malformed body will not get better on retry
+                    }
+                }
+                if (!ok) {
+                    ++failed;
+                }
+                ++done;
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (int i = 0; i < workerCount; ++i) {
+            workers.emplace_back(worker, static_cast<std::size_t>(i));
+        }
+        while (done < chunks.size() && !cancelled) {
+            if (progress && !progress(done, chunks.size())) {
+                cancelled = true;
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        for (auto& thread : workers) {
+            thread.join();
+        }
+        if (progress && !cancelled) {
+            progress(chunks.size(), chunks.size());
+        }
+
+        // One bulk merge per asset: chunks overlap at their edges and may repeat stored ticks
+        for (std::size_t a = 0; a < assets.size(); ++a) {
+            std::vector<Ticks::Tick> merged;
+            for (auto& perWorker : collected) {
+                merged.insert(merged.end(), perWorker[a].begin(), perWorker[a].end());
+            }
+            result.ticksFetched += merged.size();
+            result.ticksAdded += store.insert(Symbols::intern(assets[a]), scale, std::move(merged));
+        }
+        result.failedChunks = failed + (chunks.size() - done); // Cancelled chunks count as failed
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        Logging::info("Backfill finished", { { "chunks", result.chunks }, { "failed", result.failedChunks }, { "ticks_fetched", result.ticksFetched },
+                                             { "ticks_added", result.ticksAdded }, { "seconds", result.seconds } });
+        return result;
+    }
+
+} // namespace Backfill
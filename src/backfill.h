@@ -0,0 +1,75 @@
+/*
+ * Historical backfill
+ * Fills the tick store from /api/v3/coins/{id}/market_chart/range. The requested period is
+ * cut into time chunks per asset; a few workers, each with its own kept-alive connection,
+ * fetch the chunks in parallel under a shared rate limiter. Every response is read with a
+ * SAX handler that turns the "prices" array straight into fixed-point ticks and stops
+ * before the market caps and volumes. The ticks of each asset are then deduplicated
+ * and bulk-loaded into the store in one merge.
+ */
+
+#pragma once
+
+#include <chrono> // For rate limiter timing
+#include <cstddef> // For std::size_t
+#include <cstdint> // For fixed-width integers
+#include <functional> // For progress reports
+#include <mutex> // For the rate limiter
+#include <string> // For URLs and ids
+#include <string_view> // For response bodies
+#include <vector> // For asset lists and ticks
+
+#include "tickstore.h" // For the destination store
+
+namespace Backfill {
+
+    struct Settings {
+        int days = 30; // How far back to fetch
+        int chunkDays = 90; // Period per request (CoinGecko returns hourly points up to 90 days)
+        int connections = 4; // Parallel workers, one connection each
+        double requestsPerMinute = 30.0; // Shared request budget
+        int maxRetries = 3; // Attempts per chunk
+        int rateLimitDelaySeconds = 10; // Pause for every worker after HTTP 429
+        int connectionTimeoutSeconds = 5;
+        int readTimeoutSeconds = 30;
+    };
+
+    // Paces requests from several threads: each acquire() takes the next free slot,
+    // slots are 60 / requestsPerMinute seconds apart
+    class RateLimiter {
+    public:
+        explicit RateLimiter(double requestsPerMinute);
+
+        // Block until the caller may send a request
+        void acquire();
+
+        // Push every later slot back, e.g. after HTTP 429
+        void pause(std::chrono::milliseconds duration);
+
+    private:
+        std::mutex mutex_;
+        std::chrono::steady_clock::duration interval_;
+        std::chrono::steady_clock::time_point next_;
+    };
+
+    // Append the [timestamp, price] pairs of the "prices" array in `body` to `out`
+    // Returns false, leaves `out` unchanged and fills `error` if the body is not a market chart
+    bool parseMarketChart(std::string_view body, std::uint8_t scale, std::vector<Ticks::Tick>& out, std::string& error);
+
+    struct Result {
+        std::size_t chunks = 0;
+        std::size_t failedChunks = 0;
+        std::size_t ticksFetched = 0;
+        std::size_t ticksAdded = 0; // After deduplication against the store
+        double seconds = 0.0;
+    };
+
+    // Called on the calling thread while the workers run; returning false cancels the
+    // chunks that have not started yet
+    using ProgressFunction = std::function<bool(std::size_t done, std::size_t total)>;
+
+    // Fetch `settings.days` of history for every asset and load it into `store`
+    Result run(const std::string& baseUrl, const std::vector<std::string>& assets, const std::string& currency, std::uint8_t scale,
+               const Settings& settings, Ticks::TickStore& store, const ProgressFunction& progress = {});
+
+} // namespace Backfill
@@ -0,0 +1,126 @@
+/*
+ * Response buffers
+ * See buffers.h for an overview.
+ */
+
+#include "buffers.h"
+
+#include <algorithm> // For std::max
+#include <cstring> // For std::memcpy
+#include <new> // For aligned operator new
+#include <utility> // For std::exchange
+
+namespace Buffers {
+
+    namespace {
+        constexpr std::size_t PAGE_BYTES = 4096;
+        constexpr std::size_t RESPONSE_BUFFER_BYTES = 64 * 1024; // A /simple/price body for hundreds of assets
+        constexpr std::size_t MAX_IDLE_RESPONSE_BUFFERS = 32; // Fetcher plus backfill and loadgen connections
+    }
+
+    Buffer::Buffer(std::size_t capacity) {
+        reserve(capacity);
+    }
+
+    Buffer::~Buffer() {
+        if (data_ != nullptr) {
+            ::operator delete(data_, std::align_val_t(ALIGNMENT));
+        }
+    }
+
+    Buffer::Buffer(Buffer&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)), capacity_(std::exchange(other.capacity_, 0)) {
+    }
+
+    Buffer& Buffer::operator=(Buffer&& other) noexcept {
+        if (this != &other) {
+            if (data_ != nullptr) {
+                ::operator delete(data_, std::align_val_t(ALIGNMENT));
+            }
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            capacity_ = std::exchange(other.capacity_, 0);
+        }
+        return *this;
+    }
+
+    void Buffer::append(const char* data, std::size_t length) {
+        if (length == 0) {
+            return;
+        }
+        if (size_ + length > capacity_) {
+            reserve(std::max(size_ + length, 2 * capacity_));
+        }
+        std::memcpy(data_ + size_, data, length);
+        size_ += length;
+    }
+
+    char* Buffer::prepare(std::size_t length) {
+        if (size_ + length > capacity_) {
+            reserve(std::max(size_ + length, 2 * capacity_));
+        }
+        return data_ + size_;
+    }
+
+    void Buffer::reserve(std::size_t capacity) {
+        if (capacity <= capacity_) {
+            return;
+        }
+        capacity = (capacity + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        auto* grown = static_cast<char*>(::operator new(capacity, std::align_val_t(ALIGNMENT)));
+        // Fault the pages in now rather than in the middle of receiving a response
+        for (std::size_t offset = 0; offset < capacity; offset += PAGE_BYTES) {
+            grown[offset] = 0;
+        }
+        if (data_ != nullptr) {
+            std::memcpy(grown, data_, size_);
+            ::operator delete(data_, std::align_val_t(ALIGNMENT));
+        }
+        data_ = grown;
+        capacity_ = capacity;
+    }
+
+    BufferPool::BufferPool(std::size_t bufferBytes, std::size_t maxIdle) : bufferBytes_(bufferBytes), maxIdle_(maxIdle) {
+        idle_.reserve(maxIdle_);
+    }
+
+    BufferPool::Lease::Lease(Lease&& other) noexcept : pool_(std::exchange(other.pool_, nullptr)), buffer_(std::move(other.buffer_)) {
+    }
+
+    BufferPool::Lease::~Lease() {
+        if (pool_ != nullptr) {
+            pool_->release(std::move(buffer_));
+        }
+    }
+
+    BufferPool::Lease BufferPool::acquire() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!idle_.empty()) {
+                Buffer buffer = std::move(idle_.back());
+                idle_.pop_back();
+                return Lease(this, std::move(buffer));
+            }
+        }
+        return Lease(this, Buffer(bufferBytes_));
+    }
+
+    std::size_t BufferPool::idle() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return idle_.size();
+    }
+
+    void BufferPool::release(Buffer buffer) {
+        buffer.clear();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (idle_.size() < maxIdle_) {
+            idle_.push_back(std::move(buffer));
+        }
+    }
+
+    BufferPool& responsePool() {
+        static BufferPool pool(RESPONSE_BUFFER_BYTES, MAX_IDLE_RESPONSE_BUFFERS);
+        return pool;
+    }
+
+} // namespace Buffers
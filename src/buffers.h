@@ -0,0 +1,98 @@
+/*
+ * Response buffers
+ * HTTP response bodies are received into buffers checked out of a process-wide pool and
+ * handed back once the body has been parsed, instead of httplib growing a fresh std::string
+ * for every response. Buffers are cache-line aligned and keep the capacity they grew to, so
+ * with many requests per second (and large backfill chunks on several connections) the heap
+ * sees neither the allocation churn nor the page faults of memory it keeps unmapping.
+ */
+
+#pragma once
+
+#include <cstddef> // For std::size_t
+#include <mutex> // For the idle list
+#include <string_view> // For the received bytes
+#include <utility> // For std::move
+#include <vector> // For the idle list
+
+namespace Buffers {
+
+    constexpr std::size_t ALIGNMENT = 64; // One cache line
+
+    // Growable byte buffer with ALIGNMENT-aligned storage
+    class Buffer {
+    public:
+        explicit Buffer(std::size_t capacity = 0);
+        ~Buffer();
+
+        Buffer(Buffer&& other) noexcept;
+        Buffer& operator=(Buffer&& other) noexcept;
+        Buffer(const Buffer&) = delete;
+        Buffer& operator=(const Buffer&) = delete;
+
+        // Append bytes, at least doubling the capacity when they do not fit
+        void append(const char* data, std::size_t length);
+
+        // Grow to at least `capacity` bytes, faulting the new pages in right away
+        void reserve(std::size_t capacity);
+
+        // Writable space for `length` more bytes (grown like append()), for readers that fill the
+        // buffer in place; commit() then adds the bytes actually written
+        char* prepare(std::size_t length);
+        void commit(std::size_t length) { size_ += length; }
+
+        void clear() { size_ = 0; }
+
+        const char* data() const { return data_; }
+        std::size_t size() const { return size_; }
+        std::size_t capacity() const { return capacity_; }
+        std::string_view view() const { return { data_, size_ }; }
+
+    private:
+        char* data_ = nullptr;
+        std::size_t size_ = 0;
+        std::size_t capacity_ = 0;
+    };
+
+    // Recycled buffers shared by every fetching thread
+    class BufferPool {
+    public:
+        // New buffers start at `bufferBytes`; at most `maxIdle` returned buffers are kept
+        BufferPool(std::size_t bufferBytes, std::size_t maxIdle);
+
+        // A buffer checked out of the pool, returned empty when the lease ends
+        class Lease {
+        public:
+            Lease(Lease&& other) noexcept;
+            Lease& operator=(Lease&&) = delete;
+            ~Lease();
+
+            Buffer& operator*() { return buffer_; }
+            Buffer* operator->() { return &buffer_; }
+
+        private:
+            friend class BufferPool;
+            Lease(BufferPool* pool, Buffer buffer) : pool_(pool), buffer_(std::move(buffer)) {}
+
+            BufferPool* pool_;
+            Buffer buffer_;
+        };
+
+        // An idle buffer, or a new one of bufferBytes when none is left
+        Lease acquire();
+
+        std::size_t idle() const;
+
+    private:
+        void release(Buffer buffer);
+
+        const std::size_t bufferBytes_;
+        const std::size_t maxIdle_;
+        mutable std::mutex mutex_;
+        std::vector<Buffer> idle_;
+    };
+
+    // The process-wide pool for HTTP response bodies
+    BufferPool& responsePool();
+
+} // namespace Buffers
@@ -0,0 +1,117 @@
+/*
+ * OHLC candle aggregation
+ * See candles.h for an overview.
+ */
+
+#include "candles.h"
+
+#include <algorithm> // For std::min and std::max
+
+#include "timefmt.h" // For floor division
+
+namespace Candles {
+
+    namespace {
+
+        // Start of the bucket containing timestampMs for a resolution of `seconds`
+        // Floors towards negative infinity so pre-epoch timestamps bucket correctly too
+        std::int64_t bucketStart(std::int64_t timestampMs, std::int64_t seconds) {
+            const std::int64_t lengthMs = seconds * 1000;
+            return TimeFormat::floorDiv(timestampMs, lengthMs) * lengthMs;
+        }
+
+    } // namespace
+
+    const char* resolutionName(Resolution resolution) {
+        switch (resolution) {
+            case Resolution::OneSecond: return "1s";
+            case Resolution::OneMinute: return "1m";
+            case Resolution::FiveMinutes: return "5m";
+            case Resolution::OneHour: return "1h";
+            case Resolution::OneDay: return "1d";
+        }
+        return "?";
+    }
+
+    Resolution resolutionFor(std::int64_t seconds) {
+        for (std::size_t i = 0; i < RESOLUTION_COUNT; ++i) {
+            if (RESOLUTION_SECONDS[i] >= seconds) {
+                return static_cast<Resolution>(i);
+            }
+        }
+        return static_cast<Resolution>(RESOLUTION_COUNT - 1);
+    }
+
+    void CandleAggregator::addSink(CandleSink sink) {
+        sinks_.push_back(std::move(sink));
+    }
+
+    void CandleAggregator::addTick(std::int64_t timestampMs, Pricing::Price price) {
+        for (std::size_t i = 0; i < RESOLUTION_COUNT; ++i) {
+            const std::int64_t start = bucketStart(timestampMs, RESOLUTION_SECONDS[i]);
+            Candle& candle = open_[i];
+            // Tick belongs to a later bucket: seal the open candle and start a new one
+            if (active_[i] && start > candle.openTime) {
+                seal(i);
+            }
+            if (!active_[i]) {
+                candle = Candle{ start, price, price, price, price, 1 };
+                active_[i] = true;
+                continue;
+            }
+            // Same (or late) bucket: update in place
+            candle.high = std::max(candle.high, price);
+            candle.low = std::min(candle.low, price);
+            candle.close = price;
+            ++candle.ticks;
+        }
+    }
+
+    void CandleAggregator::flush() {
+        for (std::size_t i = 0; i < RESOLUTION_COUNT; ++i) {
+            if (active_[i]) {
+                seal(i);
+            }
+        }
+    }
+
+    const Candle* CandleAggregator::current(Resolution resolution) const {
+        const auto index = static_cast<std::size_t>(resolution);
+        return active_[index] ? &open_[index] : nullptr;
+    }
+
+    void CandleAggregator::restore(Resolution resolution, const Candle& candle) {
+        const auto index = static_cast<std::size_t>(resolution);
+        open_[index] = candle;
+        active_[index] = true;
+    }
+
+    void CandleAggregator::seal(std::size_t index) {
+        active_[index] = false;
+        for (const auto& sink : sinks_) {
+            sink(static_cast<Resolution>(index), open_[index]);
+        }
+    }
+
+    CandleHistory::CandleHistory(std::size_t capacity) : capacity_(capacity) {}
+
+    CandleSink CandleHistory::sink() {
+        return [this](Resolution resolution, const Candle& candle) { append(resolution, candle); };
+    }
+
+    void CandleHistory::append(Resolution resolution, const Candle& candle) {
+        auto& bars = bars_[static_cast<std::size_t>(resolution)];
+        if (capacity_ == 0) {
+            return;
+        }
+        if (bars.size() == capacity_) {
+            bars.pop_front();
+        }
+        bars.push_back(candle);
+    }
+
+    const std::deque<Candle>& CandleHistory::bars(Resolution resolution) const {
+        return bars_[static_cast<std::size_t>(resolution)];
+    }
+
+} // namespace Candles
@@ -0,0 +1,98 @@
+/*
+ * OHLC candle aggregation
+ * Turns the stream of fetched prices into open/high/low/close bars at several
+ * resolutions at once, so charts and backtests can read pre-aggregated data.
+ */
+
+#pragma once
+
+#include <array> // For per-resolution state
+#include <cstddef> // For std::size_t
+#include <cstdint> // For fixed-width integers
+#include <deque> // For bounded candle history
+#include <functional> // For candle sinks
+#include <vector> // For the sink list
+
+#include "price.h" // For fixed-point prices
+
+namespace Candles {
+
+    // Supported candle resolutions, from finest to coarsest
+    enum class Resolution { OneSecond, OneMinute, FiveMinutes, OneHour, OneDay };
+
+    constexpr std::size_t RESOLUTION_COUNT = 5;
+
+    // Length of each resolution in seconds, indexed by Resolution
+    constexpr std::array<std::int64_t, RESOLUTION_COUNT> RESOLUTION_SECONDS = { 1, 60, 300, 3600, 86400 };
+
+    // Short label for a resolution ("1s", "1m", "5m", "1h", "1d")
+    const char* resolutionName(Resolution resolution);
+
+    // Finest resolution at least `seconds` long (the coarsest when none is), e.g. the bars that
+    // hold about one update each at a poll interval of `seconds`
+    Resolution resolutionFor(std::int64_t seconds);
+
+    // A single OHLC bar; openTime is the bucket start in milliseconds since the Unix epoch
+    struct Candle {
+        std::int64_t openTime = 0;
+        Pricing::Price open;
+        Pricing::Price high;
+        Pricing::Price low;
+        Pricing::Price close;
+        std::uint32_t ticks = 0; // Number of prices folded into this bar
+    };
+
+    // Called once for every candle that is sealed (its time bucket has ended)
+    using CandleSink = std::function<void(Resolution, const Candle&)>;
+
+    // Incremental candle builder
+    // Every tick updates the open candle of each resolution in constant time. When a tick
+    // falls into a later bucket, the previous candle is sealed and handed to the sinks.
+    // Buckets without any tick are skipped rather than emitted as empty bars.
+    class CandleAggregator {
+    public:
+        // Register a sink that receives sealed candles
+        void addSink(CandleSink sink);
+
+        // Fold a price observed at timestampMs (milliseconds since epoch) into every resolution
+        // Ticks older than the open bucket of a resolution are folded into that open bucket
+        void addTick(std::int64_t timestampMs, Pricing::Price price);
+
+        // Seal and emit all open candles, e.g. before shutting down
+        void flush();
+
+        // Currently open (not yet sealed) candle, or nullptr if no tick has been seen
+        const Candle* current(Resolution resolution) const;
+
+        // Reopen a candle saved earlier (warm restart); later ticks continue it
+        void restore(Resolution resolution, const Candle& candle);
+
+    private:
+        void seal(std::size_t index);
+
+        std::array<Candle, RESOLUTION_COUNT> open_{};
+        std::array<bool, RESOLUTION_COUNT> active_{};
+        std::vector<CandleSink> sinks_;
+    };
+
+    // Bounded in-memory store of sealed candles, usable as a sink
+    // Keeps the most recent `capacity` candles per resolution
+    class CandleHistory {
+    public:
+        explicit CandleHistory(std::size_t capacity = 1440);
+
+        // Sink to register on a CandleAggregator; the history must outlive the aggregator
+        CandleSink sink();
+
+        // Append a sealed candle, dropping the oldest one when full
+        void append(Resolution resolution, const Candle& candle);
+
+        // Sealed candles for a resolution, oldest first
+        const std::deque<Candle>& bars(Resolution resolution) const;
+
+    private:
+        std::size_t capacity_;
+        std::array<std::deque<Candle>, RESOLUTION_COUNT> bars_;
+    };
+
+} // namespace Candles
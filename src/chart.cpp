@@ -0,0 +1,186 @@
+/*
+ * Charts
+ * See chart.h for an overview.
+ */
+
+#include "chart.h"
+
+#include <algorithm> // For std::min, std::max and std::fill
+#include <cmath> // For std::abs and std::lround
+
+#include "colors.h" // For up/down coloring
+#include "dashboard.h" // For Dashboard::moveTo
+
+namespace Charts {
+
+    namespace {
+
+        // Braille bit of dot row y (0..3) in the left and right dot column of a cell
+        constexpr std::uint8_t LEFT_BITS[4] = { 0x01, 0x02, 0x04, 0x40 };
+        constexpr std::uint8_t RIGHT_BITS[4] = { 0x08, 0x10, 0x20, 0x80 };
+
+        constexpr int MAX_ROWS = 8; // 32 dot rows fit a column mask
+
+    } // namespace
+
+    BrailleChart::BrailleChart(int columns, int rows) : columns_(0), rows_(0), history_(HISTORY) {
+        resize(columns, rows);
+    }
+
+    void BrailleChart::resize(int columns, int rows) {
+        columns = std::max(columns, 1);
+        rows = std::clamp(rows, 1, MAX_ROWS);
+        if (columns == columns_ && rows == rows_) {
+            return;
+        }
+        columns_ = columns;
+        rows_ = rows;
+        dots_.assign(dotColumns(), 0);
+        trend_.assign(dotColumns(), 0);
+        rasterize();
+    }
+
+    void BrailleChart::clear() {
+        historyHead_ = 0;
+        historyCount_ = 0;
+        std::fill(dots_.begin(), dots_.end(), 0);
+        std::fill(trend_.begin(), trend_.end(), 0);
+        head_ = 0;
+        sinceFit_ = 0;
+    }
+
+    double BrailleChart::historyAt(std::size_t age) const {
+        return history_[(historyHead_ + HISTORY - 1 - age) % HISTORY];
+    }
+
+    int BrailleChart::dotRow(double value) const {
+        const int levels = rows_ * 4;
+        if (high_ <= low_) {
+            return levels / 2;
+        }
+        const long level = std::lround((value - low_) / (high_ - low_) * (levels - 1));
+        return levels - 1 - static_cast<int>(std::clamp<long>(level, 0, levels - 1));
+    }
+
+    void BrailleChart::fitRange() {
+        const std::size_t visible = std::min(historyCount_, dotColumns());
+        low_ = high_ = historyAt(0);
+        for (std::size_t age = 1; age < visible; ++age) {
+            low_ = std::min(low_, historyAt(age));
+            high_ = std::max(high_, historyAt(age));
+        }
+        // Headroom so small moves past the extremes keep the incremental path
+        const double pad = std::max((high_ - low_) * 0.1, std::abs(high_) * 0.0005);
+        low_ -= pad;
+        high_ += pad;
+        sinceFit_ = 0;
+    }
+
+    void BrailleChart::drawColumn(std::size_t slot, double previous, double value, bool hasPrevious) {
+        const int y = dotRow(value);
+        int from = y;
+        int to = y;
+        if (hasPrevious) {
+            // Connect to the previous point so steep moves stay visible as a line
+            const int before = dotRow(previous);
+            from = std::min(y, before);
+            to = std::max(y, before);
+        }
+        const std::uint32_t span = (to - from >= 31 ? ~0u : ((1u << (to - from + 1)) - 1)) << from;
+        dots_[slot] = span;
+        trend_[slot] = static_cast<std::int8_t>(!hasPrevious || value == previous ? 0 : (value > previous ? 1 : -1));
+    }
+
+    void BrailleChart::rasterize() {
+        ++rasterizations_;
+        std::fill(dots_.begin(), dots_.end(), 0);
+        std::fill(trend_.begin(), trend_.end(), 0);
+        head_ = 0;
+        if (historyCount_ == 0) {
+            sinceFit_ = 0;
+            return;
+        }
+        fitRange();
+        const std::size_t visible = std::min(historyCount_, dotColumns());
+        for (std::size_t age = visible; age-- > 0;) {
+            const bool hasPrevious = age + 1 < historyCount_;
+            drawColumn(head_, hasPrevious ? historyAt(age + 1) : 0.0, historyAt(age), hasPrevious);
+            head_ = (head_ + 1) % dotColumns();
+        }
+    }
+
+    void BrailleChart::push(double value) {
+        const bool hasPrevious = historyCount_ > 0;
+        const double previous = hasPrevious ? historyAt(0) : 0.0;
+        history_[historyHead_] = value;
+        historyHead_ = (historyHead_ + 1) % HISTORY;
+        historyCount_ = std::min(historyCount_ + 1, HISTORY);
+
+        // Re-plot when the value is off the scale, or once the range was fitted to values
+        // that have all scrolled out
+        if (!hasPrevious || value < low_ || value > high_ || ++sinceFit_ >= dotColumns()) {
+            rasterize();
+            return;
+        }
+        drawColumn(head_, previous, value, true);
+        head_ = (head_ + 1) % dotColumns();
+    }
+
+    void BrailleChart::setLast(double value) {
+        if (historyCount_ == 0) {
+            push(value);
+            return;
+        }
+        history_[(historyHead_ + HISTORY - 1) % HISTORY] = value;
+        if (value < low_ || value > high_) {
+            rasterize();
+            return;
+        }
+        const bool hasPrevious = historyCount_ > 1;
+        drawColumn((head_ + dotColumns() - 1) % dotColumns(), hasPrevious ? historyAt(1) : 0.0, value, hasPrevious);
+    }
+
+    void BrailleChart::render(std::string& out, int row, int column) const {
+        const std::size_t width = dotColumns();
+        const std::size_t filled = std::min(historyCount_, width);
+        const std::size_t blank = width - filled; // Leading dot columns with no data yet (the series is right-aligned)
+        for (int r = 0; r < rows_; ++r) {
+            Dashboard::moveTo(out, row + r, column);
+            const std::string* color = nullptr;
+            for (int c = 0; c < columns_; ++c) {
+                const std::size_t left = static_cast<std::size_t>(c) * 2; // Position from the oldest visible column
+                std::uint8_t bits = 0;
+                int trend = 0;
+                for (int half = 0; half < 2; ++half) {
+                    const std::size_t position = left + half;
+                    if (position < blank) {
+                        continue;
+                    }
+                    const std::size_t slot = (head_ + width - filled + (position - blank)) % width;
+                    const std::uint32_t mask = dots_[slot] >> (r * 4);
+                    for (int y = 0; y < 4; ++y) {
+                        if (mask & (1u << y)) {
+                            bits |= half == 0 ? LEFT_BITS[y] : RIGHT_BITS[y];
+                        }
+                    }
+                    trend = trend_[slot] != 0 ? trend_[slot] : trend;
+                }
+                if (bits == 0) {
+                    out += ' ';
+                    continue;
+                }
+                const std::string& cellColor = trend < 0 ? Colors::RED : Colors::GREEN;
+                if (color != &cellColor) {
+                    out += cellColor;
+                    color = &cellColor;
+                }
+                // U+2800 + bits in UTF-8
+                out += static_cast<char>(0xE2);
+                out += static_cast<char>(0xA0 | (bits >> 6));
+                out += static_cast<char>(0x80 | (bits & 0x3F));
+            }
+            out += Colors::RESET;
+        }
+    }
+
+} // namespace Charts
@@ -0,0 +1,72 @@
+/*
+ * Charts
+ * Braille line chart of a recent price series. Every terminal cell holds a 2x4 dot
+ * matrix (U+2800..U+28FF), so a 48x4 cell chart plots 96 points over 16 levels.
+ * The raster is a ring of dot-column bitmasks: a new price overwrites the oldest
+ * column (the scroll) and draws only that column. The whole series is re-plotted
+ * only when a price leaves the current vertical range, when the range has gone
+ * stale after a full scroll, or when the chart is resized.
+ */
+
+#pragma once
+
+#include <cstddef> // For std::size_t
+#include <cstdint> // For fixed-width integers
+#include <string> // For frames
+#include <vector> // For the rings
+
+namespace Charts {
+
+    class BrailleChart {
+    public:
+        BrailleChart(int columns = 48, int rows = 4);
+
+        // Change the size in cells; re-plots the kept history
+        void resize(int columns, int rows);
+
+        // Drop the series, e.g. when the chart follows another asset
+        void clear();
+
+        // Append a value: scroll by one dot column and draw it
+        void push(double value);
+
+        // Replace the newest value (e.g. the close of a bar that is still open) and redraw its column
+        void setLast(double value);
+
+        // Append the chart as cursor-addressed rows starting at (row, column), 1-based
+        // Cells are green where the price rose and red where it fell
+        void render(std::string& out, int row, int column) const;
+
+        std::size_t size() const { return historyCount_; } // Values kept
+
+        int columns() const { return columns_; }
+        int rows() const { return rows_; }
+
+        // Number of full re-plots so far (the rest of the pushes drew one column)
+        std::uint64_t rasterizations() const { return rasterizations_; }
+
+    private:
+        static constexpr std::size_t HISTORY = 512; // Values kept for re-plotting, at least two screens wide
+
+        std::size_t dotColumns() const { return static_cast<std::size_t>(columns_) * 2; }
+        int dotRow(double value) const; // 0 = top
+        void fitRange();
+        void rasterize();
+        void drawColumn(std::size_t slot, double previous, double value, bool hasPrevious);
+        double historyAt(std::size_t age) const; // age 0 = newest
+
+        int columns_;
+        int rows_;
+        std::vector<double> history_; // Ring of the last HISTORY values
+        std::size_t historyHead_ = 0; // Next slot to write
+        std::size_t historyCount_ = 0;
+        std::vector<std::uint32_t> dots_; // Ring of dot columns, bit y = dot row y
+        std::vector<std::int8_t> trend_; // Per dot column: 1 rose, -1 fell, 0 flat
+        std::size_t head_ = 0; // Slot of the next dot column
+        std::size_t sinceFit_ = 0; // Pushes since the range was fitted
+        double low_ = 0.0;
+        double high_ = 0.0;
+        std::uint64_t rasterizations_ = 0;
+    };
+
+} // namespace Charts
@@ -0,0 +1,20 @@
+/*
+ * Console colors
+ * ANSI escape codes shared by the dashboard, the charts and the main display.
+ */
+
+#pragma once
+
+#include <string> // For the escape sequences
+
+// Define color constants for console output
+// Define ANSI color codes in a namespace for better organization
+namespace Colors {
+    inline const std::string LIGHT_BLUE = "\033[1;34m";
+    inline const std::string GREEN = "\033[1;32m";
+    inline const std::string CYAN = "\033[1;36m";
+    inline const std::string RED = "\033[1;31m";
+    inline const std::string YELLOW = "\033[1;33m";
+    inline const std::string RESET = "\033[0m"; // Reset color to default
+    inline const std::string CLEAR_SCREEN = "\033[2J\033[H"; // ANSI escape code to clear the console screen
+}
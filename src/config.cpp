@@ -0,0 +1,247 @@
+/*
+ * Configuration
+ * See config.h for an overview and the file format.
+ */
+
+#include "config.h"
+
+#include "json.h" // For parsing the settings file
+#include <chrono> // For the polling interval
+#include <filesystem> // For path splitting and modification times
+#include <fstream> // For reading the settings file
+#include <sstream> // For reading the whole file
+
+#include "logger.h" // For reload errors
+
+#ifdef __linux__
+#include <poll.h> // For waiting on inotify with a timeout
+#include <sys/inotify.h> // For file change notifications
+#include <unistd.h> // For read() and close()
+#endif
+
+namespace Config {
+
+    namespace {
+
+        constexpr auto WATCH_INTERVAL = std::chrono::milliseconds(250);
+
+        // Read an integer setting that must be at least `minimum`
+        bool readInt(const nlohmann::json& root, const char* key, int minimum, int& value, std::string& error) {
+            if (!root.contains(key)) {
+                return true;
+            }
+            if (!root[key].is_number_integer() || root[key].get<int>() < minimum) {
+                error = std::string("'") + key + "' must be an integer >= " + std::to_string(minimum);
+                return false;
+            }
+            value = root[key].get<int>();
+            return true;
+        }
+
+        // Read {"<stage>": {"cpus": "0-3" or [0, 1, 2, 3], "node": 0}, ...}
+        bool readPlacement(const nlohmann::json& root, Placement::Plan& plan, std::string& error) {
+            if (!root.contains("placement")) {
+                return true;
+            }
+            const nlohmann::json& stages = root["placement"];
+            if (!stages.is_object()) {
+                error = "'placement' must be an object of stages";
+                return false;
+            }
+            for (const auto& [name, settings] : stages.items()) {
+                Placement::Stage stage;
+                if (!Placement::stageByName(name, stage)) {
+                    error = "unknown placement stage '" + name + "'";
+                    return false;
+                }
+                if (!settings.is_object()) {
+                    error = "placement of '" + name + "' must be an object";
+                    return false;
+                }
+                Placement::StagePlacement& placement = plan[static_cast<std::size_t>(stage)];
+                placement = Placement::StagePlacement{};
+                if (settings.contains("cpus")) {
+                    const nlohmann::json& cpus = settings["cpus"];
+                    std::string list = cpus.is_string() ? cpus.get<std::string>() : std::string();
+                    for (const auto& cpu : cpus.is_array() ? cpus : nlohmann::json::array()) {
+                        if (!cpu.is_number_integer()) {
+                            error = "cpus of '" + name + "' must be a CPU list or an array of CPU numbers";
+                            return false;
+                        }
+                        list += (list.empty() ? "" : ",") + std::to_string(cpu.get<int>());
+                    }
+                    if (!Placement::parseCpuList(list, placement.cpus, error)) {
+                        error = "cpus of '" + name + "': " + error;
+                        return false;
+                    }
+                }
+                if (settings.contains("node")) {
+                    const nlohmann::json& node = settings["node"];
+                    if (!node.is_number_integer() || node.get<int>() < 0 || node.get<int>() > Placement::MAX_NODE) {
+                        error = "node of '" + name + "' must be an integer from 0 to " + std::to_string(Placement::MAX_NODE);
+                        return false;
+                    }
+                    placement.node = node.get<int>();
+                }
+            }
+            return true;
+        }
+
+    } // namespace
+
+    bool parseSettings(const std::string& text, Settings& settings, std::string& error) {
+        const nlohmann::json root = nlohmann::json::parse(text, nullptr, false);
+        if (root.is_discarded() || !root.is_object()) {
+            error = "settings must be a JSON object";
+            return false;
+        }
+        Settings parsed = settings;
+        if (!readInt(root, "poll_interval_s", 1, parsed.pollIntervalSeconds, error)
+            || !readInt(root, "max_retries", 1, parsed.maxRetries, error)
+            || !readInt(root, "connection_timeout_s", 1, parsed.connectionTimeoutSeconds, error)
+            || !readInt(root, "read_timeout_s", 1, parsed.readTimeoutSeconds, error)
+            || !readInt(root, "retry_delay_s", 0, parsed.retryDelaySeconds, error)
+            || !readInt(root, "rate_limit_delay_s", 0, parsed.rateLimitDelaySeconds, error)
+            || !readInt(root, "snapshot_interval_s", 1, parsed.snapshotIntervalSeconds, error)
+            || !readInt(root, "backfill_connections", 1, parsed.backfillConnections, error)
+            || !readInt(root, "backfill_requests_per_minute", 1, parsed.backfillRequestsPerMinute, error)
+            || !readInt(root, "backfill_chunk_days", 1, parsed.backfillChunkDays, error)) {
+            return false;
+        }
+        try {
+            parsed.endpoint = root.value("endpoint", parsed.endpoint);
+            parsed.currency = root.value("currency", parsed.currency);
+            if (root.contains("assets")) {
+                parsed.assets = root["assets"].get<std::vector<std::string>>();
+                parsed.assetIds = Symbols::intern(parsed.assets);
+            }
+            if (!readPlacement(root, parsed.placement, error)) {
+                return false;
+            }
+        } catch (const nlohmann::json::exception& e) {
+            error = e.what();
+            return false;
+        }
+        if (parsed.assets.empty()) {
+            error = "'assets' must list at least one asset";
+            return false;
+        }
+        settings = std::move(parsed);
+        return true;
+    }
+
+    bool loadSettings(const std::string& path, Settings& settings, std::string& error) {
+        std::ifstream input(path);
+        if (!input) {
+            error = "cannot open " + path;
+            return false;
+        }
+        std::ostringstream text;
+        text << input.rdbuf();
+        if (!parseSettings(text.str(), settings, error)) {
+            error = path + ": " + error;
+            return false;
+        }
+        return true;
+    }
+
+    ConfigStore::ConfigStore(Settings initial)
+        : current_(std::make_shared<const Settings>(std::move(initial))) {}
+
+    void ConfigStore::publish(std::shared_ptr<const Settings> settings) {
+        current_.store(std::move(settings), std::memory_order_release);
+        version_.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    ConfigWatcher::ConfigWatcher(std::string path, ConfigStore& store) : path_(std::move(path)), store_(store) {}
+
+    ConfigWatcher::~ConfigWatcher() {
+        stop();
+    }
+
+    void ConfigWatcher::start() {
+        running_ = true;
+        thread_ = std::thread(&ConfigWatcher::run, this);
+    }
+
+    void ConfigWatcher::stop() {
+        running_ = false;
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    void ConfigWatcher::reload() {
+        Settings settings;
+        std::string error;
+        if (!loadSettings(path_, settings, error)) {
+            Logging::error("Configuration reload failed, keeping previous settings", { { "error", error } });
+            return;
+        }
+        // Alert thresholds and candles are fixed-point in the startup currency's scale, so the
+        // currency is the one setting that needs a restart
+        const std::string currency = store_.current()->currency;
+        if (settings.currency != currency) {
+            Logging::warning("Currency changes take effect after a restart", { { "currency", currency } });
+            settings.currency = currency;
+        }
+        // Threads are placed when they start
+        if (settings.placement != store_.current()->placement) {
+            Logging::warning("Placement changes take effect after a restart", { { "path", path_ } });
+            settings.placement = store_.current()->placement;
+        }
+        store_.publish(std::make_shared<const Settings>(std::move(settings)));
+        Logging::info("Configuration reloaded", { { "path", path_ } });
+    }
+
+    void ConfigWatcher::run() {
+        Placement::enter(Placement::Stage::Config);
+        const std::filesystem::path file(path_);
+#ifdef __linux__
+        // Watch the directory rather than the file: editors often save by writing a new file
+        // and renaming it over the old one, which would orphan a watch on the file itself
+        const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        const std::string directory = file.has_parent_path() ? file.parent_path().string() : ".";
+        if (fd >= 0 && inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) >= 0) {
+            const std::string name = file.filename().string();
+            alignas(inotify_event) char buffer[4096];
+            while (running_) {
+                pollfd pfd{ fd, POLLIN, 0 };
+                if (::poll(&pfd, 1, static_cast<int>(WATCH_INTERVAL.count())) <= 0) {
+                    continue;
+                }
+                bool changed = false;
+                ssize_t length;
+                while ((length = ::read(fd, buffer, sizeof(buffer))) > 0) {
+                    for (char* p = buffer; p < buffer + length;) {
+                        const auto* event = reinterpret_cast<const inotify_event*>(p);
+                        changed = changed || (event->len > 0 && name == event->name);
+                        p += sizeof(inotify_event) + event->len;
+                    }
+                }
+                if (changed) {
+                    reload();
+                }
+            }
+            ::close(fd);
+            return;
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        Logging::warning("inotify unavailable, polling the configuration file", { { "path", path_ } });
+#endif
+        // Portable fallback: compare the modification time periodically
+        std::error_code ec;
+        auto lastWrite = std::filesystem::last_write_time(file, ec);
+        while (running_) {
+            std::this_thread::sleep_for(WATCH_INTERVAL);
+            const auto write = std::filesystem::last_write_time(file, ec);
+            if (!ec && write != lastWrite) {
+                lastWrite = write;
+                reload();
+            }
+        }
+    }
+
+} // namespace Config
@@ -0,0 +1,95 @@
+/*
+ * Configuration
+ * Tracker settings loaded from a JSON file and published as immutable snapshots.
+ * A watcher thread reloads the file when it changes (inotify on Linux, modification-time
+ * polling elsewhere) and swaps the snapshot atomically, so cadence, retries, endpoint and
+ * asset list can be retuned without restarting and losing in-memory state.
+ */
+
+#pragma once
+
+#include <atomic> // For the snapshot pointer and stop flag
+#include <cstdint> // For fixed-width integers
+#include <memory> // For shared snapshots
+#include <string> // For paths and names
+#include <thread> // For the watcher thread
+#include <vector> // For the asset list
+
+#include "placement.h" // For per-stage thread placement
+#include "symbols.h" // For interned asset ids
+
+namespace Config {
+
+    // One immutable configuration snapshot; the defaults match the original hard-coded values
+    struct Settings {
+        int pollIntervalSeconds = 60; // Time between two updates
+        int maxRetries = 3; // Attempts per update
+        int connectionTimeoutSeconds = 5;
+        int readTimeoutSeconds = 5;
+        int retryDelaySeconds = 5; // Wait after a connection failure or server error
+        int rateLimitDelaySeconds = 10; // Wait after HTTP 429
+        int snapshotIntervalSeconds = 60; // Time between two state snapshots (with --snapshot)
+        int backfillConnections = 4; // Parallel range requests (with --backfill)
+        int backfillRequestsPerMinute = 30; // Request budget shared by the backfill workers
+        int backfillChunkDays = 90; // Period per range request
+        std::string endpoint = "https://api.coingecko.com"; // Scheme, host and optional port
+        std::vector<std::string> assets = { "bitcoin" }; // CoinGecko ids
+        std::vector<Symbols::Id> assetIds = Symbols::intern(assets); // Parallel to assets, interned at load
+        std::string currency = "usd"; // CoinGecko vs_currency code
+        Placement::Plan placement; // CPUs and NUMA node per thread stage, applied at startup
+    };
+
+    // Parse settings from JSON text, e.g.
+    // {"poll_interval_s": 30, "max_retries": 3, "connection_timeout_s": 5, "read_timeout_s": 5,
+    //  "retry_delay_s": 5, "rate_limit_delay_s": 10, "snapshot_interval_s": 60,
+    //  "backfill_connections": 4, "backfill_requests_per_minute": 30, "backfill_chunk_days": 90, "endpoint": "https://api.coingecko.com",
+    //  "assets": ["bitcoin", "ethereum"], "currency": "usd",
+    //  "placement": {"main": {"cpus": "2-3", "node": 0}, "backfill": {"node": 1}, "logger": {"cpus": [7]}}}
+    // Missing keys keep their defaults. Returns false and fills `error` on invalid input.
+    bool parseSettings(const std::string& text, Settings& settings, std::string& error);
+
+    // Read and parse a settings file
+    bool loadSettings(const std::string& path, Settings& settings, std::string& error);
+
+    // Holder of the current snapshot; readers take a reference-counted pointer and keep using
+    // it for a whole tick, writers replace it in one atomic store
+    class ConfigStore {
+    public:
+        explicit ConfigStore(Settings initial);
+
+        std::shared_ptr<const Settings> current() const { return current_.load(std::memory_order_acquire); }
+
+        void publish(std::shared_ptr<const Settings> settings);
+
+        // Incremented on every publish, so readers can cheaply notice a change
+        std::uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+    private:
+        std::atomic<std::shared_ptr<const Settings>> current_;
+        std::atomic<std::uint64_t> version_{ 0 };
+    };
+
+    // Reloads a settings file into a store whenever the file changes
+    // Invalid files are logged and ignored; the previous snapshot stays in effect, and so do the
+    // currency and the thread placement
+    class ConfigWatcher {
+    public:
+        ConfigWatcher(std::string path, ConfigStore& store);
+        ConfigWatcher(const ConfigWatcher&) = delete;
+        ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+        ~ConfigWatcher();
+
+        void start();
+        void stop();
+
+    private:
+        void run();
+        void reload();
+
+        std::string path_;
+        ConfigStore& store_;
+        std::atomic<bool> running_{ false };
+        std::thread thread_;
+    };
+
+} // namespace Config
@@ -0,0 +1,369 @@
+/*
+ * Dashboard
+ * See dashboard.h for an overview.
+ */
+
+#include "dashboard.h"
+
+#include <algorithm> // For std::min, std::max and std::minmax_element
+#include <atomic> // For the resize flag
+#include <cctype> // For std::toupper
+#include <charconv> // For std::to_chars
+#include <utility> // For std::move
+
+#include "colors.h" // For ANSI color codes
+
+#ifdef _WIN32
+#include <windows.h> // For GetConsoleScreenBufferInfo
+#else
+#include <csignal> // For SIGWINCH
+#include <sys/ioctl.h> // For TIOCGWINSZ
+#include <unistd.h> // For STDOUT_FILENO
+#endif
+
+namespace Dashboard {
+
+    namespace {
+
+        std::atomic<bool> resized(false);
+
+#ifndef _WIN32
+        void onResize(int) {
+            resized = true;
+        }
+#endif
+
+        // Eight block heights, each three UTF-8 bytes and one column wide
+        constexpr const char* BLOCKS[] = { "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█" };
+
+        // Append `text` and pad it with spaces to `width` columns (text is ASCII)
+        void padded(std::string& out, std::string_view text, int width) {
+            const std::size_t length = std::min(text.size(), static_cast<std::size_t>(width));
+            out.append(text.substr(0, length));
+            out.append(static_cast<std::size_t>(width) - length, ' ');
+        }
+
+    } // namespace
+
+    void moveTo(std::string& out, int row, int column) {
+        char buffer[32];
+        char* end = buffer;
+        *end++ = '\033';
+        *end++ = '[';
+        end = std::to_chars(end, end + 11, row).ptr; // 11 characters fit any int
+        *end++ = ';';
+        end = std::to_chars(end, end + 11, column).ptr;
+        *end++ = 'H';
+        out.append(buffer, end);
+    }
+
+    TerminalSize terminalSize() {
+        TerminalSize size;
+#ifdef _WIN32
+        CONSOLE_SCREEN_BUFFER_INFO info;
+        if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) {
+            size.columns = info.srWindow.Right - info.srWindow.Left + 1;
+            size.rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+        }
+#else
+        winsize window{};
+        if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &window) == 0 && window.ws_col > 0 && window.ws_row > 0) {
+            size.columns = window.ws_col;
+            size.rows = window.ws_row;
+        }
+#endif
+        return size;
+    }
+
+    void watchResize() {
+#ifndef _WIN32
+        struct sigaction action{};
+        action.sa_handler = onResize;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART; // Do not interrupt blocking reads of the exit-key thread
+        sigaction(SIGWINCH, &action, nullptr);
+#endif
+    }
+
+    bool takeResize() {
+#ifdef _WIN32
+        // No resize signal on Windows; compare with the size seen last time
+        static TerminalSize last = terminalSize();
+        const TerminalSize now = terminalSize();
+        const bool changed = now.rows != last.rows || now.columns != last.columns;
+        last = now;
+        return changed;
+#else
+        return resized.exchange(false);
+#endif
+    }
+
+    void setupConsole() {
+#ifdef _WIN32
+        SetConsoleOutputCP(CP_UTF8);
+        HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+        DWORD mode;
+        GetConsoleMode(console, &mode);
+        SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+#endif
+    }
+
+    Arena::String formatLine(std::string_view label, std::string_view value) {
+        Arena::String line(label);
+        line.resize(std::max<std::size_t>(line.size(), 25), ' ');
+        line.append(value);
+        return line;
+    }
+
+    void progressBar(std::string& out, int current, int total, int width, int row, int column) {
+        moveTo(out, row, column);
+        out += Colors::YELLOW;
+        out += "\033[K["; // Clear the line first
+        const int filled = static_cast<int>(static_cast<double>(current) / total * width);
+        for (int i = 0; i < width; ++i) {
+            out += i < filled ? "█" : "-";
+        }
+        char buffer[32];
+        const auto end = std::to_chars(buffer, buffer + sizeof(buffer), current * 100.0 / total, std::chars_format::fixed, 1).ptr;
+        out += "] ";
+        out.append(buffer, end);
+        out += "% (";
+        out += std::to_string(total - current);
+        out += "s remaining)";
+        out += Colors::RESET;
+    }
+
+    void Sparkline::push(double value) {
+        values_[head_] = value;
+        head_ = (head_ + 1) % POINTS;
+        count_ = std::min(count_ + 1, POINTS);
+    }
+
+    void Sparkline::render(std::string& out) const {
+        if (count_ == 0) {
+            return;
+        }
+        const std::size_t first = (head_ + POINTS - count_) % POINTS;
+        double low = values_[first];
+        double high = low;
+        for (std::size_t i = 1; i < count_; ++i) {
+            const double value = values_[(first + i) % POINTS];
+            low = std::min(low, value);
+            high = std::max(high, value);
+        }
+        const double range = high - low;
+        for (std::size_t i = 0; i < count_; ++i) {
+            const double value = values_[(first + i) % POINTS];
+            const int level = range > 0.0 ? static_cast<int>((value - low) / range * 7.0 + 0.5) : 0;
+            out += BLOCKS[level];
+        }
+    }
+
+    Grid Grid::fit(TerminalSize size, std::size_t panels, int reservedRows) {
+        Grid grid;
+        grid.columns = std::max(1, (size.columns + PANEL_GAP) / (PANEL_WIDTH + PANEL_GAP));
+        const int needed = std::max(1, static_cast<int>((panels + grid.columns - 1) / grid.columns));
+        // One row below the grid is kept for the "more assets" line
+        const int available = std::max(1, (size.rows - HEADER_ROWS - 1 - reservedRows) / PANEL_HEIGHT);
+        grid.rows = std::min(needed, available);
+        grid.visible = std::min(panels, static_cast<std::size_t>(grid.rows) * grid.columns);
+        return grid;
+    }
+
+    Screen::Screen(std::string title) : title_(std::move(title)) {
+    }
+
+    void Screen::setAssets(const std::vector<std::string>& assets) {
+        const bool same = assets.size() == panels_.size() &&
+                          std::equal(assets.begin(), assets.end(), panels_.begin(), [](const std::string& asset, const Panel& panel) { return asset == panel.asset; });
+        if (same) {
+            return;
+        }
+        if (panels_.empty() || assets.empty() || panels_.front().asset != assets.front()) {
+            chart_.clear(); // The chart follows another asset now
+        }
+        std::vector<Panel> panels(assets.size());
+        for (std::size_t i = 0; i < assets.size(); ++i) {
+            auto kept = std::find_if(panels_.begin(), panels_.end(), [&](const Panel& panel) { return panel.asset == assets[i]; });
+            if (kept != panels_.end()) {
+                panels[i] = std::move(*kept);
+                kept->asset.clear(); // Moved from; never match it twice
+                continue;
+            }
+            panels[i].asset = assets[i];
+            panels[i].label = assets[i].substr(0, PANEL_WIDTH - 9); // Leave room for the change
+            if (!panels[i].label.empty()) {
+                panels[i].label[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(panels[i].label[0])));
+            }
+        }
+        panels_ = std::move(panels);
+        full_ = true;
+    }
+
+    void Screen::updatePanel(std::size_t index, Pricing::Price price, const Pricing::PriceText& text) {
+        Panel& panel = panels_[index];
+        const double value = price.toDouble();
+        panel.change = panel.valid && panel.last != 0.0 ? (value - panel.last) / panel.last * 100.0 : 0.0;
+        panel.last = value;
+        panel.text = text;
+        panel.valid = true;
+        panel.dirty = true;
+        panel.sparkline.push(value);
+    }
+
+    void Screen::plotBar(std::int64_t openTime, double close) {
+        if (chart_.size() > 0 && openTime == chartBarTime_) {
+            chart_.setLast(close);
+        } else if (chart_.size() == 0 || openTime > chartBarTime_) {
+            chart_.push(close);
+            chartBarTime_ = openTime;
+        }
+        chartDirty_ = true;
+    }
+
+    void Screen::clearChart() {
+        chart_.clear();
+        chartDirty_ = true;
+    }
+
+    void Screen::markUnavailable(std::size_t index) {
+        Panel& panel = panels_[index];
+        panel.valid = false;
+        panel.dirty = true;
+    }
+
+    void Screen::setStatus(std::size_t line, std::string_view text, const std::string& color) {
+        if (line >= status_.size()) {
+            status_.resize(line + 1);
+            full_ = true; // The grid may have to shrink
+        }
+        Status& status = status_[line];
+        if (status.text != text || status.color != &color) {
+            status.text.assign(text);
+            status.color = &color;
+            status.dirty = true;
+        }
+    }
+
+    int Screen::chartRow() const {
+        return HEADER_ROWS + 1 + grid_.rows * PANEL_HEIGHT + 1;
+    }
+
+    int Screen::statusRow() const {
+        return chartRow() + (showChart_ ? CHART_HEIGHT : 0);
+    }
+
+    int Screen::nextRow() const {
+        return statusRow() + static_cast<int>(status_.size());
+    }
+
+    void Screen::renderPanel(std::string& out, const Panel& panel, int row, int column) const {
+        // Name and change since the previous update
+        char change[16];
+        std::size_t changeLength = 0;
+        if (panel.valid && panel.sparkline.size() > 1) {
+            char* end = change;
+            if (panel.change >= 0.0) {
+                *end++ = '+';
+            }
+            end = std::to_chars(end, change + sizeof(change) - 1, panel.change, std::chars_format::fixed, 2).ptr;
+            *end++ = '%';
+            changeLength = static_cast<std::size_t>(end - change);
+        }
+        const std::string& trend = panel.change < 0.0 ? Colors::RED : Colors::GREEN;
+        moveTo(out, row, column);
+        out += Colors::CYAN;
+        padded(out, panel.label, PANEL_WIDTH - static_cast<int>(changeLength));
+        out += trend;
+        out.append(change, changeLength);
+
+        // Price
+        moveTo(out, row + 1, column);
+        if (panel.valid) {
+            out += trend;
+            padded(out, panel.text.view(), PANEL_WIDTH);
+        } else {
+            out += Colors::RED;
+            padded(out, "Not available.", PANEL_WIDTH);
+        }
+
+        // Sparkline of the recent updates
+        moveTo(out, row + 2, column);
+        out += Colors::LIGHT_BLUE;
+        panel.sparkline.render(out);
+        out.append(Sparkline::POINTS - panel.sparkline.size(), ' ');
+        out += Colors::RESET;
+    }
+
+    void Screen::renderStatus(std::string& out, const Status& status, int row) const {
+        moveTo(out, row, 1);
+        out += "\033[K"; // Clear the previous text
+        out += status.color ? *status.color : Colors::RESET;
+        out += status.text;
+        out += Colors::RESET;
+    }
+
+    void Screen::render(std::string& out) {
+        if (takeResize() || full_) {
+            size_ = terminalSize();
+        }
+        // The chart needs room for itself and at least one row of panels
+        const int reserved = static_cast<int>(status_.size()) + 1;
+        const bool showChart = !panels_.empty() && size_.rows >= HEADER_ROWS + 1 + PANEL_HEIGHT + 1 + CHART_HEIGHT + reserved;
+        const Grid grid = Grid::fit(size_, panels_.size(), reserved + (showChart ? CHART_HEIGHT : 0));
+        if (grid.columns != grid_.columns || grid.rows != grid_.rows || grid.visible != grid_.visible || showChart != showChart_) {
+            full_ = true;
+        }
+        grid_ = grid;
+        showChart_ = showChart;
+        const int width = std::min(std::max(grid_.columns * (PANEL_WIDTH + PANEL_GAP) - PANEL_GAP, 50), size_.columns);
+
+        if (full_) {
+            out += Colors::CLEAR_SCREEN;
+            // Title bar across the grid
+            const int margin = std::max(0, (width - static_cast<int>(title_.size())) / 2);
+            out += Colors::LIGHT_BLUE;
+            out.append(static_cast<std::size_t>(width), '=');
+            out += '\n';
+            out.append(static_cast<std::size_t>(margin), ' ');
+            out += title_;
+            out += '\n';
+            out.append(static_cast<std::size_t>(width), '=');
+            out += Colors::RESET;
+            if (grid_.visible < panels_.size()) {
+                moveTo(out, statusRow() - 1, 1);
+                out += Colors::YELLOW;
+                out += "+ ";
+                out += std::to_string(panels_.size() - grid_.visible);
+                out += " more assets (enlarge the terminal to see them)";
+                out += Colors::RESET;
+            }
+        }
+        for (std::size_t i = 0; i < grid_.visible; ++i) {
+            Panel& panel = panels_[i];
+            if (full_ || panel.dirty) {
+                const int row = HEADER_ROWS + 1 + static_cast<int>(i / grid_.columns) * PANEL_HEIGHT;
+                const int column = 1 + static_cast<int>(i % grid_.columns) * (PANEL_WIDTH + PANEL_GAP);
+                renderPanel(out, panel, row, column);
+                panel.dirty = false;
+            }
+        }
+        if (showChart_ && (full_ || chartDirty_)) {
+            chart_.resize(width, CHART_ROWS);
+            moveTo(out, chartRow(), 1);
+            out += Colors::CYAN;
+            out += panels_.front().label;
+            out += Colors::RESET;
+            chart_.render(out, chartRow() + 1, 1);
+            chartDirty_ = false;
+        }
+        for (std::size_t i = 0; i < status_.size(); ++i) {
+            if (full_ || status_[i].dirty) {
+                renderStatus(out, status_[i], statusRow() + static_cast<int>(i));
+                status_[i].dirty = false;
+            }
+        }
+        full_ = false;
+    }
+
+} // namespace Dashboard
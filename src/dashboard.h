@@ -0,0 +1,149 @@
+/*
+ * Dashboard
+ * Terminal layout engine tiling one panel per asset in a grid sized to the terminal.
+ * The size comes from TIOCGWINSZ and is re-read after SIGWINCH. Each frame is built
+ * into one string of cursor-addressed writes covering only the panels and status lines
+ * that changed, so 50+ assets repaint at 1 Hz without clearing the screen. When there
+ * is room, a braille chart of the first asset's candle closes is drawn below the grid.
+ */
+
+#pragma once
+
+#include <array> // For the sparkline ring
+#include <cstddef> // For std::size_t
+#include <cstdint> // For bar times
+#include <string> // For labels and frames
+#include <string_view> // For text parameters
+#include <vector> // For panels and status lines
+
+#include "arena.h" // For per-update status text
+#include "chart.h" // For the braille chart of the first asset
+#include "price.h" // For fixed-point prices
+
+namespace Dashboard {
+
+    struct TerminalSize {
+        int rows = 24;
+        int columns = 80;
+    };
+
+    // Current terminal size, or 24x80 when the output is not a terminal
+    TerminalSize terminalSize();
+
+    // Install the SIGWINCH handler (no-op on Windows, where the size is compared every frame)
+    void watchResize();
+
+    // True once after each terminal resize
+    bool takeResize();
+
+    // Switch the console to UTF-8 and enable ANSI escape codes (Windows; a no-op elsewhere)
+    void setupConsole();
+
+    // Status line text with the label padded to a fixed column, e.g. "Last Updated:   ..."
+    // Allocated from the current tick arena, like the other per-update text
+    Arena::String formatLine(std::string_view label, std::string_view value);
+
+    // Append the ANSI escape that moves the cursor to (row, column), 1-based
+    void moveTo(std::string& out, int row, int column);
+
+    // Append an ASCII progress bar with percentage and time remaining at (row, column), 1-based
+    void progressBar(std::string& out, int current, int total, int width, int row, int column);
+
+    constexpr int PANEL_WIDTH = 24; // Columns of text per panel
+    constexpr int PANEL_GAP = 2; // Blank columns between panels
+    constexpr int PANEL_HEIGHT = 4; // Name/change, price, sparkline, blank
+    constexpr int HEADER_ROWS = 3; // Title bar
+    constexpr int CHART_ROWS = 4; // Braille rows of the chart (16 dot rows)
+    constexpr int CHART_HEIGHT = CHART_ROWS + 2; // Chart plus its title and a blank line
+
+    // Recent prices drawn with the eight block heights "▁▂▃▄▅▆▇█", scaled to the window's range
+    class Sparkline {
+    public:
+        static constexpr std::size_t POINTS = PANEL_WIDTH;
+
+        void push(double value);
+        void render(std::string& out) const; // Appends at most POINTS glyphs
+        std::size_t size() const { return count_; }
+
+    private:
+        std::array<double, POINTS> values_{};
+        std::size_t head_ = 0; // Next slot to write
+        std::size_t count_ = 0;
+    };
+
+    // Panel grid fitted to a terminal
+    struct Grid {
+        int columns = 1; // Panels per row
+        int rows = 1; // Panel rows that fit on screen
+        std::size_t visible = 0; // Panels drawn; the rest are summarized on one line
+
+        // Fit `panels` panels below the header, leaving `reservedRows` for status lines
+        static Grid fit(TerminalSize size, std::size_t panels, int reservedRows);
+    };
+
+    class Screen {
+    public:
+        explicit Screen(std::string title);
+
+        // Replace the asset list; panels of assets that stay keep their history
+        void setAssets(const std::vector<std::string>& assets);
+
+        void updatePanel(std::size_t index, Pricing::Price price, const Pricing::PriceText& text);
+        void markUnavailable(std::size_t index);
+
+        // Plot the close of the first asset's candle opened at `openTime`: a later bar appends a
+        // point, the bar already plotted last (still open) moves its point
+        void plotBar(std::int64_t openTime, double close);
+
+        // Drop the plotted bars, e.g. when the chart switches to another resolution
+        void clearChart();
+
+        // Status lines below the grid, e.g. last update time and exit instructions
+        void setStatus(std::size_t line, std::string_view text, const std::string& color);
+
+        // Append the escape sequences for everything that changed since the last frame
+        // A resize or a new asset list repaints the whole screen
+        void render(std::string& out);
+
+        // Force a full repaint on the next frame
+        void invalidate() { full_ = true; }
+
+        // First free terminal row below the status lines (1-based), e.g. for a progress bar
+        int nextRow() const;
+
+    private:
+        struct Panel {
+            std::string asset;
+            std::string label; // Capitalized asset id, truncated to the panel width
+            Pricing::PriceText text{};
+            double last = 0.0;
+            double change = 0.0; // Percent change since the previous update
+            bool valid = false;
+            bool dirty = true;
+            Sparkline sparkline;
+        };
+
+        struct Status {
+            std::string text;
+            const std::string* color = nullptr;
+            bool dirty = true;
+        };
+
+        void renderPanel(std::string& out, const Panel& panel, int row, int column) const;
+        void renderStatus(std::string& out, const Status& status, int row) const;
+        int chartRow() const; // Chart title row (1-based)
+        int statusRow() const; // First status row (1-based)
+
+        std::string title_;
+        std::vector<Panel> panels_;
+        std::vector<Status> status_;
+        TerminalSize size_{};
+        Grid grid_{};
+        Charts::BrailleChart chart_; // Bar closes of the first asset
+        std::int64_t chartBarTime_ = 0; // Open time of the newest plotted bar
+        bool showChart_ = false;
+        bool chartDirty_ = true;
+        bool full_ = true;
+    };
+
+} // namespace Dashboard
@@ -0,0 +1,263 @@
+/*
+ * Price fetching
+ * See fetch.h for an overview.
+ */
+
+#include "fetch.h"
+
+#include <httplib.h> // For the kept-alive client
+#include <mutex> // For fetchers on several threads
+#include <thread> // For retry delays
+
+#include "buffers.h" // For pooled response bodies
+#include "logger.h" // For fetch errors
+#include "replay.h" // For recording responses
+#include "symbols.h" // For the per-asset price gauges
+#if BTC_IO_URING
+#include "uring.h" // For the io_uring client
+#endif
+
+namespace Fetch {
+
+    FetchMetrics& metrics() {
+        static FetchMetrics instance;
+        return instance;
+    }
+
+    Metrics::Gauge& priceGauge(Symbols::Id asset) {
+        static std::mutex mutex;
+        static Symbols::IdMap<Metrics::Gauge*> gauges;
+        std::lock_guard<std::mutex> lock(mutex);
+        Metrics::Gauge*& gauge = gauges[asset];
+        if (gauge == nullptr) {
+            gauge = &Metrics::registry().gauge("btc_price", "Last successfully fetched price", "asset=\"" + std::string(Symbols::name(asset)) + "\"");
+        }
+        return *gauge;
+    }
+
+#if BTC_IO_URING
+    namespace {
+
+        // io_uring client for a plain-http:// base URL, or nullptr to use httplib
+        std::unique_ptr<Uring::HttpClient> openUringClient(const std::string& baseUrl) {
+            std::string host;
+            int port = 0;
+            if (!Uring::available() || !Uring::parseHttpUrl(baseUrl, host, port)) {
+                return nullptr;
+            }
+            auto client = std::make_unique<Uring::HttpClient>(host, port);
+            std::string error;
+            if (!client->open(error)) {
+                Logging::warning("io_uring client unavailable, using httplib", { { "error", error } });
+                return nullptr;
+            }
+            return client;
+        }
+
+    } // namespace
+#endif
+
+    std::string simplePriceTarget(const std::vector<std::string>& assets, const std::string& currency) {
+        return Schema::SimplePrice::target(assets, currency);
+    }
+
+    PriceFetcher::PriceFetcher(Settings settings) : settings_(std::move(settings)) {
+    }
+
+    PriceFetcher::~PriceFetcher() = default;
+
+    bool PriceFetcher::fetch(const Config::Settings& config, const Pricing::CurrencySpec& currency, std::vector<Pricing::Price>& prices) {
+        prices.assign(config.assets.size(), Pricing::Price{});
+        try {
+            FetchMetrics& metrics = Fetch::metrics();
+            const Settings& settings = settings_;
+            Timings& timings = timings_;
+            const std::string& baseUrl = settings.baseUrl.empty() ? config.endpoint : settings.baseUrl;
+            // Create the client only once per base URL, so the connection is reused across calls
+            if (clientUrl_ != baseUrl) {
+                clientUrl_ = baseUrl;
+                client_.reset();
+#if BTC_IO_URING
+                uring_ = openUringClient(baseUrl);
+                if (!uring_)
+#endif
+                {
+                    client_ = std::make_unique<httplib::Client>(baseUrl);
+                    // Called after name resolution, just before connect()
+                    client_->set_socket_options([this](socket_t) { timings_.socketReady = Timings::Clock::now(); });
+                    // Called right after the TLS handshake; leave the decision to the default verification
+                    client_->set_server_certificate_verifier([this](SSL*) {
+                        timings_.connected = Timings::Clock::now();
+                        return httplib::SSLVerifierResponse::NoDecisionMade;
+                    });
+                }
+            }
+            // Timeouts may change with every configuration reload
+            if (client_) {
+                client_->set_connection_timeout(config.connectionTimeoutSeconds);
+                client_->set_read_timeout(config.readTimeoutSeconds);
+            }
+#if BTC_IO_URING
+            if (uring_) {
+                uring_->setTimeouts(config.connectionTimeoutSeconds, config.readTimeoutSeconds);
+            }
+#endif
+
+            // The target and the key set only change with the asset list, so updates reuse them
+            if (assetKeys_.keys() != config.assets || targetCurrency_ != config.currency) {
+                assetKeys_ = Schema::KeySet(config.assets);
+                target_ = simplePriceTarget(config.assets, config.currency);
+                targetCurrency_ = config.currency;
+            }
+            const std::string& target = target_;
+
+            // Retry delays shrink with the replay speed so accelerated runs stay accelerated
+            auto retryDelay = [&settings](int seconds) {
+                return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::duration<double>(seconds / settings.speed));
+            };
+            // Attempt to fetch the prices with retries
+            // This loop will retry up to max_retries times in case of connection issues or errors
+            const int maxRetries = config.maxRetries; // Maximum number of retries
+            for (int attempt = 1; attempt <= maxRetries; ++attempt) {
+                if (attempt > 1) {
+                    metrics.retries.increment();
+                }
+                metrics.requests.increment();
+                timings.reset();
+                const std::int64_t recordOffset = settings.recorder ? settings.recorder->elapsedNs() : 0;
+                // The body goes into a recycled buffer, handed back when this attempt ends
+                Buffers::BufferPool::Lease body = Buffers::responsePool().acquire();
+                int status = 0; // 0 when no response was received
+                std::string failure;
+                httplib::Headers headers; // Only kept for the recorder
+#if BTC_IO_URING
+                if (uring_) {
+                    Uring::Request request;
+                    request.target = target;
+                    request.body = &*body;
+                    uring_->perform(&request, 1);
+                    status = request.status;
+                    failure = request.error;
+                    timings.socketReady = request.socketReady;
+                    timings.connected = request.connected;
+                    timings.headers = request.headersReceived;
+                    if (settings.recorder) {
+                        for (const auto& [name, value] : request.headers) {
+                            headers.emplace(std::string(name), std::string(value));
+                        }
+                    }
+                } else
+#endif
+                {
+                    auto res = client_->Get(target,
+                        [&timings](const httplib::Response&) {
+                            timings.headers = Timings::Clock::now();
+                            return true;
+                        },
+                        [&body](const char* data, size_t length) {
+                            body->append(data, length);
+                            return true;
+                        });
+                    if (res) {
+                        status = res->status;
+                        headers = std::move(res->headers);
+                    } else {
+                        failure = httplib::to_string(res.error());
+                    }
+                }
+                const auto finished = Timings::Clock::now();
+                metrics.total.record(finished - timings.start);
+                // Record the phases that were observed for this attempt
+                auto ready = timings.start;
+                if (timings.socketReady != Timings::Clock::time_point()) {
+                    metrics.dns.record(timings.socketReady - timings.start);
+                    ready = timings.socketReady;
+                }
+                if (timings.connected != Timings::Clock::time_point()) {
+                    metrics.connectTls.record(timings.connected - ready);
+                    ready = timings.connected;
+                }
+                if (timings.headers != Timings::Clock::time_point()) {
+                    metrics.ttfb.record(timings.headers - ready);
+                    metrics.body.record(finished - timings.headers);
+                }
+                // Capture the exchange for offline replay (connection failures have nothing to replay)
+                if (settings.recorder && status != 0) {
+                    Replay::Exchange exchange;
+                    exchange.offsetNs = recordOffset;
+                    exchange.durationUs = static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(finished - timings.start).count());
+                    exchange.target = target;
+                    exchange.status = status;
+                    exchange.headers = std::move(headers);
+                    exchange.body = body->view();
+                    settings.recorder->append(exchange);
+                }
+                // Check if the response is null (indicating a connection failure)
+                if (status == 0) {
+                    metrics.connectError.increment();
+                    Logging::error("Failed to connect to CoinGecko API", { { "attempt", attempt }, { "max_attempts", maxRetries }, { "error", failure } });
+                    if (attempt < maxRetries) {
+                        Logging::warning("Retrying", { { "delay_s", config.retryDelaySeconds } });
+                        std::this_thread::sleep_for(retryDelay(config.retryDelaySeconds));
+                        continue;
+                    }
+                    return false;
+                }
+                // Check if the response status is not OK (200)
+                if (status != 200) {
+                    // Describe specific HTTP status codes
+                    const char* reason = "";
+                    if (status == 429) {
+                        reason = "Rate limit exceeded";
+                        metrics.rateLimited.increment();
+                    } else if (status == 400) {
+                        reason = "Bad request";
+                    } else if (status == 401) {
+                        reason = "Unauthorized access";
+                    } else if (status == 404) {
+                        reason = "Resource not found";
+                    } else if (status >= 500) {
+                        reason = "Server error";
+                    }
+                    metrics.httpError.increment();
+                    Logging::error("HTTP error", { { "status", status }, { "reason", reason }, { "attempt", attempt }, { "max_attempts", maxRetries } });
+                    // Rate limits wait longer than server errors before retrying
+                    if ((status == 429 || status >= 500) && attempt < maxRetries) {
+                        const int delay = status == 429 ? config.rateLimitDelaySeconds : config.retryDelaySeconds;
+                        Logging::warning("Retrying", { { "delay_s", delay } });
+                        std::this_thread::sleep_for(retryDelay(delay));
+                        continue;
+                    }
+                    // If we reach here, it means the request failed after all retries
+                    return false;
+                }
+                // Success: extract every asset's price from the raw JSON number text
+                std::string error;
+                const auto parseStart = Timings::Clock::now();
+                const bool parsed = Pricing::extractSimplePrices(body->view(), assetKeys_, currency, prices, error) == Pricing::ExtractResult::Ok;
+                metrics.parse.record(Timings::Clock::now() - parseStart);
+                if (!parsed) {
+                    metrics.parseError.increment();
+                    Logging::error("Invalid price response", { { "error", error } });
+                    return false;
+                }
+                metrics.success.increment();
+                for (std::size_t i = 0; i < prices.size(); ++i) {
+                    if (prices[i].valid()) {
+                        priceGauge(config.assetIds[i]).set(prices[i].toDouble());
+                    } else {
+                        Logging::warning("Asset missing from price response", { { "asset", config.assets[i] } });
+                    }
+                }
+                metrics.lastSuccess.set(std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count());
+                return true;
+            }
+        }
+        catch (const std::exception& e) {
+            Logging::error("Unexpected error", { { "error", e.what() } });
+            return false;
+        }
+        return false; // Fallback in case of unexpected loop exit
+    }
+
+} // namespace Fetch
@@ -0,0 +1,122 @@
+/*
+ * Price fetching
+ * Requests the configured assets from /api/v3/simple/price in one call over a kept-alive
+ * connection, retrying connection failures, 429s and server errors, receives the body into a
+ * pooled buffer and extracts every price from the JSON number text. Builds with BTC_IO_URING
+ * fetch plain-http:// endpoints (the mock server, replay) through io_uring instead of httplib.
+ * Each attempt is timed by phase (DNS, connect/TLS, time to first byte, body, parse) into the
+ * process-wide metrics registry, and can be recorded for offline replay.
+ */
+
+#pragma once
+
+#include <chrono> // For phase timestamps
+#include <memory> // For the owned client
+#include <string> // For URLs and targets
+#include <vector> // For asset lists and prices
+
+#include "config.h" // For timeouts, retries and the asset list
+#include "metrics.h" // For fetch counters and latency histograms
+#include "price.h" // For fixed-point prices
+#include "schema.h" // For the endpoint and the asset key set
+
+// Only pointers cross this header, so httplib.h stays out of its includers
+namespace httplib {
+    class Client;
+}
+
+namespace Replay {
+    class Recorder;
+}
+
+#if BTC_IO_URING
+namespace Uring {
+    class HttpClient;
+}
+#endif
+
+namespace Fetch {
+
+    // Counters, gauges and per-phase latency histograms for the fetch path
+    // Registered once in the process-wide registry and exported on /metrics when enabled
+    struct FetchMetrics {
+        Metrics::Registry& r = Metrics::registry();
+        Metrics::Counter& requests = r.counter("btc_fetch_requests", "HTTP requests sent to the price API");
+        Metrics::Counter& retries = r.counter("btc_fetch_retries", "Fetch attempts retried after a failure");
+        Metrics::Counter& rateLimited = r.counter("btc_fetch_rate_limited", "HTTP 429 responses from the price API");
+        Metrics::Counter& success = r.counter("btc_fetch_results", "Fetch attempts by outcome", "result=\"success\"");
+        Metrics::Counter& connectError = r.counter("btc_fetch_results", "Fetch attempts by outcome", "result=\"connect_error\"");
+        Metrics::Counter& httpError = r.counter("btc_fetch_results", "Fetch attempts by outcome", "result=\"http_error\"");
+        Metrics::Counter& parseError = r.counter("btc_fetch_results", "Fetch attempts by outcome", "result=\"parse_error\"");
+        // DNS and connect/TLS are only observed when a new connection is opened (keep-alive reuses it);
+        // httplib has no hook between TCP connect and the TLS handshake, so both are one phase. The
+        // io_uring client resolves its host once, when it is created, so there dns covers socket setup only
+        Metrics::Histogram& dns = r.histogram("btc_fetch_phase_seconds", "Fetch latency by phase", "phase=\"dns\"");
+        Metrics::Histogram& connectTls = r.histogram("btc_fetch_phase_seconds", "Fetch latency by phase", "phase=\"connect_tls\"");
+        Metrics::Histogram& ttfb = r.histogram("btc_fetch_phase_seconds", "Fetch latency by phase", "phase=\"ttfb\"");
+        Metrics::Histogram& body = r.histogram("btc_fetch_phase_seconds", "Fetch latency by phase", "phase=\"body\"");
+        Metrics::Histogram& parse = r.histogram("btc_fetch_phase_seconds", "Fetch latency by phase", "phase=\"parse\"");
+        Metrics::Histogram& total = r.histogram("btc_fetch_duration_seconds", "End-to-end duration of one HTTP attempt");
+        Metrics::Gauge& lastSuccess = r.gauge("btc_fetch_last_success_timestamp_seconds", "Unix time of the last successful fetch");
+    };
+
+    // The process-wide instance, registered on first use
+    FetchMetrics& metrics();
+
+    // Gauge holding the last price of an asset, registered the first time the asset is seen
+    Metrics::Gauge& priceGauge(Symbols::Id asset);
+
+    // Timestamps of the phases of the current HTTP attempt, filled in by httplib callbacks
+    struct Timings {
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point start; // Request issued
+        Clock::time_point socketReady; // Name resolved and socket created (new connections only)
+        Clock::time_point connected; // TCP connected and TLS handshake verified (new connections only)
+        Clock::time_point headers; // Response status line and headers received
+
+        void reset() {
+            start = Clock::now();
+            socketReady = connected = headers = Clock::time_point();
+        }
+    };
+
+    // Where and how the fetcher fetches, beyond the configuration snapshot
+    struct Settings {
+        std::string baseUrl; // Overrides the configured endpoint when set (replay mode)
+        double speed = 1.0; // Time acceleration, divides retry delays (replay mode)
+        Replay::Recorder* recorder = nullptr; // When set, every response is appended to the recording
+    };
+
+    // "/api/v3/simple/price?ids=a,b&vs_currencies=usd"
+    std::string simplePriceTarget(const std::vector<std::string>& assets, const std::string& currency);
+
+    // Fetches prices over one connection, kept across calls; not thread-safe, use one per thread
+    class PriceFetcher {
+    public:
+        explicit PriceFetcher(Settings settings = {});
+        ~PriceFetcher();
+
+        PriceFetcher(const PriceFetcher&) = delete;
+        PriceFetcher& operator=(const PriceFetcher&) = delete;
+
+        // Fetch the current prices of config.assets in one request
+        // `prices` is parallel to config.assets; assets missing from the response get an invalid
+        // Price. Returns false if the fetch failed after every retry.
+        bool fetch(const Config::Settings& config, const Pricing::CurrencySpec& currency, std::vector<Pricing::Price>& prices);
+
+        const Settings& settings() const { return settings_; }
+
+    private:
+        Settings settings_;
+        std::unique_ptr<httplib::Client> client_;
+#if BTC_IO_URING
+        std::unique_ptr<Uring::HttpClient> uring_; // Used instead of client_ for http:// base URLs
+#endif
+        std::string clientUrl_; // Base URL the client was created for
+        Timings timings_; // Phase timestamps of the current attempt
+        Schema::KeySet assetKeys_; // Perfect hash of the configured assets, rebuilt when the list changes
+        std::string target_; // Request target for assetKeys_ and targetCurrency_
+        std::string targetCurrency_;
+    };
+
+} // namespace Fetch
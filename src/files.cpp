@@ -0,0 +1,88 @@
+/*
+ * Append-only output files
+ * See files.h for an overview.
+ */
+
+#include "files.h"
+
+#if BTC_IO_URING
+#include "uring.h" // For the io_uring writer
+#endif
+
+namespace Files {
+
+    Appender::Appender() = default;
+
+    Appender::~Appender() {
+        close();
+    }
+
+    bool Appender::open(const std::string& path, bool truncate) {
+        close();
+#if BTC_IO_URING
+        if (Uring::available()) {
+            auto writer = std::make_unique<Uring::FileWriter>();
+            std::string error;
+            if (writer->open(path, truncate, error)) {
+                uring_ = std::move(writer);
+                return true;
+            }
+        }
+#endif
+        file_ = std::fopen(path.c_str(), truncate ? "wb" : "ab");
+        return file_ != nullptr;
+    }
+
+    bool Appender::isOpen() const {
+#if BTC_IO_URING
+        if (uring_ != nullptr) {
+            return true;
+        }
+#endif
+        return file_ != nullptr;
+    }
+
+    void Appender::append(const char* data, std::size_t length) {
+#if BTC_IO_URING
+        if (uring_ != nullptr) {
+            uring_->append(data, length);
+            return;
+        }
+#endif
+        if (file_ != nullptr) {
+            std::fwrite(data, 1, length, file_);
+        }
+    }
+
+    bool Appender::flush() {
+#if BTC_IO_URING
+        if (uring_ != nullptr) {
+            return uring_->flush();
+        }
+#endif
+        return file_ != nullptr && std::fflush(file_) == 0;
+    }
+
+    void Appender::close() {
+#if BTC_IO_URING
+        if (uring_ != nullptr) {
+            uring_->close();
+            uring_.reset();
+        }
+#endif
+        if (file_ != nullptr) {
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+    }
+
+    const char* Appender::backend() const {
+#if BTC_IO_URING
+        if (uring_ != nullptr) {
+            return "io_uring";
+        }
+#endif
+        return "stdio";
+    }
+
+} // namespace Files
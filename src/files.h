@@ -0,0 +1,55 @@
+/*
+ * Append-only output files
+ * The tick logs (the structured log and --record recordings) write through an Appender. In
+ * builds with BTC_IO_URING it appends through io_uring with registered buffers, so a flush
+ * hands several buffers to the kernel in one call and the writing thread does not block on
+ * each write(); elsewhere, or when the kernel refuses a ring, it is a buffered stdio file.
+ */
+
+#pragma once
+
+#include <cstddef> // For std::size_t
+#include <cstdio> // For the stdio fallback
+#include <memory> // For the io_uring writer
+#include <string> // For paths
+
+#if BTC_IO_URING
+namespace Uring {
+    class FileWriter;
+}
+#endif
+
+namespace Files {
+
+    // One file opened for appending; used by one thread at a time
+    class Appender {
+    public:
+        Appender();
+        ~Appender();
+        Appender(const Appender&) = delete;
+        Appender& operator=(const Appender&) = delete;
+
+        // Open `path` for appending, emptying it first if `truncate`; false if it cannot be opened
+        bool open(const std::string& path, bool truncate = false);
+
+        bool isOpen() const;
+
+        void append(const char* data, std::size_t length);
+
+        // Hand everything appended so far to the kernel; false if a write failed
+        bool flush();
+
+        // Flush and close; the Appender can be opened again afterwards
+        void close();
+
+        // "io_uring" or "stdio", for startup logs
+        const char* backend() const;
+
+    private:
+        std::FILE* file_ = nullptr;
+#if BTC_IO_URING
+        std::unique_ptr<Uring::FileWriter> uring_;
+#endif
+    };
+
+} // namespace Files
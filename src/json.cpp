@@ -0,0 +1,19 @@
+/*
+ * JSON
+ * Explicit instantiations declared extern in json.h.
+ */
+
+#include "json.h"
+
+template class nlohmann::basic_json<>;
+template class nlohmann::json_sax<nlohmann::json>;
+template class nlohmann::detail::lexer<nlohmann::json, JsonInstances::StringInput>;
+template class nlohmann::detail::parser<nlohmann::json, JsonInstances::StringInput>;
+template class nlohmann::detail::lexer<nlohmann::json, JsonInstances::TextInput>;
+template class nlohmann::detail::parser<nlohmann::json, JsonInstances::TextInput>;
+template class nlohmann::detail::serializer<nlohmann::json>;
+
+template class nlohmann::json_sax<Arena::Json>;
+template class nlohmann::detail::lexer<Arena::Json, JsonInstances::TextInput>;
+template class nlohmann::detail::parser<Arena::Json, JsonInstances::TextInput>;
+template class nlohmann::detail::serializer<Arena::Json>;
@@ -0,0 +1,46 @@
+/*
+ * JSON
+ * Includes nlohmann::json and declares its common instantiations extern: the value type,
+ * the SAX interface, the string lexer and parser, and the serializer are compiled once
+ * in json.cpp instead of in every translation unit that reads or writes JSON.
+ * Arena::Json is the same type with its nodes and strings allocated from the current tick arena.
+ */
+
+#pragma once
+
+#include <json.hpp> // For nlohmann::json
+#include <string> // For the input adapter type
+#include <string_view> // For parsing received buffers
+
+#include "arena.h" // For the arena allocator
+
+namespace JsonInstances {
+    using StringInput = nlohmann::detail::iterator_input_adapter<std::string::const_iterator>;
+    using TextInput = nlohmann::detail::iterator_input_adapter<const char*>; // Bodies in response buffers
+}
+
+namespace Arena {
+    // Values must be destroyed inside the TickScope they were created in (see arena.h)
+    using Json = nlohmann::basic_json<std::map, std::vector, String, bool, std::int64_t, std::uint64_t, double, Allocator>;
+
+    // SAX events for a JSON text, like Json::sax_parse(text, sax), whose CBOR/MessagePack readers
+    // only accept std::string keys and so do not compile for Arena::Json
+    template <typename Sax>
+    bool saxParse(std::string_view text, Sax* sax) {
+        return nlohmann::detail::parser<Json, JsonInstances::TextInput>(nlohmann::detail::input_adapter(text.data(), text.data() + text.size())).sax_parse(sax, true);
+    }
+}
+
+extern template class nlohmann::basic_json<>;
+extern template class nlohmann::json_sax<nlohmann::json>;
+extern template class nlohmann::detail::lexer<nlohmann::json, JsonInstances::StringInput>;
+extern template class nlohmann::detail::parser<nlohmann::json, JsonInstances::StringInput>;
+extern template class nlohmann::detail::lexer<nlohmann::json, JsonInstances::TextInput>;
+extern template class nlohmann::detail::parser<nlohmann::json, JsonInstances::TextInput>;
+extern template class nlohmann::detail::serializer<nlohmann::json>;
+
+// Arena::Json's binary readers and writers only accept std::string, so its value type is instantiated where used
+extern template class nlohmann::json_sax<Arena::Json>;
+extern template class nlohmann::detail::lexer<Arena::Json, JsonInstances::TextInput>;
+extern template class nlohmann::detail::parser<Arena::Json, JsonInstances::TextInput>;
+extern template class nlohmann::detail::serializer<Arena::Json>;
@@ -0,0 +1,344 @@
+/*
+ * Asynchronous structured logging
+ * See logger.h for an overview.
+ */
+
+#include "logger.h"
+
+#include "files.h" // For the log file
+#include "placement.h" // For the drain thread's placement
+#include "timefmt.h" // For ISO-8601 record timestamps
+
+#include <algorithm> // For std::min
+#include <array> // For fixed-size record storage
+#include <atomic> // For the lock-free ring indices
+#include <chrono> // For timestamps and the drain interval
+#include <charconv> // For std::to_chars
+#include <cmath> // For std::isfinite
+#include <condition_variable> // For waking the drain thread on stop
+#include <cstdio> // For std::snprintf
+#include <cstring> // For std::memcpy
+#include <memory> // For shared ownership of ring buffers
+#include <mutex> // For the buffer registry
+#include <thread> // For the drain thread
+#include <type_traits> // For std::is_floating_point_v
+#include <vector> // For the buffer registry
+
+namespace Logging {
+
+    namespace {
+
+        constexpr std::size_t MAX_FIELDS = 6;
+        constexpr std::size_t TEXT_BYTES = 256; // Shared storage for the text values of one record
+        constexpr std::size_t RING_CAPACITY = 256; // Records per thread, must be a power of two
+        constexpr auto DRAIN_INTERVAL = std::chrono::milliseconds(50);
+
+        // Field as stored in the ring: text values point into the record's own text area
+        struct StoredField {
+            const char* key;
+            Field::Type type;
+            std::uint16_t textOffset;
+            std::uint16_t textLength;
+            std::int64_t integer;
+            double real;
+        };
+
+        // One log record, copied into the ring by the producer and formatted later by the drain thread
+        struct Record {
+            std::int64_t timestampNs;
+            const char* message;
+            Level level;
+            std::uint8_t fieldCount;
+            std::uint16_t textUsed;
+            std::array<StoredField, MAX_FIELDS> fields;
+            std::array<char, TEXT_BYTES> text;
+        };
+
+        // Single-producer/single-consumer ring owned by one logging thread
+        struct RingBuffer {
+            alignas(64) std::atomic<std::size_t> head{ 0 }; // Next slot to write (producer)
+            alignas(64) std::atomic<std::size_t> tail{ 0 }; // Next slot to read (consumer)
+            std::atomic<bool> ownerGone{ false }; // Set when the owning thread exits; no record follows
+            std::array<Record, RING_CAPACITY> records;
+        };
+
+        // Shared logger state; buffers stay in the registry after their thread exits until they are drained
+        struct State {
+            std::mutex registryMutex;
+            std::vector<std::shared_ptr<RingBuffer>> buffers;
+            std::atomic<bool> running{ false };
+            std::atomic<std::uint64_t> dropped{ 0 };
+            std::mutex wakeMutex;
+            std::condition_variable wake;
+            std::thread drainThread;
+            Files::Appender file;
+            Format format = Format::JsonLines;
+
+            // Stop the drain thread if the program exits without calling stop()
+            ~State() {
+                running.store(false);
+                wake.notify_all();
+                if (drainThread.joinable()) {
+                    drainThread.join();
+                }
+            }
+        };
+
+        State& state() {
+            static State instance;
+            return instance;
+        }
+
+        // A thread's ring; marks it for removal from the registry when the thread exits
+        struct BufferOwner {
+            std::shared_ptr<RingBuffer> buffer = std::make_shared<RingBuffer>();
+
+            BufferOwner() {
+                std::lock_guard<std::mutex> lock(state().registryMutex);
+                state().buffers.push_back(buffer);
+            }
+
+            ~BufferOwner() {
+                buffer->ownerGone.store(true, std::memory_order_release);
+            }
+        };
+
+        // Ring of the calling thread, registered on first use
+        RingBuffer& threadBuffer() {
+            thread_local BufferOwner owner;
+            return *owner.buffer;
+        }
+
+        const char* levelName(Level level) {
+            switch (level) {
+                case Level::Debug: return "debug";
+                case Level::Info: return "info";
+                case Level::Warning: return "warning";
+                case Level::Error: return "error";
+            }
+            return "unknown";
+        }
+
+        // Append `text` to `line` as a JSON string literal
+        void appendJsonString(std::string& line, std::string_view text) {
+            line += '"';
+            for (char c : text) {
+                switch (c) {
+                    case '"': line += "\\\""; break;
+                    case '\\': line += "\\\\"; break;
+                    case '\n': line += "\\n"; break;
+                    case '\r': line += "\\r"; break;
+                    case '\t': line += "\\t"; break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20) {
+                            char escaped[8];
+                            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                            line += escaped;
+                        } else {
+                            line += c;
+                        }
+                }
+            }
+            line += '"';
+        }
+
+        template <typename T>
+        void appendNumber(std::string& line, T value) {
+            // JSON has no nan or inf; write null rather than an unparseable line
+            if constexpr (std::is_floating_point_v<T>) {
+                if (!std::isfinite(value)) {
+                    line += "null";
+                    return;
+                }
+            }
+            char digits[32];
+            const auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+            line.append(digits, end);
+        }
+
+        // {"ts":"2025-07-05T10:59:00.123Z","level":"error","msg":"...","status":429}
+        void writeJsonLine(Files::Appender& file, const Record& record, std::string& line) {
+            line.clear();
+            line += "{\"ts\":\"";
+            const auto time = std::chrono::system_clock::time_point(
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(record.timestampNs)));
+            line += TimeFormat::iso8601Utc(time).view();
+            line += "\",\"level\":\"";
+            line += levelName(record.level);
+            line += "\",\"msg\":";
+            appendJsonString(line, record.message);
+            for (std::size_t i = 0; i < record.fieldCount; ++i) {
+                const StoredField& field = record.fields[i];
+                line += ',';
+                appendJsonString(line, field.key);
+                line += ':';
+                switch (field.type) {
+                    case Field::Type::Int: appendNumber(line, field.integer); break;
+                    case Field::Type::Double: appendNumber(line, field.real); break;
+                    case Field::Type::Bool: line += field.integer != 0 ? "true" : "false"; break;
+                    case Field::Type::Text:
+                        appendJsonString(line, std::string_view(record.text.data() + field.textOffset, field.textLength));
+                        break;
+                }
+            }
+            line += "}\n";
+            file.append(line.data(), line.size());
+        }
+
+        // Binary layout per record (little-endian host order):
+        // int64 timestamp ns, uint8 level, uint8 field count, uint16 message length, message bytes,
+        // then per field: uint8 key length, key bytes, uint8 type, and either 8 value bytes
+        // or uint16 text length plus text bytes
+        void writeBinaryRecord(Files::Appender& file, const Record& record, std::string& out) {
+            out.clear();
+            auto put = [&out](const void* data, std::size_t size) { out.append(static_cast<const char*>(data), size); };
+            put(&record.timestampNs, sizeof(record.timestampNs));
+            put(&record.level, 1);
+            put(&record.fieldCount, 1);
+            const auto messageLength = static_cast<std::uint16_t>(std::strlen(record.message));
+            put(&messageLength, sizeof(messageLength));
+            put(record.message, messageLength);
+            for (std::size_t i = 0; i < record.fieldCount; ++i) {
+                const StoredField& field = record.fields[i];
+                const auto keyLength = static_cast<std::uint8_t>(std::strlen(field.key));
+                put(&keyLength, 1);
+                put(field.key, keyLength);
+                put(&field.type, 1);
+                if (field.type == Field::Type::Text) {
+                    put(&field.textLength, sizeof(field.textLength));
+                    put(record.text.data() + field.textOffset, field.textLength);
+                } else if (field.type == Field::Type::Double) {
+                    put(&field.real, sizeof(field.real));
+                } else {
+                    put(&field.integer, sizeof(field.integer));
+                }
+            }
+            file.append(out.data(), out.size());
+        }
+
+        // Pop and write every pending record; returns true if anything was written
+        bool drainOnce(State& s, std::string& scratch) {
+            std::vector<std::shared_ptr<RingBuffer>> buffers;
+            {
+                std::lock_guard<std::mutex> lock(s.registryMutex);
+                buffers = s.buffers;
+            }
+            bool wrote = false;
+            bool finished = false; // Some exited thread's ring is now empty
+            for (const auto& buffer : buffers) {
+                // Read before head: once the owner is gone, head is final and this drain empties the ring
+                const bool ownerGone = buffer->ownerGone.load(std::memory_order_acquire);
+                std::size_t tail = buffer->tail.load(std::memory_order_relaxed);
+                const std::size_t head = buffer->head.load(std::memory_order_acquire);
+                for (; tail != head; ++tail) {
+                    const Record& record = buffer->records[tail & (RING_CAPACITY - 1)];
+                    if (s.format == Format::Binary) {
+                        writeBinaryRecord(s.file, record, scratch);
+                    } else {
+                        writeJsonLine(s.file, record, scratch);
+                    }
+                    wrote = true;
+                }
+                buffer->tail.store(tail, std::memory_order_release);
+                finished = finished || ownerGone;
+            }
+            if (finished) {
+                // Drop drained rings of exited threads (backfill and server workers come and go)
+                std::lock_guard<std::mutex> lock(s.registryMutex);
+                std::erase_if(s.buffers, [](const std::shared_ptr<RingBuffer>& buffer) {
+                    return buffer->ownerGone.load(std::memory_order_acquire)
+                        && buffer->tail.load(std::memory_order_relaxed) == buffer->head.load(std::memory_order_acquire);
+                });
+            }
+            if (wrote) {
+                s.file.flush();
+            }
+            return wrote;
+        }
+
+        void drainLoop() {
+            Placement::enter(Placement::Stage::Logger);
+            State& s = state();
+            std::string scratch;
+            while (s.running.load(std::memory_order_acquire)) {
+                if (!drainOnce(s, scratch)) {
+                    std::unique_lock<std::mutex> lock(s.wakeMutex);
+                    s.wake.wait_for(lock, DRAIN_INTERVAL, [&s] { return !s.running.load(); });
+                }
+            }
+            drainOnce(s, scratch); // Final drain after stop()
+        }
+
+    } // namespace
+
+    bool start(const std::string& path, Format format) {
+        State& s = state();
+        if (s.running.load()) {
+            return true;
+        }
+        if (!s.file.open(path)) {
+            return false;
+        }
+        s.format = format;
+        s.running.store(true, std::memory_order_release);
+        s.drainThread = std::thread(drainLoop);
+        return true;
+    }
+
+    void stop() {
+        State& s = state();
+        if (!s.running.exchange(false)) {
+            return;
+        }
+        s.wake.notify_all();
+        if (s.drainThread.joinable()) {
+            s.drainThread.join();
+        }
+        s.file.close();
+    }
+
+    void log(Level level, const char* message, std::initializer_list<Field> fields) {
+        if (!state().running.load(std::memory_order_relaxed)) {
+            return;
+        }
+        RingBuffer& buffer = threadBuffer();
+        const std::size_t head = buffer.head.load(std::memory_order_relaxed);
+        if (head - buffer.tail.load(std::memory_order_acquire) == RING_CAPACITY) {
+            state().dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        // Copy the raw arguments only; formatting happens on the drain thread
+        Record& record = buffer.records[head & (RING_CAPACITY - 1)];
+        record.timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        record.message = message;
+        record.level = level;
+        record.fieldCount = 0;
+        record.textUsed = 0;
+        for (const Field& field : fields) {
+            if (record.fieldCount == MAX_FIELDS) {
+                break;
+            }
+            StoredField& stored = record.fields[record.fieldCount++];
+            stored.key = field.key;
+            stored.type = field.type;
+            stored.integer = field.integer;
+            stored.real = field.real;
+            if (field.type == Field::Type::Text) {
+                // Truncate text that does not fit in the remaining text area
+                const std::size_t length = std::min(field.text.size(), TEXT_BYTES - record.textUsed);
+                std::memcpy(record.text.data() + record.textUsed, field.text.data(), length);
+                stored.textOffset = record.textUsed;
+                stored.textLength = static_cast<std::uint16_t>(length);
+                record.textUsed = static_cast<std::uint16_t>(record.textUsed + length);
+            }
+        }
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+
+    std::uint64_t droppedRecords() {
+        return state().dropped.load(std::memory_order_relaxed);
+    }
+
+} // namespace Logging
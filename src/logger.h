@@ -0,0 +1,67 @@
+/*
+ * Asynchronous structured logging
+ * Log calls copy their raw arguments into a per-thread lock-free ring buffer and return;
+ * a background drain thread formats the records and writes them as JSON lines (or a
+ * compact binary stream) to a file, so logging never blocks the fetch path or tears the UI.
+ */
+
+#pragma once
+
+#include <cstddef> // For std::size_t
+#include <cstdint> // For fixed-width integers
+#include <initializer_list> // For the field list
+#include <string> // For the log file path
+#include <string_view> // For text fields
+
+namespace Logging {
+
+    enum class Level : std::uint8_t { Debug, Info, Warning, Error };
+
+    // On-disk encoding of the log file
+    enum class Format { JsonLines, Binary };
+
+    // A key/value pair attached to a log record
+    // Keys and the record message must be string literals (only the pointer is stored);
+    // text values are copied, so temporaries are fine
+    struct Field {
+        enum class Type : std::uint8_t { Int, Double, Bool, Text };
+
+        Field(const char* key, int value) : key(key), type(Type::Int), integer(value) {}
+        Field(const char* key, long value) : key(key), type(Type::Int), integer(value) {}
+        Field(const char* key, long long value) : key(key), type(Type::Int), integer(value) {}
+        Field(const char* key, unsigned value) : key(key), type(Type::Int), integer(value) {}
+        Field(const char* key, unsigned long value) : key(key), type(Type::Int), integer(static_cast<std::int64_t>(value)) {}
+        Field(const char* key, unsigned long long value) : key(key), type(Type::Int), integer(static_cast<std::int64_t>(value)) {}
+        Field(const char* key, double value) : key(key), type(Type::Double), real(value) {}
+        Field(const char* key, bool value) : key(key), type(Type::Bool), integer(value ? 1 : 0) {}
+        Field(const char* key, const char* value) : key(key), type(Type::Text), text(value) {}
+        Field(const char* key, std::string_view value) : key(key), type(Type::Text), text(value) {}
+        Field(const char* key, const std::string& value) : key(key), type(Type::Text), text(value) {}
+
+        const char* key;
+        Type type;
+        std::int64_t integer = 0;
+        double real = 0.0;
+        std::string_view text;
+    };
+
+    // Start the drain thread writing to `path`; returns false if the file cannot be opened
+    // Records logged before start() (or after stop()) are discarded
+    bool start(const std::string& path, Format format = Format::JsonLines);
+
+    // Drain every pending record, close the file and stop the drain thread
+    void stop();
+
+    // Queue a record; never blocks. If the calling thread's ring is full the record is dropped
+    // and counted (see droppedRecords())
+    void log(Level level, const char* message, std::initializer_list<Field> fields = {});
+
+    // Number of records dropped because a ring buffer was full
+    std::uint64_t droppedRecords();
+
+    inline void debug(const char* message, std::initializer_list<Field> fields = {}) { log(Level::Debug, message, fields); }
+    inline void info(const char* message, std::initializer_list<Field> fields = {}) { log(Level::Info, message, fields); }
+    inline void warning(const char* message, std::initializer_list<Field> fields = {}) { log(Level::Warning, message, fields); }
+    inline void error(const char* message, std::initializer_list<Field> fields = {}) { log(Level::Error, message, fields); }
+
+} // namespace Logging
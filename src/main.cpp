@@ -8,8 +8,8 @@
  * Version: 0.1
  */
 
-#include <httplib.h> // For HTTP requests
-#include <json.hpp> // For JSON manipulation
+#include <httplib.h> // For the metrics server
+#include "json.h" // For /query error bodies
 #include <iostream> // For console output
 #include <string> // For string manipulation
 #include <thread> // For sleep functionality  
@@ -18,149 +18,25 @@
 #include <csignal> // For signal handling
 #include <atomic>  // For thread-safe exit flag
 #include <limits> // For std::numeric_limits to clear input buffer
+#include <memory> // For the replay server
+#include <vector> // For asset lists
 
-#ifdef _WIN32 // For Windows-specific functionality
-#include <windows.h> // For UTF-8 encoding
-#endif
-
-// Define color constants for console output
-// Define ANSI color codes in a namespace for better organization
-namespace Colors {
-    const std::string LIGHT_BLUE = "\033[1;34m";
-    const std::string GREEN = "\033[1;32m";
-    const std::string CYAN = "\033[1;36m";
-    const std::string RED = "\033[1;31m";
-    const std::string YELLOW = "\033[1;33m";
-    const std::string RESET = "\033[0m"; // Reset color to default
-    const std::string CLEAR_SCREEN = "\033[2J\033[H"; // ANSI escape code to clear the console screen
-}
-
-// Define the JSON namespace for convenience
-using json = nlohmann::json;
-
-// Function to enable ANSI escape codes for colored output on Windows
-void enableANSICodes() {
-#ifdef _WIN32
-    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-    DWORD consoleMode;
-    GetConsoleMode(hConsole, &consoleMode);
-    consoleMode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
-    SetConsoleMode(hConsole, consoleMode);
-#endif
-}
-
-// Function to get the current time formatted as "MM/DD/YYYY HH:MM AM/PM"
-// This function caches the formatted time to avoid repeated formatting within the same second
-std::string getCurrentTimeFormatted() {
-    static std::string cachedTime; // Cached formatted time
-    static std::chrono::system_clock::time_point lastUpdate; // Last update timestamp
-
-    auto now = std::chrono::system_clock::now();
-    // Check if the current second is the same as the last update
-    auto secondsSinceLastUpdate = std::chrono::duration_cast<std::chrono::seconds>(now - lastUpdate).count();
-    if (secondsSinceLastUpdate < 1 && !cachedTime.empty()) {
-        return cachedTime; // Return cached result
-    }
-
-    // Update cache
-    auto time = std::chrono::system_clock::to_time_t(now);
-    std::ostringstream oss; 
-    oss << std::put_time(std::localtime(&time), "%m/%d/%Y %I:%M %p");
-    cachedTime = oss.str();
-    lastUpdate = now;
-    return cachedTime;
-}
-
-// Function to fetch the current Bitcoin price from CoinGecko API
-double getBitcoinPrice() {
-    try {
-        static httplib::Client cli("https://api.coingecko.com"); // Create a client for CoinGecko API
-        static bool initialized = false; // Static variable to ensure initialization only once
-        // Initialize connection and read timeouts only once
-        // This prevents repeated initialization on each function call
-        if (!initialized) { 
-            cli.set_connection_timeout(5);
-            cli.set_read_timeout(5);
-            initialized = true;
-        }
-        // Attempt to fetch the Bitcoin price with retries
-        // This loop will retry up to 3 times in case of connection issues or errors
-        const int maxRetries = 3; // Maximum number of retries
-        for (int attempt = 1; attempt <= maxRetries; ++attempt) {
-            auto res = cli.Get("/api/v3/simple/price?ids=bitcoin&vs_currencies=usd"); 
-            // Check if the response is null (indicating a connection failure)
-            if (!res) {
-                std::cerr << Colors::RED << "Error: Failed to connect to CoinGecko API (Attempt " << attempt << "/" << maxRetries << ")" << Colors::RESET << std::endl;
-                if (attempt < maxRetries) {
-                    std::cerr << Colors::YELLOW << "Retrying in 5 seconds..." << Colors::RESET << std::endl;
-                    std::this_thread::sleep_for(std::chrono::seconds(5));
-                    continue;
-                }
-                return -1.0;
-            }
-            // Check if the response status is not OK (200)
-            if (res->status != 200) {
-                std::cerr << Colors::RED << "HTTP error: Status code " << res->status << " (Attempt " << attempt << "/" << maxRetries << ")" << Colors::RESET;
-                if (res->status == 429) {
-                    std::cerr << " (Rate limit exceeded)";
-                    if (attempt < maxRetries) {
-                        std::cerr << Colors::YELLOW << "Retrying in 10 seconds..." << Colors::RESET << std::endl;
-                        std::this_thread::sleep_for(std::chrono::seconds(10));
-                        continue;
-                    }
-                // Handle specific HTTP status codes
-                } else if (res->status == 400) {
-                    std::cerr << " (Bad request)";
-                } else if (res->status == 401) {
-                    std::cerr << " (Unauthorized access)";
-                } else if (res->status == 404) { 
-                    std::cerr << " (Resource not found)";
-                } else if (res->status >= 500) {
-                    std::cerr << " (Server error)";
-                    if (attempt < maxRetries) {
-                        // If it's a server error, wait longer before retrying
-                        std::cerr << Colors::YELLOW << "Retrying in 5 seconds..." << Colors::RESET << std::endl;
-                        std::this_thread::sleep_for(std::chrono::seconds(5));
-                        continue;
-                    }
-                }
-                // If we reach here, it means the request failed after all retries
-                std::cerr << Colors::RESET << std::endl;
-                return -1.0;
-            }
-            // Success: parse JSON and return price
-            json j = json::parse(res->body);
-            if (!j.contains("bitcoin") || !j["bitcoin"].contains("usd")) {
-                std::cerr << Colors::RED << "Error: Invalid JSON structure (missing 'bitcoin' or 'usd' key)" << Colors::RESET << std::endl;
-                return -1.0;
-            }
-            return j["bitcoin"]["usd"].get<double>(); // Extract the Bitcoin price in USD
-        }
-    }
-    catch (const nlohmann::json::parse_error& e) {
-        std::cerr << Colors::RED << "Error: Failed to parse JSON response: " << e.what() << Colors::RESET << std::endl;
-        return -1.0;
-    }
-    catch (const std::exception& e) {
-        std::cerr << Colors::RED << "Unexpected error: " << e.what() << Colors::RESET << std::endl;
-        return -1.0;
-    }
-    return -1.0; // Fallback in case of unexpected loop exit
-}
-
-// Function to display a decorative border
-// The width of the border can be specified, default is 50 characters
-void printBorder(const std::string& title, int width = 50) {
-    std::cout << Colors::LIGHT_BLUE; // Light blue for the border
-    std::cout << std::string(width, '=') << "\n";
-    std::cout << std::string((width - title.length() - 2) / 2, ' ') << " " << title << " " << std::string((width - title.length() - 2) / 2, ' ') << "\n";
-    std::cout << std::string(width, '=') << Colors::RESET << "\n";
-}
-
-// Function to print a formatted line with label, value, and color
-void printFormattedLine(const std::string& label, const std::string& value, const std::string& color) {
-    std::cout << color << std::setw(25) << std::left << label << value << Colors::RESET << "\n";
-}
+#include "arena.h" // For per-update scratch memory
+#include "colors.h" // For ANSI color codes
+#include "price.h" // For fixed-point price parsing and formatting
+#include "timefmt.h" // For thread-safe timestamp formatting
+#include "logger.h" // For asynchronous structured error logging
+#include "metrics.h" // For the /metrics endpoint
+#include "replay.h" // For recording and replaying API responses
+#include "alerts.h" // For price alert rules
+#include "config.h" // For the hot-reloaded configuration
+#include "dashboard.h" // For the multi-asset terminal layout
+#include "fetch.h" // For fetching prices
+#include "tracker.h" // For candles, recent ticks and the tick store
+#include "snapshot.h" // For warm restarts
+#include "query.h" // For --query and /query
+#include "backfill.h" // For fetching history at startup
+#include "placement.h" // For pinning threads to CPUs and NUMA nodes
 
 // Global flag to signal program exit
 // This flag is set to true when the user presses Ctrl+C
@@ -175,6 +51,7 @@ void signalHandler(int signum) {
 // Function to listen for 'q' keypress in a separate thread
 // This function runs in a loop, checking for user input, if 'q' or 'Q' is pressed, it sets the shouldExit flag to true
 void listenForExitKey() {
+    Placement::enter(Placement::Stage::Input);
     char input;
     while (!shouldExit) {
         std::cin >> input;
@@ -189,81 +66,417 @@ void listenForExitKey() {
     }
 }
 
-// Function to print an ASCII progress bar with percentage and time remaining
-void printProgressBar(int current, int total, int width, int line, int column) {
-    std::cout << "\033[" << line << ";" << column << "H"; // Position cursor
-    std::cout << Colors::YELLOW << "\033[K"; // Clear line
-    int filled = static_cast<int>(static_cast<double>(current) / total * width);
-    std::cout << "[";
-    for (int i = 0; i < width; ++i) {
-        std::cout << (i < filled ? "█" : "-");
+// Command-line options
+struct Options {
+    int metricsPort = 0; // 0 disables the /metrics endpoint
+    std::string metricsAddress = "127.0.0.1";
+    std::string recordPath; // Capture every API response to this file
+    std::string replayPath; // Serve API responses from this recording instead of CoinGecko
+    double replaySpeed = 1.0; // Time acceleration for replay mode
+    bool replayLoop = false; // Restart the recording when it runs out
+    long long ticks = 0; // Exit after this many updates (0 = run until 'q' or Ctrl+C)
+    std::string alertsPath; // JSON file with price alert rules
+    std::string configPath; // JSON settings file, reloaded when it changes
+    std::string snapshotPath; // State snapshot file for warm restarts
+    int backfillDays = 0; // Days of history to fetch at startup (0 = none)
+    std::string query; // Print the result of this query over the stored ticks and exit
+};
+
+// Function to print command-line usage
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --metrics-port <port>       Serve OpenMetrics on http://<address>:<port>/metrics\n"
+              << "  --metrics-address <addr>    Address for the metrics endpoint (default 127.0.0.1)\n"
+              << "  --record <file>             Record every API response to <file>\n"
+              << "  --replay <file>             Replay recorded responses from a local server instead of CoinGecko\n"
+              << "  --replay-speed <factor>     Replay faster than real time, e.g. 1000 (default 1)\n"
+              << "  --replay-loop               Start the recording over when it runs out\n"
+              << "  --ticks <n>                 Exit after <n> updates\n"
+              << "  --alerts <file>             Load price alert rules from a JSON file\n"
+              << "  --config <file>             Load settings from a JSON file and reload it on change\n"
+              << "  --snapshot <file>           Restore state from <file> at startup and save it periodically\n"
+              << "  --backfill <days>           Fetch <days> of price history for every asset at startup\n"
+              << "  --query <statement>         Run a query over the stored prices and exit, e.g.\n"
+              << "                              \"SELECT avg(price) FROM bitcoin LAST 7d GROUP BY 1h\"\n"
+              << "  --help                      Show this message\n";
+}
+
+// Function to parse command-line arguments; returns false if they are invalid
+bool parseArguments(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--metrics-port" && hasValue) {
+                options.metricsPort = std::stoi(argv[++i]);
+            } else if (arg == "--metrics-address" && hasValue) {
+                options.metricsAddress = argv[++i];
+            } else if (arg == "--record" && hasValue) {
+                options.recordPath = argv[++i];
+            } else if (arg == "--replay" && hasValue) {
+                options.replayPath = argv[++i];
+            } else if (arg == "--replay-speed" && hasValue) {
+                options.replaySpeed = std::stod(argv[++i]);
+            } else if (arg == "--replay-loop") {
+                options.replayLoop = true;
+            } else if (arg == "--ticks" && hasValue) {
+                options.ticks = std::stoll(argv[++i]);
+            } else if (arg == "--alerts" && hasValue) {
+                options.alertsPath = argv[++i];
+            } else if (arg == "--config" && hasValue) {
+                options.configPath = argv[++i];
+            } else if (arg == "--snapshot" && hasValue) {
+                options.snapshotPath = argv[++i];
+            } else if (arg == "--backfill" && hasValue) {
+                options.backfillDays = std::stoi(argv[++i]);
+            } else if (arg == "--query" && hasValue) {
+                options.query = argv[++i];
+            } else {
+                return false;
+            }
+        } catch (const std::exception&) {
+            return false; // Non-numeric value
+        }
     }
-    std::cout << "] " << std::fixed << std::setprecision(1) << (current * 100.0 / total) << "% ";
-    std::cout << "(" << (total - current) << "s remaining)" << Colors::RESET;
-    std::cout << std::flush; // Ensure immediate display
+    return options.metricsPort >= 0 && options.metricsPort <= 65535 && options.replaySpeed > 0.0 && options.ticks >= 0 && options.backfillDays >= 0;
 }
 
-int main() {
-        // Set console to UTF-8 encoding on Windows
-        #ifdef _WIN32
-            SetConsoleOutputCP(CP_UTF8);
-        #endif
+int main(int argc, char* argv[]) {
+        Options options;
+        if (!parseArguments(argc, argv, options)) {
+            printUsage(argv[0]);
+            return argc > 1 && std::string(argv[1]) == "--help" ? 0 : 1;
+        }
+
+        // Set the console to UTF-8 and enable ANSI escape codes for colored output on Windows
+        Dashboard::setupConsole();
+
+        // Load the settings before any thread starts; the watcher swaps in new snapshots later
+        Config::Settings initialSettings;
+        if (!options.configPath.empty()) {
+            std::string error;
+            if (!Config::loadSettings(options.configPath, initialSettings, error)) {
+                std::cerr << Colors::RED << "Error: " << error << Colors::RESET << std::endl;
+                return 1;
+            }
+        }
+        Config::ConfigStore configStore(std::move(initialSettings));
+        Placement::configure(configStore.current()->placement); // Every thread started from here on is placed
+
+        // Write errors to a JSON-lines log file in the background instead of interleaving them with the display
+        if (!Logging::start("btc-price-tracker.log")) {
+            std::cerr << Colors::YELLOW << "Warning: could not open btc-price-tracker.log, errors will not be logged" << Colors::RESET << std::endl;
+        }
+        Placement::enter(Placement::Stage::Main); // After the logger starts, so failures are logged
+
+        // Check the query before spending time on a backfill
+        Query::Statement queryStatement;
+        if (!options.query.empty()) {
+            std::string error;
+            if (!Query::parse(options.query, queryStatement, error)) {
+                std::cerr << Colors::RED << "Error: " << error << Colors::RESET << std::endl;
+                return 1;
+            }
+        }
 
-        // Enable ANSI escape codes for colored output
-        enableANSICodes();
+        // Point the fetcher at a local replay server, and/or record what it receives
+        Fetch::Settings fetchSettings;
+        Replay::Recorder recorder;
+        std::unique_ptr<Replay::ReplayServer> replayServer;
+        if (!options.replayPath.empty()) {
+            std::vector<Replay::Exchange> exchanges;
+            std::string error;
+            if (!Replay::loadRecording(options.replayPath, exchanges, error)) {
+                std::cerr << Colors::RED << "Error: " << error << Colors::RESET << std::endl;
+                return 1;
+            }
+            replayServer = std::make_unique<Replay::ReplayServer>(std::move(exchanges), options.replaySpeed, options.replayLoop);
+            if (!replayServer->start()) {
+                std::cerr << Colors::RED << "Error: could not start the replay server" << Colors::RESET << std::endl;
+                return 1;
+            }
+            fetchSettings.baseUrl = replayServer->baseUrl();
+            fetchSettings.speed = options.replaySpeed;
+        }
+        if (!options.recordPath.empty()) {
+            if (!recorder.open(options.recordPath)) {
+                std::cerr << Colors::RED << "Error: cannot write " << options.recordPath << Colors::RESET << std::endl;
+                return 1;
+            }
+            fetchSettings.recorder = &recorder;
+        }
+
+        // Prices are quoted in the configured currency (USD by default)
+        const std::string currencyCode = configStore.current()->currency; // Fixed until restart
+        const Pricing::CurrencySpec& currency = Pricing::currencySpec(currencyCode);
+
+        // Compile the alert rules and start the background action dispatcher
+        std::vector<Alerts::Rule> alertRules;
+        Alerts::SinkConfig alertSinks;
+        if (!options.alertsPath.empty()) {
+            std::string error;
+            if (!Alerts::loadRules(options.alertsPath, currency, alertRules, alertSinks, error)) {
+                std::cerr << Colors::RED << "Error: " << error << Colors::RESET << std::endl;
+                return 1;
+            }
+        }
+        Alerts::AlertDispatcher alertDispatcher;
+        alertDispatcher.start(alertRules, alertSinks);
+        Alerts::AlertEngine alertEngine(alertRules, alertDispatcher);
+
+        // Build 1s/1m/5m/1h/1d candles from every fetched price, keep recent ticks and the queryable history
+        Tracker::Engine engine(currencyCode, &alertEngine);
+        Fetch::PriceFetcher fetcher(fetchSettings);
+
+        // Warm start: map the last snapshot back so candles and alert windows are valid right away
+        Snapshot::Writer snapshotWriter;
+        if (!options.snapshotPath.empty()) {
+            const auto loadStart = std::chrono::steady_clock::now();
+            std::size_t restored = 0;
+            std::string error;
+            const bool loaded = Snapshot::load(options.snapshotPath, [&](const Snapshot::AssetState& saved) {
+                restored += engine.restore(saved) ? 1 : 0;
+            }, error);
+            if (loaded) {
+                const double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+                Logging::info("Warm start from snapshot", { { "path", options.snapshotPath }, { "assets", restored }, { "load_ms", loadMs } });
+            } else {
+                Logging::warning("Cold start", { { "error", error } });
+            }
+            if (!snapshotWriter.open(options.snapshotPath, error)) {
+                std::cerr << Colors::RED << "Error: " << error << Colors::RESET << std::endl;
+                return 1;
+            }
+        }
+        // Save every asset's state into the next snapshot slot
+        auto saveSnapshot = [&] {
+            if (!snapshotWriter.write(engine.snapshotViews())) {
+                Logging::error("Failed to write snapshot", { { "path", options.snapshotPath } });
+            }
+        };
+        auto lastSnapshot = std::chrono::steady_clock::now();
+
+        // Optionally expose fetch metrics for Prometheus scraping
+        httplib::Server metricsServer;
+        std::thread metricsThread;
+        if (options.metricsPort > 0) {
+            Fetch::metrics(); // Register the fetch metrics so they appear before the first fetch
+            Metrics::registry().callbackGauge("btc_log_dropped_records", "Log records dropped because a ring buffer was full",
+                                              [] { return static_cast<double>(Logging::droppedRecords()); });
+            metricsServer.Get("/metrics", [](const httplib::Request&, httplib::Response& res) {
+                res.set_content(Metrics::registry().render(), Metrics::CONTENT_TYPE);
+            });
+            // Ad-hoc queries over the tick store: /query?q=SELECT ...
+            metricsServer.Get("/query", [&engine](const httplib::Request& req, httplib::Response& res) {
+                Query::Result result;
+                std::string error;
+                if (!Query::run(req.get_param_value("q"), engine.ticks(), result, error)) {
+                    res.status = 400;
+                    res.set_content(nlohmann::json{ { "error", error } }.dump(), "application/json");
+                    return;
+                }
+                res.set_content(Query::renderJson(result), "application/json");
+            });
+            if (!metricsServer.bind_to_port(options.metricsAddress, options.metricsPort)) {
+                Logging::error("Failed to bind metrics endpoint", { { "address", options.metricsAddress }, { "port", options.metricsPort } });
+            } else {
+                metricsThread = std::thread([&metricsServer] {
+                    Placement::enter(Placement::Stage::Server); // Inherited by the server's worker threads
+                    metricsServer.listen_after_bind();
+                });
+            }
+        }
+
+        // Watch the settings file so edits apply on the next update
+        Config::ConfigWatcher configWatcher(options.configPath, configStore);
+        if (!options.configPath.empty()) {
+            configWatcher.start();
+        }
 
         // Set up Ctrl+C signal handler
         std::signal(SIGINT, signalHandler);
 
         // Start thread to listen for 'q' keypress
-        std::thread exitThread(listenForExitKey);
-
-        while (!shouldExit) {
-        
-            // Clear the console for a fresh display, using flush to ensure it works immediately
-            std::cout << Colors::CLEAR_SCREEN << std::flush;
-
-            // Print the title and border
-            printBorder("Bitcoin Price Tracker");
-            
-            // Print the current time
-            double price = getBitcoinPrice();
-            if (price >= 0.0) { // Check if the price is valid
-                std::ostringstream oss; // Create an output string stream for formatted output
-                oss << "$" << std::fixed << std::setprecision(2) << price; // Format the price to 2 decimal places
-                printFormattedLine("Bitcoin Price:", oss.str(), Colors::GREEN); // Print the price in green
+        // Runs limited by --ticks end on their own, so they do not wait on the keyboard
+        std::thread exitThread;
+        if (options.ticks == 0 && options.query.empty()) {
+            exitThread = std::thread(listenForExitKey);
+        }
+
+        // Fill the tick store with history before the first live update ('q' or Ctrl+C cancels)
+        if (options.backfillDays > 0) {
+            const std::shared_ptr<const Config::Settings> config = configStore.current();
+            Backfill::Settings backfill;
+            backfill.days = options.backfillDays;
+            backfill.chunkDays = config->backfillChunkDays;
+            backfill.connections = config->backfillConnections;
+            backfill.requestsPerMinute = config->backfillRequestsPerMinute * fetchSettings.speed;
+            backfill.maxRetries = config->maxRetries;
+            backfill.rateLimitDelaySeconds = config->rateLimitDelaySeconds;
+            backfill.connectionTimeoutSeconds = config->connectionTimeoutSeconds;
+            const std::string& baseUrl = fetchSettings.baseUrl.empty() ? config->endpoint : fetchSettings.baseUrl;
+            const Backfill::Result result = Backfill::run(baseUrl, config->assets, currencyCode, currency.scale, backfill, engine.ticks(),
+                [](std::size_t done, std::size_t total) {
+                    std::cout << "\r" << Colors::YELLOW << "Backfilling history: " << done << "/" << total << " requests" << Colors::RESET << std::flush;
+                    return !shouldExit;
+                });
+            std::cout << "\n" << (result.failedChunks > 0 ? Colors::RED : Colors::GREEN) << result.ticksAdded << " prices loaded in "
+                      << std::fixed << std::setprecision(1) << result.seconds << "s, " << result.failedChunks << " requests failed" << Colors::RESET << std::endl;
+        }
+
+        // One-shot query over the restored and backfilled prices instead of the dashboard
+        const bool queryOnly = !options.query.empty();
+        int queryStatus = 0;
+        if (queryOnly) {
+            Query::Result result;
+            std::string error;
+            const auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            if (Query::execute(queryStatement, engine.ticks(), nowMs, result, error)) {
+                std::cout << Query::renderText(result) << std::flush;
             } else {
-                printFormattedLine("Status:", "Unable to retrieve price.", Colors::RED); // Print error message in red
+                std::cerr << Colors::RED << "Error: " << error << Colors::RESET << std::endl;
+                queryStatus = 1;
             }
-            printFormattedLine("Last Updated:", getCurrentTimeFormatted(), Colors::CYAN); // Print the last updated time in cyan
+        }
 
-            printBorder("", 50); // Print a decorative border at the bottom
+        // Tile one panel per asset, sized to the terminal and repainted only where something changed
+        Dashboard::Screen screen("Bitcoin Price Tracker");
+        Dashboard::watchResize();
+        screen.setStatus(3, "", Colors::RESET);
+        screen.setStatus(4, "          (press 'q' then Enter or Ctrl+C to exit)", Colors::RESET);
+        screen.setStatus(5, "                        Thanks for using this tool", Colors::RESET);
+        screen.setStatus(6, "                                        By " + Colors::LIGHT_BLUE + "PHForge", Colors::RESET);
+        std::string frame; // Escape sequences of one repaint, written at once
 
-            // Message indicating the next update and my signature
-            std::cout << Colors::YELLOW << "Next update in 60 seconds... \n\n" << Colors::RESET;
-            std::cout << "\n";
-            std::cout << "\n";
-            std::cout << "          (press 'q' then Enter or Ctrl+C to exit)\n";
-            std::cout << "                        Thanks for using this tool\n";
-            std::cout << "                                        By " << Colors::LIGHT_BLUE << "PHForge" << Colors::RESET << "\n";
+        // The chart plots the first asset's candle closes at the finest resolution holding about one
+        // update per bar; a new resolution (poll interval reloaded) or first asset re-plots the saved bars
+        Candles::Resolution chartResolution = Candles::resolutionFor(configStore.current()->pollIntervalSeconds);
+        Symbols::Id chartAsset = Symbols::NONE;
+        auto plotChart = [&](const Config::Settings& config) {
+            const Symbols::Id asset = config.assetIds.empty() ? Symbols::NONE : config.assetIds.front();
+            const Candles::Resolution resolution = Candles::resolutionFor(config.pollIntervalSeconds);
+            const Tracker::AssetState* state = engine.find(asset);
+            if (!state) {
+                return;
+            }
+            if (resolution != chartResolution || asset != chartAsset) {
+                screen.clearChart();
+                chartResolution = resolution;
+                chartAsset = asset;
+                const auto& bars = state->history.bars(resolution);
+                for (auto bar = bars.size() > 256 ? bars.end() - 256 : bars.begin(); bar != bars.end(); ++bar) {
+                    screen.plotBar(bar->openTime, bar->close.toDouble());
+                }
+            }
+            if (const Candles::Candle* open = state->aggregator.current(resolution)) {
+                screen.plotBar(open->openTime, open->close.toDouble());
+            }
+        };
+
+        // Refill the sparklines from the restored ticks and the chart from the restored bars
+        screen.setAssets(configStore.current()->assets);
+        for (std::size_t i = 0; i < configStore.current()->assets.size(); ++i) {
+            const Tracker::AssetState* state = engine.find(configStore.current()->assetIds[i]);
+            if (!state) {
+                continue;
+            }
+            const auto& recent = state->recent;
+            for (auto tick = recent.size() > 256 ? recent.end() - 256 : recent.begin(); tick != recent.end(); ++tick) {
+                const Pricing::Price price{ tick->units, currency.scale };
+                screen.updatePanel(i, price, Pricing::displayPrice(price, currency));
+            }
+        }
+        plotChart(*configStore.current());
+
+        long long ticks = 0; // Number of updates so far
+        std::vector<Pricing::Price> prices; // Parallel to the snapshot's asset list
+        Arena::TickArena tickArena; // Scratch memory of one update, released when it ends
+        while (!shouldExit && !queryOnly) {
+            Arena::TickScope tickScope(tickArena);
+            // Use one configuration snapshot for the whole update, even if the file changes meanwhile
+            const std::shared_ptr<const Config::Settings> config = configStore.current();
+            screen.setAssets(config->assets);
 
-            // Update progress bar every second
-            const int waitTime = 60; // Total wait time in seconds
-            const int progressBarLine = 10; // Line where progress bar will be displayed 
+            // Fetch every configured asset in one request and update their panels
+            const bool fetched = fetcher.fetch(*config, currency, prices);
+            if (fetched) {
+                auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+                for (std::size_t i = 0; i < prices.size(); ++i) {
+                    if (!prices[i].valid()) {
+                        screen.markUnavailable(i);
+                        continue;
+                    }
+                    engine.ingest(config->assetIds[i], nowMs, prices[i]); // Candles, recent ticks, tick store and alert rules
+                    screen.updatePanel(i, prices[i], Pricing::displayPrice(prices[i], currency)); // Formatted as "$108,013.00" without allocating
+                }
+                plotChart(*config);
+                screen.setStatus(1, "", Colors::RESET);
+            } else {
+                screen.setStatus(1, Dashboard::formatLine("Status:", "Unable to retrieve prices."), Colors::RED); // Keep the last prices, report the error in red
+            }
+            screen.setStatus(0, Dashboard::formatLine("Last Updated:", TimeFormat::localUS().view()), Colors::CYAN); // Print the last updated time in cyan
+            // Message indicating the next update
+            Arena::String nextUpdate("Next update in ");
+            nextUpdate += std::to_string(config->pollIntervalSeconds);
+            nextUpdate += " seconds...";
+            screen.setStatus(2, nextUpdate, Colors::YELLOW);
+            frame.clear();
+            screen.render(frame);
+            std::cout << frame << std::flush;
+
+            // Periodic snapshot; the interval is shortened when replaying faster than real time
+            const auto now = std::chrono::steady_clock::now();
+            if (!options.snapshotPath.empty() && now - lastSnapshot >= std::chrono::duration<double>(config->snapshotIntervalSeconds / fetchSettings.speed)) {
+                saveSnapshot();
+                lastSnapshot = now;
+            }
+
+            // Stop once the requested number of updates has been displayed
+            if (options.ticks > 0 && ++ticks >= options.ticks) {
+                break;
+            }
+
+            // Update progress bar every second, picking up terminal resizes on the way
+            const int waitTime = config->pollIntervalSeconds; // Total wait time in seconds
             const int progressBarColumn = 0; // Column where progress bar will be displayed
             for (int i = 0; i < waitTime && !shouldExit; ++i) {
-                printProgressBar(i, waitTime, 20, progressBarLine, progressBarColumn);
-                std::this_thread::sleep_for(std::chrono::seconds(1));
+                frame.clear();
+                screen.render(frame);
+                Dashboard::progressBar(frame, i, waitTime, 20, screen.nextRow(), progressBarColumn);
+                std::cout << frame << std::flush;
+                // One second of wall time, shortened when replaying faster than real time
+                std::this_thread::sleep_for(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::duration<double>(1.0 / fetchSettings.speed)));
             }
             if (!shouldExit) {
-                printProgressBar(waitTime, waitTime, 20, progressBarLine, progressBarColumn); // Print final progress bar state
+                frame.clear();
+                Dashboard::progressBar(frame, waitTime, waitTime, 20, screen.nextRow(), progressBarColumn); // Print final progress bar state
+                std::cout << frame << std::flush;
             }
     }
 
+    // Save the open candles as they are, so a restart continues them
+    if (!options.snapshotPath.empty()) {
+        saveSnapshot();
+        snapshotWriter.close();
+    }
+
+    // Seal the candles that are still open so sinks see the last bars
+    engine.flush();
+    alertDispatcher.stop(); // Deliver pending alerts
+    configWatcher.stop();
+
     // Clean up: stop the exit thread and display exit message
     if (exitThread.joinable()) {
         exitThread.join();
     }
+    metricsServer.stop();
+    if (metricsThread.joinable()) {
+        metricsThread.join();
+    }
+    Logging::stop(); // Flush pending log records
+    if (queryOnly) {
+        return queryStatus; // Leave the result on screen
+    }
     std::cout << Colors::CLEAR_SCREEN << std::flush;
     std::cout << Colors::CYAN << "Exiting Bitcoin Price Tracker. Thank you for using this tool!" << Colors::RESET << "\n"; // Display exit message but may not be seen...
     return 0;
@@ -0,0 +1,206 @@
+/*
+ * Metrics instrumentation
+ * See metrics.h for an overview.
+ */
+
+#include "metrics.h"
+
+#include <bit> // For std::countl_zero
+#include <charconv> // For std::to_chars
+#include <vector> // For family grouping
+
+namespace Metrics {
+
+    namespace {
+
+        // Exported histogram boundaries: powers of two from ~1 us (2^10 ns) to ~69 s (2^36 ns)
+        constexpr int FIRST_EXPORTED_POWER = 10;
+        constexpr int LAST_EXPORTED_POWER = 36;
+
+        void appendNumber(std::string& out, double value) {
+            char digits[32];
+            const auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+            out.append(digits, end);
+        }
+
+        void appendNumber(std::string& out, std::uint64_t value) {
+            char digits[24];
+            const auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+            out.append(digits, end);
+        }
+
+        // name{labels,extra} with empty parts omitted
+        void appendSeries(std::string& out, const std::string& name, const char* suffix,
+                          const std::string& labels, const std::string& extra = "") {
+            out += name;
+            out += suffix;
+            if (!labels.empty() || !extra.empty()) {
+                out += '{';
+                out += labels;
+                if (!labels.empty() && !extra.empty()) {
+                    out += ',';
+                }
+                out += extra;
+                out += '}';
+            }
+            out += ' ';
+        }
+
+    } // namespace
+
+    std::size_t Histogram::bucketIndex(std::uint64_t nanoseconds) {
+        if (nanoseconds < SUB_BUCKETS) {
+            return static_cast<std::size_t>(nanoseconds);
+        }
+        const int exponent = 63 - std::countl_zero(nanoseconds); // >= 3
+        const std::uint64_t sub = (nanoseconds >> (exponent - 3)) & (SUB_BUCKETS - 1);
+        return static_cast<std::size_t>(exponent - 2) * SUB_BUCKETS + static_cast<std::size_t>(sub);
+    }
+
+    std::uint64_t Histogram::bucketLowerBound(std::size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        const std::size_t exponent = index / SUB_BUCKETS + 2;
+        const std::uint64_t sub = index % SUB_BUCKETS;
+        return (SUB_BUCKETS + sub) << (exponent - 3);
+    }
+
+    void Histogram::record(std::uint64_t nanoseconds) {
+        buckets_[bucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(nanoseconds, std::memory_order_relaxed);
+    }
+
+    std::uint64_t Histogram::quantile(double q) const {
+        const std::uint64_t total = count();
+        if (total == 0) {
+            return 0;
+        }
+        q = q < 0.0 ? 0.0 : (q > 1.0 ? 1.0 : q);
+        auto rank = static_cast<std::uint64_t>(q * static_cast<double>(total));
+        rank = rank == 0 ? 1 : rank;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < BUCKET_COUNT; ++i) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                return i + 1 < BUCKET_COUNT ? bucketLowerBound(i + 1) - 1 : UINT64_MAX;
+            }
+        }
+        return UINT64_MAX;
+    }
+
+    std::uint64_t Histogram::countBelow(std::uint64_t nanoseconds) const {
+        const std::size_t end = bucketIndex(nanoseconds);
+        std::uint64_t below = 0;
+        for (std::size_t i = 0; i < end; ++i) {
+            below += buckets_[i].load(std::memory_order_relaxed);
+        }
+        return below;
+    }
+
+    Registry::Entry& Registry::add(const std::string& name, const std::string& help, const std::string& labels, Kind kind) {
+        Entry& entry = entries_.emplace_back();
+        entry.name = name;
+        entry.help = help;
+        entry.labels = labels;
+        entry.kind = kind;
+        return entry;
+    }
+
+    Counter& Registry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry& entry = add(name, help, labels, Kind::Counter);
+        entry.counter = &counters_.emplace_back();
+        return *entry.counter;
+    }
+
+    Gauge& Registry::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry& entry = add(name, help, labels, Kind::Gauge);
+        entry.gauge = &gauges_.emplace_back();
+        return *entry.gauge;
+    }
+
+    Histogram& Registry::histogram(const std::string& name, const std::string& help, const std::string& labels) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry& entry = add(name, help, labels, Kind::Histogram);
+        entry.histogram = &histograms_.emplace_back();
+        return *entry.histogram;
+    }
+
+    void Registry::callbackGauge(const std::string& name, const std::string& help, std::function<double()> read,
+                                 const std::string& labels) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        add(name, help, labels, Kind::CallbackGauge).read = std::move(read);
+    }
+
+    std::string Registry::render() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string out;
+        out.reserve(4096);
+
+        // Emit families in registration order; each name gets one HELP/TYPE header
+        std::vector<bool> done(entries_.size(), false);
+        for (std::size_t first = 0; first < entries_.size(); ++first) {
+            if (done[first]) {
+                continue;
+            }
+            const Entry& head = entries_[first];
+            const char* type = head.kind == Kind::Counter ? "counter" : (head.kind == Kind::Histogram ? "histogram" : "gauge");
+            out += "# TYPE " + head.name + " " + type + "\n";
+            out += "# HELP " + head.name + " " + head.help + "\n";
+
+            for (std::size_t i = first; i < entries_.size(); ++i) {
+                const Entry& entry = entries_[i];
+                if (done[i] || entry.name != head.name) {
+                    continue;
+                }
+                done[i] = true;
+                switch (entry.kind) {
+                    case Kind::Counter:
+                        appendSeries(out, entry.name, "_total", entry.labels);
+                        appendNumber(out, entry.counter->value());
+                        out += '\n';
+                        break;
+                    case Kind::Gauge:
+                    case Kind::CallbackGauge:
+                        appendSeries(out, entry.name, "", entry.labels);
+                        appendNumber(out, entry.kind == Kind::Gauge ? entry.gauge->value() : entry.read());
+                        out += '\n';
+                        break;
+                    case Kind::Histogram: {
+                        const Histogram& histogram = *entry.histogram;
+                        const std::uint64_t count = histogram.count();
+                        for (int power = FIRST_EXPORTED_POWER; power <= LAST_EXPORTED_POWER; ++power) {
+                            std::string le = "le=\"";
+                            appendNumber(le, static_cast<double>(std::uint64_t{ 1 } << power) / 1e9);
+                            le += '"';
+                            appendSeries(out, entry.name, "_bucket", entry.labels, le);
+                            appendNumber(out, histogram.countBelow(std::uint64_t{ 1 } << power));
+                            out += '\n';
+                        }
+                        appendSeries(out, entry.name, "_bucket", entry.labels, "le=\"+Inf\"");
+                        appendNumber(out, count);
+                        out += '\n';
+                        appendSeries(out, entry.name, "_count", entry.labels);
+                        appendNumber(out, count);
+                        out += '\n';
+                        appendSeries(out, entry.name, "_sum", entry.labels);
+                        appendNumber(out, static_cast<double>(histogram.sum()) / 1e9);
+                        out += '\n';
+                        break;
+                    }
+                }
+            }
+        }
+        out += "# EOF\n";
+        return out;
+    }
+
+    Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+
+} // namespace Metrics
@@ -0,0 +1,122 @@
+/*
+ * Metrics instrumentation
+ * Lock-free counters, gauges and HDR-style latency histograms, rendered in the
+ * OpenMetrics text format so they can be scraped by Prometheus from /metrics.
+ */
+
+#pragma once
+
+#include <array> // For histogram buckets
+#include <atomic> // For lock-free updates
+#include <chrono> // For duration recording
+#include <cstddef> // For std::size_t
+#include <cstdint> // For fixed-width integers
+#include <deque> // For stable metric storage
+#include <functional> // For callback gauges
+#include <mutex> // For registration
+#include <string> // For names and rendered output
+
+namespace Metrics {
+
+    // Monotonically increasing count
+    class Counter {
+    public:
+        void increment(std::uint64_t amount = 1) { value_.fetch_add(amount, std::memory_order_relaxed); }
+        std::uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<std::uint64_t> value_{ 0 };
+    };
+
+    // Value that can go up and down
+    class Gauge {
+    public:
+        void set(double value) { value_.store(value, std::memory_order_relaxed); }
+        double value() const { return value_.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<double> value_{ 0.0 };
+    };
+
+    // Log-linear latency histogram in nanoseconds
+    // Every power of two is split into 8 linear sub-buckets, so any recorded value is
+    // known to within 12.5% while recording stays a single relaxed atomic increment
+    class Histogram {
+    public:
+        static constexpr std::size_t SUB_BUCKETS = 8;
+        static constexpr std::size_t BUCKET_COUNT = (64 - 2) * SUB_BUCKETS;
+
+        void record(std::uint64_t nanoseconds);
+
+        template <typename Rep, typename Period>
+        void record(std::chrono::duration<Rep, Period> duration) {
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+            record(static_cast<std::uint64_t>(ns > 0 ? ns : 0));
+        }
+
+        std::uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+        std::uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+
+        // Approximate value (upper edge of the containing bucket) at quantile q in [0, 1]
+        std::uint64_t quantile(double q) const;
+
+        // Number of recorded values strictly below `nanoseconds` (exact for powers of two)
+        std::uint64_t countBelow(std::uint64_t nanoseconds) const;
+
+        // Bucket helpers, exposed for exporters and tools
+        static std::size_t bucketIndex(std::uint64_t nanoseconds);
+        static std::uint64_t bucketLowerBound(std::size_t index);
+
+    private:
+        std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> buckets_{};
+        std::atomic<std::uint64_t> count_{ 0 };
+        std::atomic<std::uint64_t> sum_{ 0 };
+    };
+
+    // Named collection of metrics rendered together
+    // Metrics live as long as the registry and their addresses never change, so callers keep
+    // references and update them without any lookup. `labels` is a preformatted label set
+    // such as `phase="dns"`; metrics sharing a name form one family.
+    class Registry {
+    public:
+        Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+        Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+        Histogram& histogram(const std::string& name, const std::string& help, const std::string& labels = "");
+
+        // Gauge whose value is read from a callback at scrape time
+        void callbackGauge(const std::string& name, const std::string& help, std::function<double()> read,
+                           const std::string& labels = "");
+
+        // Render every metric in the OpenMetrics text exposition format, ending with "# EOF"
+        std::string render() const;
+
+    private:
+        enum class Kind { Counter, Gauge, Histogram, CallbackGauge };
+
+        struct Entry {
+            std::string name;
+            std::string help;
+            std::string labels;
+            Kind kind;
+            Counter* counter = nullptr;
+            Gauge* gauge = nullptr;
+            Histogram* histogram = nullptr;
+            std::function<double()> read;
+        };
+
+        Entry& add(const std::string& name, const std::string& help, const std::string& labels, Kind kind);
+
+        mutable std::mutex mutex_;
+        std::deque<Entry> entries_;
+        std::deque<Counter> counters_;
+        std::deque<Gauge> gauges_;
+        std::deque<Histogram> histograms_;
+    };
+
+    // Content-Type for the OpenMetrics text format
+    constexpr const char* CONTENT_TYPE = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+    // Process-wide registry used by the tracker
+    Registry& registry();
+
+} // namespace Metrics
@@ -0,0 +1,167 @@
+/*
+ * Thread placement
+ * See placement.h for an overview.
+ */
+
+#include "placement.h"
+
+#include <charconv> // For CPU numbers
+#include <fstream> // For the CPU lists of NUMA nodes
+
+#include "logger.h" // For placement failures
+
+#ifdef __linux__
+#include <cerrno> // For syscall errors
+#include <cstring> // For std::strerror
+#include <linux/mempolicy.h> // For MPOL_PREFERRED and MPOL_DEFAULT
+#include <pthread.h> // For affinity and thread names
+#include <sched.h> // For cpu_set_t
+#include <sys/syscall.h> // For SYS_set_mempolicy (no libnuma needed)
+#include <unistd.h> // For syscall()
+#endif
+
+namespace Placement {
+
+    namespace {
+
+        constexpr const char* STAGE_NAMES[STAGE_COUNT] = { "main", "backfill", "server", "replay", "logger", "alerts", "config", "input" };
+        constexpr int MAX_CPUS = 1024; // CPU_SETSIZE of glibc
+
+        Plan configuredPlan; // Written by configure() before any thread starts, read-only afterwards
+        bool pinning = false; // Whether any stage is placed
+
+#ifdef __linux__
+        cpu_set_t startupCpus; // Where the process could run before any pinning
+
+        // CPUs of a NUMA node, from sysfs
+        bool nodeCpus(int node, std::vector<int>& cpus, std::string& error) {
+            const std::string path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+            std::ifstream input(path);
+            std::string text;
+            if (!input || !std::getline(input, text)) {
+                error = "no NUMA node " + std::to_string(node);
+                return false;
+            }
+            return parseCpuList(text, cpus, error);
+        }
+
+        bool applyAffinity(const StagePlacement& placement, std::string& error) {
+            std::vector<int> cpus = placement.cpus;
+            if (cpus.empty() && placement.node >= 0 && !nodeCpus(placement.node, cpus, error)) {
+                return false;
+            }
+            cpu_set_t set = startupCpus;
+            if (!cpus.empty()) {
+                CPU_ZERO(&set);
+                for (int cpu : cpus) {
+                    CPU_SET(cpu, &set);
+                }
+            }
+            const int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+            if (result != 0) {
+                error = std::string("affinity: ") + std::strerror(result);
+                return false;
+            }
+            return true;
+        }
+
+        bool applyMemoryPolicy(const StagePlacement& placement, std::string& error) {
+            // Preferred rather than bound: allocations fall back to other nodes instead of failing
+            const unsigned long mask = placement.node >= 0 ? 1UL << placement.node : 0;
+            const long result = placement.node >= 0
+                ? ::syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, MAX_NODE + 2) // The kernel reads maxnode - 1 bits
+                : ::syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0);
+            if (result != 0) {
+                error = std::string("memory policy: ") + std::strerror(errno);
+                return false;
+            }
+            return true;
+        }
+#endif
+
+    } // namespace
+
+    const char* stageName(Stage stage) {
+        return STAGE_NAMES[static_cast<std::size_t>(stage)];
+    }
+
+    bool stageByName(std::string_view name, Stage& stage) {
+        for (std::size_t s = 0; s < STAGE_COUNT; ++s) {
+            if (name == STAGE_NAMES[s]) {
+                stage = static_cast<Stage>(s);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool parseCpuList(std::string_view text, std::vector<int>& cpus, std::string& error) {
+        cpus.clear();
+        while (!text.empty() && (text.back() == '\n' || text.back() == ' ')) {
+            text.remove_suffix(1);
+        }
+        while (!text.empty()) {
+            const std::size_t comma = text.find(',');
+            const std::string_view range = text.substr(0, comma);
+            text = comma == std::string_view::npos ? std::string_view() : text.substr(comma + 1);
+            const std::size_t dash = range.find('-');
+            const std::string_view first = range.substr(0, dash);
+            const std::string_view last = dash == std::string_view::npos ? first : range.substr(dash + 1);
+            int low = -1;
+            int high = -1;
+            const auto lowEnd = std::from_chars(first.data(), first.data() + first.size(), low);
+            const auto highEnd = std::from_chars(last.data(), last.data() + last.size(), high);
+            if (first.empty() || last.empty() || lowEnd.ptr != first.data() + first.size() || highEnd.ptr != last.data() + last.size()
+                || low < 0 || high < low || high >= MAX_CPUS) {
+                error = "invalid CPU list entry '" + std::string(range) + "'";
+                return false;
+            }
+            for (int cpu = low; cpu <= high; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        }
+        if (cpus.empty()) {
+            error = "empty CPU list";
+            return false;
+        }
+        return true;
+    }
+
+    void configure(const Plan& plan) {
+        configuredPlan = plan;
+        pinning = false;
+        for (const auto& placement : plan) {
+            pinning = pinning || !placement.cpus.empty() || placement.node >= 0;
+        }
+#ifdef __linux__
+        CPU_ZERO(&startupCpus);
+        if (sched_getaffinity(0, sizeof(startupCpus), &startupCpus) != 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                CPU_SET(cpu, &startupCpus);
+            }
+        }
+#endif
+    }
+
+    void enter(Stage stage) {
+#ifdef __linux__
+        // The main thread keeps the program name, which is what ps and pkill match
+        if (stage != Stage::Main) {
+            const std::string name = std::string("btc-") + stageName(stage);
+            pthread_setname_np(pthread_self(), name.c_str());
+        }
+        if (!pinning) {
+            return;
+        }
+        // Unplaced stages are reset too, since a new thread inherits its creator's placement
+        const StagePlacement& placement = configuredPlan[static_cast<std::size_t>(stage)];
+        std::string error;
+        if (!applyAffinity(placement, error) || !applyMemoryPolicy(placement, error)) {
+            Logging::warning("Thread placement failed", { { "stage", stageName(stage) }, { "error", error } });
+        }
+#else
+        (void)stage;
+#endif
+    }
+
+} // namespace Placement
@@ -0,0 +1,67 @@
+/*
+ * Thread placement
+ * Every thread of the tracker belongs to a stage (the update loop, backfill workers, the
+ * metrics server, the logger, ...). The "placement" settings pin a stage to a CPU list and/or
+ * a NUMA node: its threads get that affinity mask and, with a node, a preferred-node memory
+ * policy, so the pages they fault in (tick arena, response buffers, log rings, per-asset state)
+ * come from the node they run on. A node without a CPU list pins to the node's CPUs. Stages
+ * left out run wherever the process was allowed to at startup, even if their creator is pinned.
+ * Threads other than the main one are also named after their stage (e.g. "btc-backfill") for
+ * top, perf and /proc. Linux only; elsewhere threads are left as they are.
+ */
+
+#pragma once
+
+#include <array> // For per-stage settings
+#include <cstddef> // For std::size_t
+#include <cstdint> // For the stage enum
+#include <string> // For errors
+#include <string_view> // For stage names and CPU lists
+#include <vector> // For CPU lists
+
+namespace Placement {
+
+    enum class Stage : std::uint8_t {
+        Main, // Update loop: fetch, parse, analytics, render
+        Backfill, // History fetch and parse workers
+        Server, // Metrics and query HTTP server, with its worker pool
+        Replay, // Local server of --replay
+        Logger, // Log drain
+        Alerts, // Alert action dispatcher
+        Config, // Settings file watcher
+        Input, // Exit-key listener
+    };
+
+    constexpr std::size_t STAGE_COUNT = 8;
+
+    // Where one stage runs; empty cpus and node -1 leave it unpinned
+    struct StagePlacement {
+        std::vector<int> cpus;
+        int node = -1;
+
+        bool operator==(const StagePlacement&) const = default;
+    };
+
+    using Plan = std::array<StagePlacement, STAGE_COUNT>;
+
+    // Lowercase name of a stage as used in the settings file, e.g. "backfill"
+    const char* stageName(Stage stage);
+
+    // Stage called `name`; false if there is none
+    bool stageByName(std::string_view name, Stage& stage);
+
+    // Parse a CPU list such as "0-3,8,10-11" (the format of taskset -c and /sys); false and
+    // `error` on invalid input
+    bool parseCpuList(std::string_view text, std::vector<int>& cpus, std::string& error);
+
+    constexpr int MAX_NODE = 63; // Highest NUMA node a stage can be placed on
+
+    // Install the plan for threads entering a stage from now on, and remember the startup
+    // affinity for unpinned stages; call once, before any thread starts
+    void configure(const Plan& plan);
+
+    // Name the calling thread after `stage` and apply its placement; call first thing in a
+    // stage's thread (failures are logged, the thread keeps running where it is)
+    void enter(Stage stage);
+
+} // namespace Placement
@@ -0,0 +1,522 @@
+/*
+ * Fixed-point prices
+ * See price.h for an overview.
+ */
+
+#include "price.h"
+
+#include "json.h" // For the SAX parser used by extractSimplePrice
+#include <array> // For the currency table and power-of-ten table
+#include <bit> // For the byte order of the digit fast path
+#include <charconv> // For std::to_chars
+#include <cmath> // For std::llround
+#include <cstring> // For std::memcpy
+#include <limits> // For overflow checks
+#include <vector> // For multi-asset extraction
+
+#include "scan.h" // For the structural index
+
+namespace Pricing {
+
+    namespace {
+
+        // Powers of ten that fit into a signed 64-bit integer
+        constexpr std::array<std::int64_t, 19> POW10 = {
+            1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL,
+            1000000000LL, 10000000000LL, 100000000000LL, 1000000000000LL, 10000000000000LL,
+            100000000000000LL, 1000000000000000LL, 10000000000000000LL, 100000000000000000LL,
+            1000000000000000000LL
+        };
+
+        constexpr std::int64_t INT64_MAX_VALUE = std::numeric_limits<std::int64_t>::max();
+
+        // Fiat currencies are stored as micro-units and shown with cents, crypto quotes keep 8 digits
+        constexpr std::array<CurrencySpec, 10> CURRENCIES = {{
+            { "usd", "$", 6, 2 },
+            { "eur", "\xE2\x82\xAC", 6, 2 },
+            { "gbp", "\xC2\xA3", 6, 2 },
+            { "jpy", "\xC2\xA5", 6, 0 },
+            { "cad", "C$", 6, 2 },
+            { "aud", "A$", 6, 2 },
+            { "chf", "CHF ", 6, 2 },
+            { "btc", "\xE2\x82\xBF", 8, 8 },
+            { "eth", "\xCE\x9E", 8, 8 },
+            { "sats", "", 8, 0 },
+        }};
+
+        constexpr CurrencySpec GENERIC_CURRENCY = { "", "", 8, 8 };
+
+        // Multiply value by 10^exponent, returning false on overflow
+        bool scaleUp(std::int64_t& value, int exponent) {
+            for (; exponent > 0; --exponent) {
+                if (value > INT64_MAX_VALUE / 10) {
+                    return false;
+                }
+                value *= 10;
+            }
+            return true;
+        }
+
+        // Value of eight ASCII digits at once (SWAR); false if any of them is not a digit
+        bool eightDigits(const char* text, std::uint64_t& value) {
+            std::uint64_t chunk;
+            std::memcpy(&chunk, text, sizeof(chunk));
+            if constexpr (std::endian::native != std::endian::little) {
+                return false;
+            }
+            // Every byte must be 0x30..0x39: high nibble 3, and adding 6 must not carry out of the low nibble
+            if (((chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) != 0x3333333333333333ULL) {
+                return false;
+            }
+            chunk -= 0x3030303030303030ULL;
+            chunk = chunk * 10 + (chunk >> 8); // Pairs of digits
+            value = (((chunk & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+                     (((chunk >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+            return true;
+        }
+
+        // Accumulate a run of digits into `value`, eight at a time while they last; returns the run length
+        std::size_t digitRun(std::string_view text, std::size_t& pos, std::uint64_t& value) {
+            const std::size_t begin = pos;
+            std::uint64_t chunk = 0;
+            while (pos + 8 <= text.size() && eightDigits(text.data() + pos, chunk)) {
+                value = value * 100000000ULL + chunk;
+                pos += 8;
+            }
+            for (; pos < text.size() && text[pos] >= '0' && text[pos] <= '9'; ++pos) {
+                value = value * 10 + static_cast<std::uint64_t>(text[pos] - '0');
+            }
+            return pos - begin;
+        }
+
+        // Fast path of parsePrice() for the shape of nearly every API price: a plain decimal without
+        // exponent, with at most `scale` fraction digits and 18 significant digits (no rounding needed)
+        bool parsePlainDecimal(std::string_view text, std::uint8_t scale, Price& out) {
+            std::size_t pos = 0;
+            const bool negative = !text.empty() && text[0] == '-';
+            pos += negative ? 1 : 0;
+            std::uint64_t value = 0;
+            std::size_t digits = digitRun(text, pos, value);
+            std::size_t fractionDigits = 0;
+            if (pos < text.size() && text[pos] == '.') {
+                ++pos;
+                fractionDigits = digitRun(text, pos, value);
+                if (fractionDigits == 0) {
+                    return false;
+                }
+            }
+            digits += fractionDigits;
+            if (digits == 0 || digits > 18 || fractionDigits > scale || pos != text.size()) {
+                return false; // Overflowed or unusual inputs are left to the general parser
+            }
+            const auto multiplier = static_cast<std::uint64_t>(POW10[scale - fractionDigits]);
+            if (value > static_cast<std::uint64_t>(INT64_MAX_VALUE) / multiplier) {
+                return false;
+            }
+            const auto units = static_cast<std::int64_t>(value * multiplier);
+            out = { negative ? -units : units, scale };
+            return true;
+        }
+
+        // SAX handler that collects json[asset][currency] for a list of assets, parsing the raw number text
+        // Parsing stops as soon as every asset has been found or a structural error is seen
+        // Its keys and number texts are Arena::Json strings, taken from the tick arena during an update
+        class SimplePriceHandler : public nlohmann::json_sax<Arena::Json> {
+        public:
+            SimplePriceHandler(const Schema::KeySet& assets, std::string_view currency, std::uint8_t scale,
+                               std::vector<Price>& prices)
+                : assets_(assets), currency_(currency), scale_(scale), prices_(prices) {
+                prices_.assign(assets_.size(), Price{});
+            }
+
+            bool null() override { return value("null"); }
+            bool boolean(bool) override { return value("boolean"); }
+            bool number_integer(number_integer_t val) override {
+                if (!atTarget()) { return true; }
+                if (val < 0) {
+                    return store(false, 0, "negative price");
+                }
+                std::int64_t units = val;
+                return store(scaleUp(units, scale_), units, "price out of range");
+            }
+            bool number_unsigned(number_unsigned_t val) override {
+                if (!atTarget()) { return true; }
+                std::int64_t units = static_cast<std::int64_t>(val);
+                const bool ok = val <= static_cast<number_unsigned_t>(INT64_MAX_VALUE) && scaleUp(units, scale_);
+                return store(ok, units, "price out of range");
+            }
+            bool number_float(number_float_t, const string_t& text) override {
+                if (!atTarget()) { return true; }
+                Price parsed;
+                if (!parsePrice(text, scale_, parsed)) {
+                    return store(false, 0, "malformed price");
+                }
+                return store(parsed.valid(), parsed.units, "negative price"); // An invalid Price would not count as found
+            }
+            bool string(string_t&) override { return value("string"); }
+            bool binary(binary_t&) override { return value("binary"); }
+            bool start_object(std::size_t) override {
+                // Entering a requested asset's object arms the currency lookup
+                if (depth_ == 1 && keyMatches_) { inAsset_ = true; }
+                keyMatches_ = false;
+                ++depth_;
+                return true;
+            }
+            bool key(string_t& val) override {
+                if (depth_ == 1) {
+                    assetIndex_ = assets_.find(val); // Perfect-hash lookup and one comparison
+                    keyMatches_ = assetIndex_ != Schema::NOT_FOUND;
+                } else {
+                    keyMatches_ = depth_ == 2 && inAsset_ && val == currency_;
+                }
+                return true;
+            }
+            bool end_object() override {
+                --depth_;
+                if (depth_ == 1) { inAsset_ = false; }
+                keyMatches_ = false;
+                return true;
+            }
+            bool start_array(std::size_t) override { return value("array"); }
+            bool end_array() override { return true; }
+            bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+                error_ = "Failed to parse JSON response: ";
+                error_ += ex.what();
+                return false;
+            }
+
+            std::size_t found() const { return found_; }
+            const std::string& error() const { return error_; }
+
+        private:
+            bool atTarget() const { return depth_ == 2 && inAsset_ && keyMatches_; }
+
+            // Record the price of the current asset; keep parsing until every asset is known
+            bool store(bool ok, std::int64_t units, const char* problem) {
+                keyMatches_ = false;
+                if (!ok) {
+                    error_ = std::string(problem) + " for '" + assets_.keys()[assetIndex_] + "'";
+                    return false;
+                }
+                if (!prices_[assetIndex_].valid()) {
+                    ++found_;
+                }
+                prices_[assetIndex_] = { units, scale_ };
+                return found_ < assets_.size();
+            }
+
+            // Any non-number value at the target position is a structural error
+            bool value(const char* kind) {
+                if (atTarget()) {
+                    error_ = std::string("Invalid JSON structure (price is a ") + kind + ")";
+                    return false;
+                }
+                keyMatches_ = false;
+                return true;
+            }
+
+            const Schema::KeySet& assets_;
+            std::string_view currency_;
+            std::uint8_t scale_;
+            std::vector<Price>& prices_;
+            std::size_t assetIndex_ = 0;
+            int depth_ = 0;
+            bool inAsset_ = false;
+            bool keyMatches_ = false;
+            std::size_t found_ = 0;
+            std::string error_;
+        };
+
+        // Fast path over the structural index for {"asset":{"currency":number,...},...}
+        // Returns false whenever the SAX handler has to decide (malformed or unusual bodies, escaped
+        // keys, prices that are not plain non-negative numbers), and the caller parses the body again
+        bool scanSimplePrices(std::string_view body, const Schema::KeySet& assets, const CurrencySpec& currency,
+                              std::vector<Price>& prices, std::size_t& found) {
+            thread_local Scan::StructuralIndex index; // Keeps its capacity between bodies
+            if (!index.build(body)) {
+                return false;
+            }
+            Scan::Cursor cursor(body, index);
+            prices.assign(assets.size(), Price{});
+            found = 0;
+            if (!cursor.consume('{')) {
+                return false;
+            }
+            if (cursor.consume('}')) {
+                return cursor.done();
+            }
+            do {
+                std::string_view key;
+                if (!cursor.string(key) || !cursor.consume(':')) {
+                    return false;
+                }
+                const std::size_t asset = assets.find(key);
+                if (asset == Schema::NOT_FOUND || !cursor.consume('{')) {
+                    if (!cursor.skipValue()) {
+                        return false;
+                    }
+                    continue;
+                }
+                if (cursor.consume('}')) {
+                    continue;
+                }
+                do {
+                    std::string_view field;
+                    if (!cursor.string(field) || !cursor.consume(':')) {
+                        return false;
+                    }
+                    if (field != currency.code) {
+                        if (!cursor.skipValue()) {
+                            return false;
+                        }
+                        continue;
+                    }
+                    std::string_view text;
+                    Price price;
+                    if (!cursor.scalar(text) || text[0] == '-' || !Scan::isNumber(text) || !parsePrice(text, currency.scale, price)) {
+                        return false;
+                    }
+                    found += prices[asset].valid() ? 0 : 1;
+                    prices[asset] = price;
+                    if (found == assets.size()) {
+                        return true; // Like the SAX handler, stop once every asset is known
+                    }
+                } while (cursor.consume(','));
+                if (!cursor.consume('}')) {
+                    return false;
+                }
+            } while (cursor.consume(','));
+            return cursor.consume('}') && cursor.done();
+        }
+
+    } // namespace
+
+    const CurrencySpec& currencySpec(std::string_view code) {
+        for (const auto& spec : CURRENCIES) {
+            if (spec.code == code) {
+                return spec;
+            }
+        }
+        return GENERIC_CURRENCY;
+    }
+
+    double Price::toDouble() const {
+        return static_cast<double>(units) / static_cast<double>(POW10[scale < POW10.size() ? scale : 0]);
+    }
+
+    bool parsePrice(std::string_view text, std::uint8_t scale, Price& out) {
+        if (scale >= POW10.size()) {
+            return false;
+        }
+        if (parsePlainDecimal(text, scale, out)) {
+            return true;
+        }
+        std::size_t pos = 0;
+        bool negative = false;
+        if (pos < text.size() && (text[pos] == '-' || text[pos] == '+')) {
+            negative = text[pos] == '-';
+            ++pos;
+        }
+
+        // Locate the mantissa digits (with an optional '.') and the exponent
+        const std::size_t mantissaBegin = pos;
+        std::size_t digitCount = 0;
+        int fractionDigits = 0;
+        bool seenPoint = false;
+        for (; pos < text.size(); ++pos) {
+            const char c = text[pos];
+            if (c >= '0' && c <= '9') {
+                ++digitCount;
+                fractionDigits += seenPoint ? 1 : 0;
+            } else if (c == '.' && !seenPoint) {
+                seenPoint = true;
+            } else {
+                break;
+            }
+        }
+        const std::size_t mantissaEnd = pos;
+        if (digitCount == 0) {
+            return false;
+        }
+
+        int exponent = 0;
+        if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E')) {
+            ++pos;
+            bool negativeExponent = false;
+            if (pos < text.size() && (text[pos] == '-' || text[pos] == '+')) {
+                negativeExponent = text[pos] == '-';
+                ++pos;
+            }
+            const std::size_t exponentBegin = pos;
+            for (; pos < text.size() && text[pos] >= '0' && text[pos] <= '9'; ++pos) {
+                if (exponent < 10000) { // Anything larger over/underflows anyway
+                    exponent = exponent * 10 + (text[pos] - '0');
+                }
+            }
+            if (pos == exponentBegin) {
+                return false;
+            }
+            exponent = negativeExponent ? -exponent : exponent;
+        }
+        if (pos != text.size()) {
+            return false;
+        }
+
+        // units = round(mantissa * 10^(exponent - fractionDigits + scale))
+        // Keep the leading `keep` digits, use the next one for rounding
+        const long long shift = static_cast<long long>(exponent) - fractionDigits + scale;
+        const long long keep = static_cast<long long>(digitCount) + shift;
+        std::int64_t units = 0;
+        long long index = 0;
+        bool roundUp = false;
+        for (std::size_t i = mantissaBegin; i < mantissaEnd; ++i) {
+            if (text[i] == '.') {
+                continue;
+            }
+            const int digit = text[i] - '0';
+            if (index < keep) {
+                if (units > (INT64_MAX_VALUE - digit) / 10) {
+                    return false;
+                }
+                units = units * 10 + digit;
+            } else if (index == keep) {
+                roundUp = digit >= 5;
+                break;
+            }
+            ++index;
+        }
+        if (keep > static_cast<long long>(digitCount)) {
+            if (keep - static_cast<long long>(digitCount) > 18 && units != 0) {
+                return false;
+            }
+            if (!scaleUp(units, static_cast<int>(keep - static_cast<long long>(digitCount)))) {
+                return false;
+            }
+        }
+        if (roundUp) {
+            if (units == INT64_MAX_VALUE) {
+                return false;
+            }
+            ++units;
+        }
+        out = { negative ? -units : units, scale };
+        return true;
+    }
+
+    Price priceFromDouble(double value, std::uint8_t scale) {
+        if (scale >= POW10.size() || !std::isfinite(value)) {
+            return {};
+        }
+        const double scaled = value * static_cast<double>(POW10[scale]);
+        if (std::fabs(scaled) >= 9.2e18) {
+            return {};
+        }
+        return { std::llround(scaled), scale };
+    }
+
+    std::size_t formatPrice(char* out, std::size_t capacity, Price price, int decimals, char thousandsSeparator) {
+        if (decimals < 0 || decimals >= static_cast<int>(POW10.size()) || price.scale >= POW10.size()) {
+            return 0;
+        }
+        // Work on the magnitude as unsigned so INT64_MIN does not overflow
+        const bool negative = price.units < 0;
+        std::uint64_t magnitude = negative ? 0 - static_cast<std::uint64_t>(price.units) : static_cast<std::uint64_t>(price.units);
+
+        // Rescale to the requested number of decimals, rounding half away from zero
+        if (decimals < price.scale) {
+            const auto divisor = static_cast<std::uint64_t>(POW10[price.scale - decimals]);
+            magnitude = magnitude / divisor + (magnitude % divisor >= divisor / 2 ? 1 : 0);
+        } else {
+            for (int i = price.scale; i < decimals; ++i) {
+                if (magnitude > std::numeric_limits<std::uint64_t>::max() / 10) {
+                    return 0;
+                }
+                magnitude *= 10;
+            }
+        }
+        const auto unit = static_cast<std::uint64_t>(POW10[decimals]);
+        const std::uint64_t integerPart = magnitude / unit;
+        const std::uint64_t fractionPart = magnitude % unit;
+
+        char digits[24];
+        const auto integerEnd = std::to_chars(digits, digits + sizeof(digits), integerPart).ptr;
+        const auto integerLength = static_cast<std::size_t>(integerEnd - digits);
+        const std::size_t groups = thousandsSeparator != '\0' ? (integerLength - 1) / 3 : 0;
+        const std::size_t total = (negative ? 1 : 0) + integerLength + groups + (decimals > 0 ? 1 + decimals : 0);
+        if (total > capacity) {
+            return 0;
+        }
+
+        char* cursor = out;
+        if (negative) {
+            *cursor++ = '-';
+        }
+        for (std::size_t i = 0; i < integerLength; ++i) {
+            // Insert a separator before every group of three remaining digits
+            if (i > 0 && groups > 0 && (integerLength - i) % 3 == 0) {
+                *cursor++ = thousandsSeparator;
+            }
+            *cursor++ = digits[i];
+        }
+        if (decimals > 0) {
+            *cursor++ = '.';
+            char fraction[24];
+            const auto fractionEnd = std::to_chars(fraction, fraction + sizeof(fraction), fractionPart).ptr;
+            const auto fractionLength = static_cast<int>(fractionEnd - fraction);
+            for (int i = fractionLength; i < decimals; ++i) {
+                *cursor++ = '0'; // Left-pad the fractional digits
+            }
+            for (int i = 0; i < fractionLength; ++i) {
+                *cursor++ = fraction[i];
+            }
+        }
+        return static_cast<std::size_t>(cursor - out);
+    }
+
+    PriceText displayPrice(Price price, const CurrencySpec& currency) {
+        PriceText text;
+        const std::size_t symbolLength = currency.symbol.size() < 8 ? currency.symbol.size() : 8;
+        for (std::size_t i = 0; i < symbolLength; ++i) {
+            text.buffer[i] = currency.symbol[i];
+        }
+        const std::size_t written = formatPrice(text.buffer + symbolLength, MAX_PRICE_CHARS, price, currency.displayDecimals);
+        text.length = written > 0 ? symbolLength + written : 0;
+        return text;
+    }
+
+    ExtractResult extractSimplePrices(std::string_view body, const Schema::KeySet& assets, const CurrencySpec& currency,
+                                      std::vector<Price>& out, std::string& error) {
+        std::size_t found = 0;
+        // Without any price the body is an error; the SAX handler words it
+        if (!scanSimplePrices(body, assets, currency, out, found) || found == 0) {
+            SimplePriceHandler handler(assets, currency.code, currency.scale, out);
+            Arena::saxParse(body, &handler);
+            if (!handler.error().empty()) {
+                error = handler.error();
+                return ExtractResult::Malformed;
+            }
+            found = handler.found();
+        }
+        if (found == 0) {
+            error = "Invalid JSON structure (no requested asset with a '" + std::string(currency.code) + "' price)";
+            return ExtractResult::NoPrice;
+        }
+        return ExtractResult::Ok;
+    }
+
+    bool extractSimplePrice(std::string_view body, std::string_view asset, const CurrencySpec& currency,
+                            Price& out, std::string& error) {
+        const Schema::KeySet assets({ std::string(asset) });
+        std::vector<Price> prices;
+        const ExtractResult result = extractSimplePrices(body, assets, currency, prices, error);
+        if (result == ExtractResult::NoPrice) {
+            error = "Invalid JSON structure (missing '" + assets.keys()[0] + "' or '" + std::string(currency.code) + "' key)";
+        }
+        if (result != ExtractResult::Ok) {
+            return false;
+        }
+        out = prices[0];
+        return true;
+    }
+
+} // namespace Pricing
@@ -0,0 +1,91 @@
+/*
+ * Fixed-point prices
+ * Prices are kept as signed 64-bit integers of scaled units (for example micro-dollars)
+ * so they are parsed, compared and printed without binary floating-point rounding.
+ */
+
+#pragma once
+
+#include <compare> // For defaulted comparisons
+#include <cstddef> // For std::size_t
+#include <cstdint> // For fixed-width integers
+#include <string> // For the JSON key path
+#include <string_view> // For non-owning text
+#include <vector> // For multi-asset extraction
+
+#include "schema.h" // For the asset key set
+
+namespace Pricing {
+
+    // Per-currency representation settings
+    struct CurrencySpec {
+        std::string_view code; // Lowercase CoinGecko code, e.g. "usd"
+        std::string_view symbol; // Prefix used when displaying, e.g. "$"
+        std::uint8_t scale; // Number of stored decimal digits
+        std::uint8_t displayDecimals; // Number of decimal digits shown
+    };
+
+    // Look up the settings for a currency code; unknown codes get a generic 8-digit spec
+    const CurrencySpec& currencySpec(std::string_view code);
+
+    // A price as `units` / 10^scale
+    // Two prices only compare meaningfully when they share the same scale (same currency)
+    struct Price {
+        std::int64_t units = -1;
+        std::uint8_t scale = 0;
+
+        // Negative units mark an invalid (missing) price, like the old -1.0 sentinel
+        bool valid() const { return units >= 0; }
+
+        // Approximate floating-point value, for statistics only
+        double toDouble() const;
+
+        friend auto operator<=>(const Price&, const Price&) = default;
+    };
+
+    // Parse a JSON number (e.g. "108013.42", "1.2e-05", "42") into a price with `scale` decimals
+    // Extra fractional digits are rounded half away from zero. Returns false on malformed input or overflow.
+    bool parsePrice(std::string_view text, std::uint8_t scale, Price& out);
+
+    // Convert a double to a price, used when the source only provides a binary float
+    Price priceFromDouble(double value, std::uint8_t scale);
+
+    // Maximum number of characters formatPrice() may write
+    constexpr std::size_t MAX_PRICE_CHARS = 48;
+
+    // Format a price with `decimals` fractional digits and an optional thousands separator
+    // ('\0' disables grouping). Writes at most MAX_PRICE_CHARS characters without allocating or
+    // touching the locale, and returns the number of characters written (0 if `capacity` is too small).
+    std::size_t formatPrice(char* out, std::size_t capacity, Price price, int decimals, char thousandsSeparator = ',');
+
+    // Stack buffer holding a formatted price, convenient for printing
+    struct PriceText {
+        char buffer[MAX_PRICE_CHARS + 8];
+        std::size_t length = 0;
+        std::string_view view() const { return { buffer, length }; }
+    };
+
+    // Format a price for display with its currency symbol, e.g. "$108,013.42"
+    PriceText displayPrice(Price price, const CurrencySpec& currency);
+
+    // Extract the number at json[asset][currency] from a CoinGecko /simple/price body,
+    // reading the number text directly instead of going through a double
+    // Returns false and fills `error` when the body is malformed or the keys are missing
+    bool extractSimplePrice(std::string_view body, std::string_view asset, const CurrencySpec& currency,
+                            Price& out, std::string& error);
+
+    // Outcome of extractSimplePrices()
+    enum class ExtractResult : std::uint8_t {
+        Ok,
+        Malformed, // Invalid JSON, a price that is not a non-negative number, or one out of range
+        NoPrice, // Well-formed, but none of the assets has a price in the currency
+    };
+
+    // Extract json[asset][currency] for every asset in one pass; `out` is parallel to assets.keys() and
+    // holds an invalid Price for assets missing from the body. Asset keys are resolved through the
+    // set's perfect hash, so build it once per asset list rather than per body.
+    // Fills `error` unless the result is Ok
+    ExtractResult extractSimplePrices(std::string_view body, const Schema::KeySet& assets, const CurrencySpec& currency,
+                             std::vector<Price>& out, std::string& error);
+
+} // namespace Pricing
@@ -0,0 +1,664 @@
+/*
+ * Tick queries
+ * See query.h for the language and the execution model.
+ */
+
+#include "query.h"
+
+#include <algorithm> // For block search and min/max
+#include <cctype> // For case-insensitive keywords
+#include <charconv> // For numbers
+#include <chrono> // For timing and LAST
+
+#include "price.h" // For price literals and formatting
+#include "symbols.h" // For the queried asset id
+#include "timefmt.h" // For date literals, bucket starts and bucket times
+
+namespace Query {
+
+    namespace {
+
+        struct Token {
+            enum class Kind { Word, String, Symbol, End } kind = Kind::End;
+            std::string_view text;
+            std::size_t position = 0;
+        };
+
+        bool isWordChar(char c) {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-' || c == '.';
+        }
+
+        bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+            return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+                return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+            });
+        }
+
+        // Recursive-descent parser over a one-token lookahead
+        class Parser {
+        public:
+            explicit Parser(std::string_view text) : text_(text) { advance(); }
+
+            bool statement(Statement& out) {
+                if (!keyword("SELECT")) {
+                    return fail("expected SELECT");
+                }
+                do {
+                    if (!selectItem(out)) {
+                        return false;
+                    }
+                } while (symbol(","));
+                if (!keyword("FROM")) {
+                    return fail("expected FROM");
+                }
+                if (token_.kind != Token::Kind::Word && token_.kind != Token::Kind::String) {
+                    return fail("expected an asset id");
+                }
+                out.asset = std::string(token_.text);
+                advance();
+
+                // Optional clauses in any order, each at most once
+                bool where = false, last = false, group = false;
+                while (token_.kind != Token::Kind::End) {
+                    if (!where && keyword("WHERE")) {
+                        where = true;
+                        do {
+                            if (!condition(out)) {
+                                return false;
+                            }
+                        } while (keyword("AND"));
+                    } else if (!last && keyword("LAST")) {
+                        last = true;
+                        if (!duration(out.lastMs)) {
+                            return false;
+                        }
+                    } else if (!group && keyword("GROUP")) {
+                        group = true;
+                        if (!keyword("BY")) {
+                            return fail("expected BY");
+                        }
+                        if (!duration(out.bucketMs)) {
+                            return false;
+                        }
+                    } else {
+                        return fail("unexpected '" + std::string(token_.text) + "'");
+                    }
+                }
+                return true;
+            }
+
+            const std::string& error() const { return error_; }
+
+        private:
+            void advance() {
+                while (position_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[position_]))) {
+                    ++position_;
+                }
+                token_.position = position_;
+                if (position_ == text_.size()) {
+                    token_.kind = Token::Kind::End;
+                    token_.text = {};
+                    return;
+                }
+                const char c = text_[position_];
+                std::size_t end = position_ + 1;
+                if (isWordChar(c)) {
+                    while (end < text_.size() && isWordChar(text_[end])) {
+                        ++end;
+                    }
+                    token_.kind = Token::Kind::Word;
+                    token_.text = text_.substr(position_, end - position_);
+                } else if (c == '\'' || c == '"') {
+                    while (end < text_.size() && text_[end] != c) {
+                        ++end;
+                    }
+                    token_.kind = end < text_.size() ? Token::Kind::String : Token::Kind::Symbol; // Unterminated: reported as a stray quote
+                    token_.text = token_.kind == Token::Kind::String ? text_.substr(position_ + 1, end - position_ - 1) : text_.substr(position_, 1);
+                    end = token_.kind == Token::Kind::String ? end + 1 : position_ + 1;
+                } else {
+                    if ((c == '<' || c == '>') && end < text_.size() && text_[end] == '=') {
+                        ++end;
+                    }
+                    token_.kind = Token::Kind::Symbol;
+                    token_.text = text_.substr(position_, end - position_);
+                }
+                position_ = end;
+            }
+
+            bool keyword(std::string_view word) {
+                if (token_.kind == Token::Kind::Word && equalsIgnoreCase(token_.text, word)) {
+                    advance();
+                    return true;
+                }
+                return false;
+            }
+
+            bool symbol(std::string_view text) {
+                if (token_.kind == Token::Kind::Symbol && token_.text == text) {
+                    advance();
+                    return true;
+                }
+                return false;
+            }
+
+            bool fail(const std::string& message) {
+                error_ = message + " at position " + std::to_string(token_.position + 1);
+                return false;
+            }
+
+            // avg(price), min(price), ..., count(*)
+            bool selectItem(Statement& out) {
+                static constexpr Function FUNCTIONS[] = { Function::Avg, Function::Min, Function::Max, Function::Sum,
+                                                          Function::Count, Function::First, Function::Last };
+                for (Function function : FUNCTIONS) {
+                    const std::string_view name = functionName(function);
+                    if (!keyword(name.substr(0, name.find('(')))) {
+                        continue;
+                    }
+                    if (!symbol("(")) {
+                        return fail("expected '('");
+                    }
+                    if (!keyword("price") && !(function == Function::Count && symbol("*"))) {
+                        return fail(function == Function::Count ? "expected price or *" : "expected price");
+                    }
+                    if (!symbol(")")) {
+                        return fail("expected ')'");
+                    }
+                    out.functions.push_back(function);
+                    return true;
+                }
+                return fail("expected avg, min, max, sum, count, first or last");
+            }
+
+            // 7d, 1h, 30m, 15s, 2w
+            bool duration(std::int64_t& out) {
+                const std::string_view text = token_.text;
+                std::int64_t count = 0;
+                const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), count);
+                const std::size_t digits = static_cast<std::size_t>(end - text.data());
+                std::int64_t unit = 0;
+                if (token_.kind == Token::Kind::Word && ec == std::errc() && digits + 1 == text.size()) {
+                    switch (std::tolower(static_cast<unsigned char>(text.back()))) {
+                    case 's': unit = 1000; break;
+                    case 'm': unit = 60 * 1000; break;
+                    case 'h': unit = 3600 * 1000; break;
+                    case 'd': unit = 86400 * 1000; break;
+                    case 'w': unit = 7 * 86400 * 1000LL; break;
+                    }
+                }
+                if (unit == 0 || count <= 0 || count > std::numeric_limits<std::int64_t>::max() / unit) {
+                    return fail("expected a duration such as 30m, 1h or 7d");
+                }
+                out = count * unit;
+                advance();
+                return true;
+            }
+
+            // time <op> <literal> or price <op> <literal>
+            bool condition(Statement& out) {
+                const bool isTime = keyword("time");
+                if (!isTime && !keyword("price")) {
+                    return fail("expected time or price");
+                }
+                using Op = PriceCondition::Op;
+                Op op;
+                if (symbol("<")) {
+                    op = Op::Less;
+                } else if (symbol("<=")) {
+                    op = Op::LessEqual;
+                } else if (symbol(">")) {
+                    op = Op::Greater;
+                } else if (symbol(">=")) {
+                    op = Op::GreaterEqual;
+                } else if (symbol("=")) {
+                    op = Op::Equal;
+                } else {
+                    return fail("expected <, <=, >, >= or =");
+                }
+
+                if (!isTime) {
+                    Pricing::Price check;
+                    if ((token_.kind != Token::Kind::Word && token_.kind != Token::Kind::String) || !Pricing::parsePrice(token_.text, 0, check)) {
+                        return fail("expected a price");
+                    }
+                    out.prices.push_back({ op, std::string(token_.text) });
+                    advance();
+                    return true;
+                }
+
+                std::int64_t ms = 0;
+                if (!timeLiteral(ms)) {
+                    return fail("expected a date ('2025-01-31', '2025-01-31T12:00:00Z') or Unix milliseconds");
+                }
+                advance();
+                switch (op) {
+                case Op::Less: out.toMs = std::min(out.toMs, ms); break;
+                case Op::LessEqual: out.toMs = std::min(out.toMs, ms + 1); break;
+                case Op::Greater: out.fromMs = std::max(out.fromMs, ms + 1); break;
+                case Op::GreaterEqual: out.fromMs = std::max(out.fromMs, ms); break;
+                case Op::Equal:
+                    out.fromMs = std::max(out.fromMs, ms);
+                    out.toMs = std::min(out.toMs, ms + 1);
+                    break;
+                }
+                return true;
+            }
+
+            // Quoted UTC date "YYYY-MM-DD[ HH:MM[:SS]][Z]" (T or space between date and time), or bare Unix milliseconds
+            bool timeLiteral(std::int64_t& out) const {
+                const std::string_view text = token_.text;
+                if (token_.kind == Token::Kind::Word) {
+                    const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+                    return ec == std::errc() && end == text.data() + text.size();
+                }
+                if (token_.kind != Token::Kind::String) {
+                    return false;
+                }
+                auto field = [&](std::size_t offset, std::size_t length, int& value) {
+                    if (offset + length > text.size()) {
+                        return false;
+                    }
+                    const auto [end, ec] = std::from_chars(text.data() + offset, text.data() + offset + length, value);
+                    return ec == std::errc() && end == text.data() + offset + length;
+                };
+                int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+                if (!field(0, 4, year) || text.size() < 10 || text[4] != '-' || !field(5, 2, month) || text[7] != '-' || !field(8, 2, day) ||
+                    month < 1 || month > 12 || day < 1 || day > 31) {
+                    return false;
+                }
+                std::size_t length = 10;
+                if (text.size() > 10 && (text[10] == 'T' || text[10] == ' ')) {
+                    if (!field(11, 2, hour) || text.size() < 16 || text[13] != ':' || !field(14, 2, minute) || hour > 23 || minute > 59) {
+                        return false;
+                    }
+                    length = 16;
+                    if (text.size() > 16 && text[16] == ':') {
+                        if (!field(17, 2, second) || second > 59) {
+                            return false;
+                        }
+                        length = 19;
+                    }
+                }
+                if (text.size() == length + 1 && (text[length] == 'Z' || text[length] == 'z')) {
+                    ++length;
+                }
+                if (text.size() != length) {
+                    return false;
+                }
+                const std::int64_t days = TimeFormat::daysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+                out = ((days * 24 + hour) * 60 + minute) * 60000 + second * 1000LL;
+                return true;
+            }
+
+            std::string_view text_;
+            std::size_t position_ = 0;
+            Token token_;
+            std::string error_;
+        };
+
+        // Where a price literal lies against its value at `scale` as parsePrice rounds it (half away
+        // from zero): -1 below it, 0 exactly on it, 1 above it. `literal` must parse with parsePrice.
+        int literalSide(std::string_view literal, std::uint8_t scale) {
+            const bool negative = !literal.empty() && literal[0] == '-';
+            const std::size_t exponentAt = literal.find_first_of("eE");
+            long long exponent = 0;
+            if (exponentAt != std::string_view::npos) {
+                std::string_view text = literal.substr(exponentAt + 1);
+                if (!text.empty() && text[0] == '+') {
+                    text.remove_prefix(1);
+                }
+                std::from_chars(text.data(), text.data() + text.size(), exponent); // Huge exponents overflowed parsePrice already
+            }
+            const std::string_view mantissa = literal.substr(0, exponentAt);
+            const std::size_t begin = mantissa.find_first_of("0123456789");
+            const std::string_view integer = mantissa.substr(0, mantissa.find('.'));
+            // Decimal weight of the first mantissa digit, then of each following one
+            long long weight = exponent + static_cast<long long>(std::count_if(integer.begin(), integer.end(), [](char c) { return c >= '0' && c <= '9'; })) - 1;
+            int firstDropped = 0; // Digit at 10^-(scale + 1), which decided the rounding
+            bool dropped = false;
+            for (std::size_t i = begin; i < mantissa.size(); ++i) {
+                if (mantissa[i] == '.') {
+                    continue;
+                }
+                const int digit = mantissa[i] - '0';
+                if (weight == -static_cast<long long>(scale) - 1) {
+                    firstDropped = digit;
+                }
+                dropped |= weight < -static_cast<long long>(scale) && digit != 0;
+                --weight;
+            }
+            if (!dropped) {
+                return 0;
+            }
+            // Rounding away from zero moved a positive literal up (so it lies below) and a negative one down
+            return (firstDropped >= 5) != negative ? -1 : 1;
+        }
+
+        // Statement resolved against one series
+        struct Plan {
+            std::int64_t fromMs;
+            std::int64_t toMs;
+            std::int64_t minUnits = std::numeric_limits<std::int64_t>::min();
+            std::int64_t maxUnits = std::numeric_limits<std::int64_t>::max();
+            bool priceFilter = false;
+            std::int64_t bucketMs;
+            bool needSum = false;
+            bool needMinMax = false;
+        };
+
+        bool plan(const Statement& statement, std::uint8_t scale, std::int64_t nowMs, Plan& out, std::string& error) {
+            out.fromMs = statement.fromMs;
+            out.toMs = statement.toMs;
+            if (statement.lastMs > 0) {
+                out.fromMs = std::max(out.fromMs, nowMs - statement.lastMs);
+            }
+            for (const PriceCondition& condition : statement.prices) {
+                Pricing::Price price;
+                if (!Pricing::parsePrice(condition.literal, scale, price)) {
+                    error = "price " + condition.literal + " is out of range";
+                    return false;
+                }
+                // Compare against the literal itself: the grid values just below and above it
+                // (the same value when it has no more decimals than the scale)
+                const int side = literalSide(condition.literal, scale);
+                const std::int64_t floor = side < 0 ? price.units - 1 : price.units;
+                const std::int64_t ceil = side > 0 ? price.units + 1 : price.units;
+                using Op = PriceCondition::Op;
+                if (condition.op == Op::Less || condition.op == Op::LessEqual || condition.op == Op::Equal) {
+                    out.maxUnits = std::min(out.maxUnits, condition.op == Op::Less ? ceil - 1 : floor);
+                }
+                if (condition.op == Op::Greater || condition.op == Op::GreaterEqual || condition.op == Op::Equal) {
+                    out.minUnits = std::max(out.minUnits, condition.op == Op::Greater ? floor + 1 : ceil); // An inexact '=' leaves min > max
+                }
+                out.priceFilter = true;
+            }
+            out.bucketMs = statement.bucketMs;
+            for (Function function : statement.functions) {
+                out.needSum |= function == Function::Avg || function == Function::Sum;
+                out.needMinMax |= function == Function::Min || function == Function::Max;
+            }
+            return true;
+        }
+
+        // Fold a contiguous run of prices into a row; the loops have no branches on the data,
+        // so the compiler vectorizes them. `index` is the block's min/max when the run is the whole block.
+        void accumulate(const std::int64_t* units, std::size_t count, const Plan& plan, Row& row, const Ticks::Block* index) {
+            if (row.count == 0) {
+                row.first = units[0];
+            }
+            row.last = units[count - 1];
+            row.count += static_cast<std::int64_t>(count);
+            if (plan.needSum) {
+                // int64 holds ~9e7 ticks of a $100k price at 6 decimals per row
+                std::int64_t sum = 0;
+                for (std::size_t i = 0; i < count; ++i) {
+                    sum += units[i];
+                }
+                row.sum += sum;
+            }
+            if (plan.needMinMax) {
+                if (index) {
+                    row.min = std::min(row.min, index->minUnits);
+                    row.max = std::max(row.max, index->maxUnits);
+                    return;
+                }
+                std::int64_t min = row.min, max = row.max;
+                for (std::size_t i = 0; i < count; ++i) {
+                    min = std::min(min, units[i]);
+                    max = std::max(max, units[i]);
+                }
+                row.min = min;
+                row.max = max;
+            }
+        }
+
+        // Same as accumulate() for blocks that straddle a price condition
+        void accumulateFiltered(const std::int64_t* units, std::size_t count, const Plan& plan, Row& row) {
+            for (std::size_t i = 0; i < count; ++i) {
+                const std::int64_t value = units[i];
+                if (value < plan.minUnits || value > plan.maxUnits) {
+                    continue;
+                }
+                if (row.count == 0) {
+                    row.first = value;
+                }
+                row.last = value;
+                ++row.count;
+                row.sum += value;
+                row.min = std::min(row.min, value);
+                row.max = std::max(row.max, value);
+            }
+        }
+
+        // Floor division, so buckets before 1970 line up too
+        std::int64_t bucketStart(std::int64_t timestampMs, std::int64_t bucketMs) {
+            return TimeFormat::floorDiv(timestampMs, bucketMs) * bucketMs;
+        }
+
+        void scan(const Ticks::Series& series, const Plan& plan, Result& out) {
+            const auto& blocks = series.blocks();
+            out.stats.blocks = blocks.size();
+            const bool grouped = plan.bucketMs > 0;
+            if (!grouped) {
+                out.rows.emplace_back();
+            }
+            for (const Ticks::Block& block : blocks) {
+                // Prune on the block index before touching any column
+                if (block.maxTimestamp < plan.fromMs || block.minTimestamp >= plan.toMs || block.maxUnits < plan.minUnits || block.minUnits > plan.maxUnits) {
+                    ++out.stats.blocksPruned;
+                    continue;
+                }
+                const std::int64_t* timestamps = block.timestamps.data();
+                const std::int64_t* units = block.units.data();
+                const std::size_t size = block.size();
+                const std::size_t lo = block.minTimestamp >= plan.fromMs ? 0 : static_cast<std::size_t>(std::lower_bound(timestamps, timestamps + size, plan.fromMs) - timestamps);
+                const std::size_t hi = block.maxTimestamp < plan.toMs ? size : static_cast<std::size_t>(std::lower_bound(timestamps + lo, timestamps + size, plan.toMs) - timestamps);
+                const bool filtered = plan.priceFilter && (block.minUnits < plan.minUnits || block.maxUnits > plan.maxUnits);
+                out.stats.ticksScanned += hi - lo;
+
+                // Walk the range one bucket at a time; each bucket is a contiguous run of both columns
+                for (std::size_t i = lo; i < hi;) {
+                    std::size_t end = hi;
+                    if (grouped) {
+                        const std::int64_t start = bucketStart(timestamps[i], plan.bucketMs);
+                        end = static_cast<std::size_t>(std::lower_bound(timestamps + i, timestamps + hi, start + plan.bucketMs) - timestamps);
+                        if (out.rows.empty() || out.rows.back().bucketMs != start) {
+                            if (!out.rows.empty() && out.rows.back().count == 0) {
+                                out.rows.pop_back(); // Every tick of the previous bucket was filtered out
+                            }
+                            out.rows.emplace_back().bucketMs = start;
+                        }
+                    }
+                    Row& row = out.rows.back();
+                    if (filtered) {
+                        accumulateFiltered(units + i, end - i, plan, row);
+                    } else {
+                        accumulate(units + i, end - i, plan, row, i == 0 && end == size ? &block : nullptr);
+                    }
+                    i = end;
+                }
+            }
+            if (grouped && !out.rows.empty() && out.rows.back().count == 0) {
+                out.rows.pop_back();
+            }
+        }
+
+        // Value of one select item, or an empty view for aggregates over no ticks
+        std::string_view cell(const Row& row, Function function, std::uint8_t scale, char* buffer, std::size_t capacity) {
+            if (function == Function::Count) {
+                return { buffer, static_cast<std::size_t>(std::to_chars(buffer, buffer + capacity, row.count).ptr - buffer) };
+            }
+            if (row.count == 0) {
+                return {};
+            }
+            std::int64_t units = 0;
+            switch (function) {
+            case Function::Avg: {
+                // Rounded half away from zero, in fixed point
+                const std::int64_t quotient = row.sum / row.count;
+                const std::int64_t remainder = row.sum % row.count;
+                units = quotient + (2 * (remainder < 0 ? -remainder : remainder) >= row.count ? (row.sum < 0 ? -1 : 1) : 0);
+                break;
+            }
+            case Function::Min: units = row.min; break;
+            case Function::Max: units = row.max; break;
+            case Function::Sum: units = row.sum; break;
+            case Function::First: units = row.first; break;
+            case Function::Last: units = row.last; break;
+            case Function::Count: break;
+            }
+            return { buffer, Pricing::formatPrice(buffer, capacity, Pricing::Price{ units, scale }, scale, '\0') };
+        }
+
+        std::string_view bucketTime(std::int64_t ms, TimeFormat::TimeText& text) {
+            text = TimeFormat::iso8601Utc(std::chrono::system_clock::time_point(std::chrono::milliseconds(ms)));
+            return text.view();
+        }
+
+    } // namespace
+
+    std::string_view functionName(Function function) {
+        switch (function) {
+        case Function::Avg: return "avg(price)";
+        case Function::Min: return "min(price)";
+        case Function::Max: return "max(price)";
+        case Function::Sum: return "sum(price)";
+        case Function::Count: return "count(*)";
+        case Function::First: return "first(price)";
+        case Function::Last: return "last(price)";
+        }
+        return "";
+    }
+
+    bool parse(std::string_view text, Statement& out, std::string& error) {
+        Parser parser(text);
+        out = Statement{};
+        if (!parser.statement(out)) {
+            error = parser.error();
+            return false;
+        }
+        return true;
+    }
+
+    bool execute(const Statement& statement, const Ticks::TickStore& store, std::int64_t nowMs, Result& out, std::string& error) {
+        const auto started = std::chrono::steady_clock::now();
+        out = Result{};
+        out.functions = statement.functions;
+        out.grouped = statement.bucketMs > 0;
+        // The scan holds the read lock; live appends wait for it
+        const bool ok = store.read(Symbols::find(statement.asset), [&](const Ticks::Series* series) {
+            if (!series) {
+                error = "no stored prices for '" + statement.asset + "'";
+                return false;
+            }
+            Plan resolved;
+            if (!plan(statement, series->scale(), nowMs, resolved, error)) {
+                return false;
+            }
+            out.scale = series->scale();
+            scan(*series, resolved, out);
+            return true;
+        });
+        out.stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        return ok;
+    }
+
+    bool run(std::string_view text, const Ticks::TickStore& store, Result& out, std::string& error) {
+        Statement statement;
+        if (!parse(text, statement, error)) {
+            return false;
+        }
+        const auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        return execute(statement, store, nowMs, out, error);
+    }
+
+    std::string renderText(const Result& result) {
+        // Cells first, so every column can be padded to its widest value
+        std::vector<std::string> cells;
+        const std::size_t columns = result.functions.size() + (result.grouped ? 1 : 0);
+        if (result.grouped) {
+            cells.emplace_back("time");
+        }
+        for (Function function : result.functions) {
+            cells.emplace_back(functionName(function));
+        }
+        char buffer[Pricing::MAX_PRICE_CHARS];
+        TimeFormat::TimeText time;
+        for (const Row& row : result.rows) {
+            if (result.grouped) {
+                cells.emplace_back(bucketTime(row.bucketMs, time));
+            }
+            for (Function function : result.functions) {
+                const std::string_view value = cell(row, function, result.scale, buffer, sizeof(buffer));
+                cells.emplace_back(value.empty() ? std::string_view("-") : value);
+            }
+        }
+        std::vector<std::size_t> widths(columns, 0);
+        for (std::size_t i = 0; i < cells.size(); ++i) {
+            widths[i % columns] = std::max(widths[i % columns], cells[i].size());
+        }
+
+        std::string out;
+        for (std::size_t i = 0; i < cells.size(); ++i) {
+            const std::size_t column = i % columns;
+            out.append(column > 0 ? 2 : 0, ' ');
+            out.append(widths[column] - cells[i].size(), ' '); // Right-aligned, so decimal points line up
+            out += cells[i];
+            if (column + 1 == columns) {
+                out += '\n';
+            }
+            if (i + 1 == columns) {
+                std::size_t rule = 0;
+                for (std::size_t width : widths) {
+                    rule += width;
+                }
+                out.append(rule + 2 * (columns - 1), '-');
+                out += '\n';
+            }
+        }
+        char timing[32];
+        const auto timingEnd = std::to_chars(timing, timing + sizeof(timing), result.stats.milliseconds, std::chars_format::fixed, 2).ptr;
+        out += std::to_string(result.rows.size()) + (result.rows.size() == 1 ? " row" : " rows") + ", " + std::to_string(result.stats.ticksScanned) +
+               " ticks scanned, " + std::to_string(result.stats.blocksPruned) + "/" + std::to_string(result.stats.blocks) + " blocks pruned in " +
+               std::string(timing, timingEnd) + " ms\n";
+        return out;
+    }
+
+    std::string renderJson(const Result& result) {
+        std::string out = "{\"columns\":[";
+        if (result.grouped) {
+            out += "\"time\"";
+        }
+        for (std::size_t i = 0; i < result.functions.size(); ++i) {
+            out += i > 0 || result.grouped ? ",\"" : "\"";
+            out += functionName(result.functions[i]);
+            out += '"';
+        }
+        out += "],\"rows\":[";
+        char buffer[Pricing::MAX_PRICE_CHARS];
+        TimeFormat::TimeText time;
+        for (std::size_t r = 0; r < result.rows.size(); ++r) {
+            const Row& row = result.rows[r];
+            out += r > 0 ? ",[" : "[";
+            if (result.grouped) {
+                out += '"';
+                out += bucketTime(row.bucketMs, time);
+                out += '"';
+            }
+            for (std::size_t i = 0; i < result.functions.size(); ++i) {
+                if (i > 0 || result.grouped) {
+                    out += ',';
+                }
+                const std::string_view value = cell(row, result.functions[i], result.scale, buffer, sizeof(buffer));
+                out += value.empty() ? std::string_view("null") : value; // Exact decimal text, no binary rounding
+            }
+            out += ']';
+        }
+        char timing[32];
+        const auto timingEnd = std::to_chars(timing, timing + sizeof(timing), result.stats.milliseconds, std::chars_format::fixed, 3).ptr;
+        out += "],\"stats\":{\"blocks\":" + std::to_string(result.stats.blocks) + ",\"blocks_pruned\":" + std::to_string(result.stats.blocksPruned) +
+               ",\"ticks_scanned\":" + std::to_string(result.stats.ticksScanned) + ",\"ms\":" + std::string(timing, timingEnd) + "}}";
+        return out;
+    }
+
+} // namespace Query
@@ -0,0 +1,92 @@
+/*
+ * Tick queries
+ * A small query language over the tick store, e.g.
+ *
+ *     SELECT avg(price), max(price) FROM bitcoin LAST 7d GROUP BY 1h
+ *     SELECT count(*) FROM ethereum WHERE time >= '2025-01-01' AND price > 3000
+ *
+ * A statement is parsed once, planned against the series it reads (resolving relative
+ * times and converting price literals to fixed-point bounds at the series' scale, exact even
+ * for literals with more decimals than the scale) and executed
+ * block by block: blocks whose min/max timestamps or prices fall outside the filter are
+ * skipped without touching their columns, and the remaining ones are aggregated in tight
+ * loops over contiguous runs of the timestamp and price arrays.
+ */
+
+#pragma once
+
+#include <cstddef> // For std::size_t
+#include <cstdint> // For fixed-width integers
+#include <limits> // For open time ranges
+#include <string> // For asset ids and errors
+#include <string_view> // For the query text
+#include <vector> // For select lists and rows
+
+#include "tickstore.h" // For the data being queried
+
+namespace Query {
+
+    enum class Function { Avg, Min, Max, Sum, Count, First, Last };
+
+    // Column name of a select item, e.g. "avg(price)"
+    std::string_view functionName(Function function);
+
+    // Comparison against a price literal, kept as text until the series scale is known
+    struct PriceCondition {
+        enum class Op { Less, LessEqual, Greater, GreaterEqual, Equal } op;
+        std::string literal;
+    };
+
+    struct Statement {
+        std::vector<Function> functions;
+        std::string asset;
+        std::int64_t fromMs = std::numeric_limits<std::int64_t>::min(); // Inclusive
+        std::int64_t toMs = std::numeric_limits<std::int64_t>::max(); // Exclusive
+        std::int64_t lastMs = 0; // LAST <duration>, relative to the execution time (0 = none)
+        std::vector<PriceCondition> prices;
+        std::int64_t bucketMs = 0; // GROUP BY <duration> (0 = one row over everything)
+    };
+
+    // Parse a statement; returns false and fills `error` with the offending position
+    bool parse(std::string_view text, Statement& out, std::string& error);
+
+    // Running aggregate of one row; prices are fixed-point units at the result's scale
+    struct Row {
+        std::int64_t bucketMs = 0; // Start of the GROUP BY bucket
+        std::int64_t count = 0;
+        std::int64_t sum = 0;
+        std::int64_t min = std::numeric_limits<std::int64_t>::max();
+        std::int64_t max = std::numeric_limits<std::int64_t>::min();
+        std::int64_t first = 0;
+        std::int64_t last = 0;
+    };
+
+    struct Stats {
+        std::size_t blocks = 0; // Blocks in the series
+        std::size_t blocksPruned = 0; // Skipped through their min/max index
+        std::size_t ticksScanned = 0;
+        double milliseconds = 0.0;
+    };
+
+    struct Result {
+        std::vector<Function> functions;
+        bool grouped = false;
+        std::uint8_t scale = 0;
+        std::vector<Row> rows; // Sorted by bucket; empty buckets are left out
+        Stats stats;
+    };
+
+    // Run a parsed statement against the store at `nowMs` (for LAST)
+    // Returns false and fills `error` for unknown assets or price literals that do not parse
+    bool execute(const Statement& statement, const Ticks::TickStore& store, std::int64_t nowMs, Result& out, std::string& error);
+
+    // Parse and execute in one call, at the current time
+    bool run(std::string_view text, const Ticks::TickStore& store, Result& out, std::string& error);
+
+    // Aligned text table for the terminal
+    std::string renderText(const Result& result);
+
+    // {"columns":[...],"rows":[[...],...],"stats":{...}} for the /query endpoint
+    std::string renderJson(const Result& result);
+
+} // namespace Query
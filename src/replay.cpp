@@ -0,0 +1,224 @@
+/*
+ * Record and replay of upstream HTTP exchanges
+ * See replay.h for an overview and the file layout.
+ */
+
+#include "replay.h"
+
+#include <chrono> // For timing and scaled delays
+#include <cstring> // For std::memcpy
+#include <fstream> // For reading recordings
+#include <iterator> // For std::istreambuf_iterator
+
+#include "placement.h" // For the server thread's placement
+
+namespace Replay {
+
+    namespace {
+
+        constexpr char MAGIC[8] = { 'B', 'T', 'C', 'R', 'E', 'C', '0', '1' };
+
+        std::int64_t nowNs() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        template <typename T>
+        void put(std::string& out, T value) {
+            out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        template <typename Length>
+        void putText(std::string& out, const std::string& text) {
+            put(out, static_cast<Length>(text.size()));
+            out.append(text);
+        }
+
+        // Bounds-checked reader over a loaded recording
+        struct Reader {
+            const std::string& data;
+            std::size_t pos = 0;
+
+            template <typename T>
+            bool get(T& value) {
+                if (data.size() - pos < sizeof(T)) {
+                    return false;
+                }
+                std::memcpy(&value, data.data() + pos, sizeof(T));
+                pos += sizeof(T);
+                return true;
+            }
+
+            template <typename Length>
+            bool getText(std::string& text) {
+                Length length = 0;
+                if (!get(length) || data.size() - pos < length) {
+                    return false;
+                }
+                text.assign(data, pos, length);
+                pos += length;
+                return true;
+            }
+        };
+
+        // Headers that describe the original connection rather than the content
+        bool isHopByHop(const std::string& name) {
+            return httplib::detail::case_ignore::equal(name, "Content-Length")
+                || httplib::detail::case_ignore::equal(name, "Transfer-Encoding")
+                || httplib::detail::case_ignore::equal(name, "Connection")
+                || httplib::detail::case_ignore::equal(name, "Keep-Alive");
+        }
+
+    } // namespace
+
+    Recorder::~Recorder() = default;
+
+    bool Recorder::open(const std::string& path) {
+        if (!file_.open(path, true)) {
+            return false;
+        }
+        file_.append(MAGIC, sizeof(MAGIC));
+        startNs_ = nowNs();
+        return true;
+    }
+
+    std::int64_t Recorder::elapsedNs() const {
+        return nowNs() - startNs_;
+    }
+
+    void Recorder::append(const Exchange& exchange) {
+        std::string record;
+        record.reserve(64 + exchange.target.size() + exchange.body.size());
+        put(record, exchange.offsetNs);
+        put(record, exchange.durationUs);
+        put(record, static_cast<std::uint16_t>(exchange.status));
+        putText<std::uint16_t>(record, exchange.target);
+        put(record, static_cast<std::uint16_t>(exchange.headers.size()));
+        for (const auto& [name, value] : exchange.headers) {
+            putText<std::uint16_t>(record, name);
+            putText<std::uint32_t>(record, value);
+        }
+        putText<std::uint32_t>(record, exchange.body);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!file_.isOpen()) {
+            return;
+        }
+        const auto size = static_cast<std::uint32_t>(record.size());
+        file_.append(reinterpret_cast<const char*>(&size), sizeof(size));
+        file_.append(record.data(), record.size());
+        file_.flush();
+    }
+
+    bool loadRecording(const std::string& path, std::vector<Exchange>& exchanges, std::string& error) {
+        std::ifstream input(path, std::ios::binary);
+        if (!input) {
+            error = "cannot open " + path;
+            return false;
+        }
+        const std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        if (data.size() < sizeof(MAGIC) || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+            error = path + " is not a recording";
+            return false;
+        }
+
+        Reader reader{ data, sizeof(MAGIC) };
+        while (reader.pos < data.size()) {
+            std::uint32_t size = 0;
+            if (!reader.get(size) || data.size() - reader.pos < size) {
+                error = "truncated record at byte " + std::to_string(reader.pos);
+                return false;
+            }
+            const std::size_t end = reader.pos + size;
+            Exchange exchange;
+            std::uint16_t status = 0;
+            std::uint16_t headerCount = 0;
+            bool ok = reader.get(exchange.offsetNs) && reader.get(exchange.durationUs) && reader.get(status)
+                      && reader.getText<std::uint16_t>(exchange.target) && reader.get(headerCount);
+            for (std::uint16_t i = 0; ok && i < headerCount; ++i) {
+                std::string name;
+                std::string value;
+                ok = reader.getText<std::uint16_t>(name) && reader.getText<std::uint32_t>(value);
+                exchange.headers.emplace(std::move(name), std::move(value));
+            }
+            ok = ok && reader.getText<std::uint32_t>(exchange.body) && reader.pos == end;
+            if (!ok) {
+                error = "malformed record ending at byte " + std::to_string(end);
+                return false;
+            }
+            exchange.status = status;
+            exchanges.push_back(std::move(exchange));
+        }
+        return true;
+    }
+
+    ReplayServer::ReplayServer(std::vector<Exchange> exchanges, double speed, bool loop)
+        : exchanges_(std::move(exchanges)), speed_(speed > 0.0 ? speed : 1.0), loop_(loop) {
+        for (const Exchange& exchange : exchanges_) {
+            byTarget_[exchange.target].push_back(&exchange);
+        }
+        server_.Get(".*", [this](const httplib::Request& request, httplib::Response& response) { handle(request, response); });
+    }
+
+    ReplayServer::~ReplayServer() {
+        stop();
+    }
+
+    bool ReplayServer::start() {
+        port_ = server_.bind_to_any_port("127.0.0.1");
+        if (port_ <= 0) {
+            return false;
+        }
+        thread_ = std::thread([this] {
+            Placement::enter(Placement::Stage::Replay); // Inherited by the server's worker threads
+            server_.listen_after_bind();
+        });
+        server_.wait_until_ready();
+        return true;
+    }
+
+    void ReplayServer::stop() {
+        server_.stop();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    std::string ReplayServer::baseUrl() const {
+        return "http://127.0.0.1:" + std::to_string(port_);
+    }
+
+    void ReplayServer::handle(const httplib::Request& request, httplib::Response& response) {
+        const Exchange* exchange = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const auto found = byTarget_.find(request.target);
+            if (found == byTarget_.end()) {
+                response.status = 404;
+                return;
+            }
+            std::size_t& cursor = cursors_[request.target];
+            if (cursor == found->second.size()) {
+                if (!loop_) {
+                    response.status = 503;
+                    return;
+                }
+                cursor = 0;
+            }
+            exchange = found->second[cursor++];
+        }
+
+        // Reproduce the recorded latency, scaled by the replay speed
+        std::this_thread::sleep_for(std::chrono::duration<double, std::micro>(exchange->durationUs / speed_));
+        response.status = exchange->status;
+        for (const auto& [name, value] : exchange->headers) {
+            if (!isHopByHop(name) && !httplib::detail::case_ignore::equal(name, "Content-Type")) {
+                response.set_header(name, value);
+            }
+        }
+        const auto contentType = exchange->headers.find("Content-Type");
+        response.set_content(exchange->body, contentType != exchange->headers.end() ? contentType->second : "application/json");
+        ++served_;
+    }
+
+} // namespace Replay
@@ -0,0 +1,102 @@
+/*
+ * Record and replay of upstream HTTP exchanges
+ * A Recorder appends every response the tracker receives (status, headers, body and timing)
+ * to a compact binary file; a ReplayServer serves such a file back from a local
+ * httplib::Server, at the recorded pace or accelerated, so the whole tick pipeline can be
+ * benchmarked and soak-tested offline and deterministically.
+ */
+
+#pragma once
+
+#include <httplib.h> // For httplib::Headers and httplib::Server
+
+#include <atomic> // For the served-request counter
+#include <cstdint> // For fixed-width integers
+#include <map> // For per-target cursors
+#include <mutex> // For the replay cursors
+#include <string> // For paths and bodies
+#include <thread> // For the server thread
+#include <vector> // For loaded exchanges
+
+#include "files.h" // For the output file
+
+namespace Replay {
+
+    // One recorded request/response pair
+    struct Exchange {
+        std::int64_t offsetNs = 0; // Time since the recording started when the request was sent
+        std::uint32_t durationUs = 0; // Time from sending the request to receiving the full body
+        std::string target; // Request path including the query string
+        int status = 0;
+        httplib::Headers headers;
+        std::string body;
+    };
+
+    // Appends exchanges to a recording file
+    // Layout: the 8-byte magic "BTCREC01", then one record per exchange in host byte order:
+    // u32 record size, i64 offset ns, u32 duration us, u16 status, u16 target length + target,
+    // u16 header count + (u16 name length + name, u32 value length + value) each, u32 body length + body
+    class Recorder {
+    public:
+        Recorder() = default;
+        Recorder(const Recorder&) = delete;
+        Recorder& operator=(const Recorder&) = delete;
+        ~Recorder();
+
+        // Create (truncate) the recording file; returns false if it cannot be opened
+        bool open(const std::string& path);
+
+        bool isOpen() const { return file_.isOpen(); }
+
+        // Nanoseconds since open(), for Exchange::offsetNs
+        std::int64_t elapsedNs() const;
+
+        // Append and flush one exchange
+        void append(const Exchange& exchange);
+
+    private:
+        Files::Appender file_;
+        std::int64_t startNs_ = 0;
+        std::mutex mutex_;
+    };
+
+    // Load every exchange from a recording; returns false and fills `error` on failure
+    bool loadRecording(const std::string& path, std::vector<Exchange>& exchanges, std::string& error);
+
+    // Local HTTP server answering requests with recorded exchanges
+    // Requests are matched by target (path and query); each target replays its exchanges in
+    // recorded order, waiting the recorded duration divided by `speed` before answering.
+    // Unknown targets get 404; exhausted targets get 503 unless looping is enabled.
+    class ReplayServer {
+    public:
+        ReplayServer(std::vector<Exchange> exchanges, double speed, bool loop);
+        ~ReplayServer();
+
+        // Bind to an ephemeral port on 127.0.0.1 and start serving; returns false on failure
+        bool start();
+
+        // Stop serving and join the server thread
+        void stop();
+
+        // Base URL to point the HTTP client at, e.g. "http://127.0.0.1:41234"
+        std::string baseUrl() const;
+
+        // Number of requests answered so far
+        std::uint64_t served() const { return served_.load(); }
+
+    private:
+        void handle(const httplib::Request& request, httplib::Response& response);
+
+        std::map<std::string, std::vector<const Exchange*>> byTarget_;
+        std::map<std::string, std::size_t> cursors_;
+        std::vector<Exchange> exchanges_;
+        double speed_;
+        bool loop_;
+        int port_ = 0;
+        std::mutex mutex_;
+        std::atomic<std::uint64_t> served_{ 0 };
+        httplib::Server server_;
+        std::thread thread_;
+    };
+
+} // namespace Replay
@@ -0,0 +1,360 @@
+/*
+ * Structural JSON scanning
+ * See scan.h for an overview.
+ */
+
+#include "scan.h"
+
+#include <array> // For the character class table
+#include <bit> // For std::countr_zero
+#include <cstring> // For std::memcpy and std::memset
+#include <limits> // For the 4 GiB limit
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h> // For SSE2 and AVX2 compares
+#define BTC_SCAN_SSE2 1
+#if defined(__GNUC__) || defined(__clang__)
+#define BTC_SCAN_AVX2 1 // Compiled with a target attribute and chosen at run time
+#endif
+#endif
+
+namespace Scan {
+
+    namespace {
+
+        // One bit per byte of a 64-byte block
+        struct BlockMasks {
+            std::uint64_t quote = 0;
+            std::uint64_t backslash = 0;
+            std::uint64_t op = 0; // { } [ ] : ,
+            std::uint64_t whitespace = 0;
+        };
+
+        // Portable fallback for targets without SSE2 (and the reference the vector ones are checked against)
+        enum : std::uint8_t { QUOTE = 1, BACKSLASH = 2, OP = 4, WHITESPACE = 8 };
+
+        constexpr std::array<std::uint8_t, 256> CLASSES = [] {
+            std::array<std::uint8_t, 256> classes{};
+            classes['"'] = QUOTE;
+            classes['\\'] = BACKSLASH;
+            for (const unsigned char c : { '{', '}', '[', ']', ':', ',' }) {
+                classes[c] = OP;
+            }
+            for (const unsigned char c : { ' ', '\t', '\n', '\r' }) {
+                classes[c] = WHITESPACE;
+            }
+            return classes;
+        }();
+
+        BlockMasks classifyScalar(const char* block) {
+            BlockMasks masks;
+            for (int i = 0; i < 64; ++i) {
+                const std::uint8_t type = CLASSES[static_cast<unsigned char>(block[i])];
+                const std::uint64_t bit = std::uint64_t{ 1 } << i;
+                masks.quote |= (type & QUOTE) ? bit : 0;
+                masks.backslash |= (type & BACKSLASH) ? bit : 0;
+                masks.op |= (type & OP) ? bit : 0;
+                masks.whitespace |= (type & WHITESPACE) ? bit : 0;
+            }
+            return masks;
+        }
+
+#if BTC_SCAN_SSE2
+        // SSE2 is part of x86-64, so this one needs no CPU check
+        // '[' and ']' differ from '{' and '}' only in bit 0x20, so OR-ing it in folds four compares into two
+        BlockMasks classifySse2(const char* block) {
+            BlockMasks masks;
+            for (int part = 0; part < 4; ++part) {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * part));
+                const __m128i folded = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+                const __m128i op = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')), _mm_cmpeq_epi8(folded, _mm_set1_epi8('}'))),
+                                                _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(':')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8(','))));
+                const __m128i whitespace = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\t'))),
+                                                        _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\r'))));
+                const int shift = 16 * part;
+                masks.quote |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('"'))))) << shift;
+                masks.backslash |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\\'))))) << shift;
+                masks.op |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(op))) << shift;
+                masks.whitespace |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(whitespace))) << shift;
+            }
+            return masks;
+        }
+#endif
+
+#if BTC_SCAN_AVX2
+        __attribute__((target("avx2"))) BlockMasks classifyAvx2(const char* block) {
+            BlockMasks masks;
+            for (int part = 0; part < 2; ++part) {
+                const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32 * part));
+                const __m256i folded = _mm256_or_si256(bytes, _mm256_set1_epi8(0x20));
+                const __m256i op = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'))),
+                                                   _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(','))));
+                const __m256i whitespace = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\t'))),
+                                                           _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\r'))));
+                const int shift = 32 * part;
+                masks.quote |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('"'))))) << shift;
+                masks.backslash |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\\'))))) << shift;
+                masks.op |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(op))) << shift;
+                masks.whitespace |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(whitespace))) << shift;
+            }
+            return masks;
+        }
+#endif
+
+        struct Backend {
+            BlockMasks (*classify)(const char*);
+            const char* name;
+        };
+
+        Backend selectBackend() {
+#if BTC_SCAN_AVX2
+            if (__builtin_cpu_supports("avx2")) {
+                return { classifyAvx2, "avx2" };
+            }
+#endif
+#if BTC_SCAN_SSE2
+            return { classifySse2, "sse2" };
+#else
+            return { classifyScalar, "scalar" };
+#endif
+        }
+
+        const Backend& activeBackend() {
+            static const Backend backend = selectBackend();
+            return backend;
+        }
+
+        std::vector<Backend> availableBackends() {
+            std::vector<Backend> backends;
+#if BTC_SCAN_AVX2
+            if (__builtin_cpu_supports("avx2")) {
+                backends.push_back({ classifyAvx2, "avx2" });
+            }
+#endif
+#if BTC_SCAN_SSE2
+            backends.push_back({ classifySse2, "sse2" });
+#endif
+            backends.push_back({ classifyScalar, "scalar" });
+            return backends;
+        }
+
+        // Bit i of the result is the XOR of bits 0..i: 1 from an opening quote up to its closing quote
+        std::uint64_t prefixXor(std::uint64_t bits) {
+            bits ^= bits << 1;
+            bits ^= bits << 2;
+            bits ^= bits << 4;
+            bits ^= bits << 8;
+            bits ^= bits << 16;
+            bits ^= bits << 32;
+            return bits;
+        }
+
+        bool isSpace(char c) {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+
+        bool isDigit(char c) {
+            return c >= '0' && c <= '9';
+        }
+
+        // Index `json` into `positions` with one block classifier
+        bool buildIndex(std::string_view json, BlockMasks (*classify)(const char*), std::vector<std::uint32_t>& positions) {
+            positions.clear();
+            if (json.size() > std::numeric_limits<std::uint32_t>::max()) {
+                return false;
+            }
+            std::uint64_t inStringCarry = 0; // All ones when the previous block ended inside a string
+            std::uint64_t scalarCarry = 0; // 1 when the previous block ended inside a scalar
+            bool escapeCarry = false; // The previous block ended with an unescaped backslash
+            char tail[64];
+            for (std::size_t base = 0; base < json.size(); base += 64) {
+                const char* block = json.data() + base;
+                if (json.size() - base < 64) {
+                    std::memset(tail, ' ', sizeof(tail));
+                    std::memcpy(tail, block, json.size() - base);
+                    block = tail;
+                }
+                const BlockMasks masks = classify(block);
+
+                // Each unescaped backslash escapes the next character; backslashes are rare, so they are walked bit by bit
+                std::uint64_t escaped = 0;
+                if (masks.backslash != 0 || escapeCarry) {
+                    for (int i = 0; i < 64; ++i) {
+                        if (escapeCarry) {
+                            escaped |= std::uint64_t{ 1 } << i;
+                            escapeCarry = false;
+                        } else if ((masks.backslash >> i) & 1) {
+                            escapeCarry = true;
+                        }
+                    }
+                }
+                const std::uint64_t quotes = masks.quote & ~escaped;
+                const std::uint64_t inString = prefixXor(quotes) ^ inStringCarry; // Opening quotes and string interiors
+                inStringCarry = static_cast<std::uint64_t>(static_cast<std::int64_t>(inString) >> 63);
+
+                // A scalar starts where a run of non-structural, non-space characters outside strings starts
+                const std::uint64_t scalars = ~(masks.op | masks.whitespace | quotes) & ~inString;
+                const std::uint64_t scalarStarts = scalars & ~((scalars << 1) | scalarCarry);
+                scalarCarry = scalars >> 63;
+
+                std::uint64_t tokens = (masks.op & ~inString) | quotes | scalarStarts;
+                while (tokens != 0) {
+                    positions.push_back(static_cast<std::uint32_t>(base + static_cast<std::size_t>(std::countr_zero(tokens))));
+                    tokens &= tokens - 1;
+                }
+            }
+            return inStringCarry == 0;
+        }
+
+    } // namespace
+
+    const char* backend() {
+        return activeBackend().name;
+    }
+
+    std::vector<const char*> backends() {
+        std::vector<const char*> names;
+        for (const auto& backend : availableBackends()) {
+            names.push_back(backend.name);
+        }
+        return names;
+    }
+
+    bool isNumber(std::string_view text) {
+        std::size_t pos = 0;
+        if (pos < text.size() && text[pos] == '-') {
+            ++pos;
+        }
+        if (pos >= text.size() || !isDigit(text[pos])) {
+            return false;
+        }
+        if (text[pos++] != '0') {
+            while (pos < text.size() && isDigit(text[pos])) { ++pos; }
+        }
+        if (pos < text.size() && text[pos] == '.') {
+            const std::size_t digits = ++pos;
+            while (pos < text.size() && isDigit(text[pos])) { ++pos; }
+            if (pos == digits) {
+                return false;
+            }
+        }
+        if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E')) {
+            ++pos;
+            if (pos < text.size() && (text[pos] == '-' || text[pos] == '+')) {
+                ++pos;
+            }
+            const std::size_t digits = pos;
+            while (pos < text.size() && isDigit(text[pos])) { ++pos; }
+            if (pos == digits) {
+                return false;
+            }
+        }
+        return pos == text.size();
+    }
+
+    bool StructuralIndex::build(std::string_view json) {
+        return buildIndex(json, activeBackend().classify, positions_);
+    }
+
+    bool StructuralIndex::build(std::string_view json, std::string_view backend) {
+        for (const auto& candidate : availableBackends()) {
+            if (backend == candidate.name) {
+                return buildIndex(json, candidate.classify, positions_);
+            }
+        }
+        positions_.clear();
+        return false;
+    }
+
+    bool Cursor::string(std::string_view& out) {
+        if (peek() != '"' || next_ + 1 >= positions_.size()) {
+            return false;
+        }
+        // Nothing inside a string is indexed, so the next token is its closing quote
+        const std::size_t open = positions_[next_];
+        const std::size_t close = positions_[next_ + 1];
+        out = json_.substr(open + 1, close - open - 1);
+        if (out.find('\\') != std::string_view::npos) {
+            return false;
+        }
+        next_ += 2;
+        return true;
+    }
+
+    bool Cursor::scalar(std::string_view& out) {
+        switch (peek()) {
+        case '\0': case '"': case '{': case '}': case '[': case ']': case ':': case ',':
+            return false;
+        default:
+            break;
+        }
+        const std::size_t begin = positions_[next_];
+        std::size_t end = next_ + 1 < positions_.size() ? positions_[next_ + 1] : json_.size();
+        while (end > begin && isSpace(json_[end - 1])) {
+            --end;
+        }
+        out = json_.substr(begin, end - begin);
+        ++next_;
+        return true;
+    }
+
+    bool Cursor::skipKey() {
+        if (peek() != '"' || next_ + 1 >= positions_.size()) {
+            return false;
+        }
+        next_ += 2; // Escapes do not matter when the string is not read
+        return consume(':');
+    }
+
+    bool Cursor::skipValue() {
+        // Checks the grammar of what it skips (string contents aside), one bit per open container (1 = object)
+        std::uint64_t objects = 0;
+        int depth = 0;
+        for (;;) {
+            const char c = peek();
+            if (c == '{' || c == '[') {
+                ++next_;
+                if (!consume(c == '{' ? '}' : ']')) {
+                    if (depth == 64) {
+                        return false;
+                    }
+                    objects = (objects << 1) | (c == '{' ? 1 : 0);
+                    ++depth;
+                    if (c == '{' && !skipKey()) {
+                        return false;
+                    }
+                    continue; // At the first element
+                }
+            } else if (c == '"') {
+                if (next_ + 1 >= positions_.size()) {
+                    return false;
+                }
+                next_ += 2;
+            } else {
+                std::string_view text;
+                if (!scalar(text) || !(text == "true" || text == "false" || text == "null" || isNumber(text))) {
+                    return false;
+                }
+            }
+            // One value is complete: close the containers it ends, or step to the next element
+            for (;;) {
+                if (depth == 0) {
+                    return true;
+                }
+                const bool object = (objects & 1) != 0;
+                if (consume(',')) {
+                    if (object && !skipKey()) {
+                        return false;
+                    }
+                    break;
+                }
+                if (!consume(object ? '}' : ']')) {
+                    return false;
+                }
+                objects >>= 1;
+                --depth;
+            }
+        }
+    }
+
+} // namespace Scan
@@ -0,0 +1,85 @@
+/*
+ * Structural JSON scanning
+ * Stage one of a simdjson-style parser: the text is classified 64 bytes at a time (AVX2 or
+ * SSE2 compares where the CPU has them, a table otherwise) into bitmasks of quotes,
+ * backslashes, structural characters and whitespace. Escaped quotes and string interiors
+ * are masked out with carry-less bit tricks, and what remains is an index of positions:
+ * structural characters, both quotes of every string and the first character of every
+ * scalar. A Cursor walks that index, so extraction for a known schema jumps from token to
+ * token instead of inspecting every byte.
+ */
+
+#pragma once
+
+#include <cstddef> // For std::size_t
+#include <cstdint> // For positions
+#include <string_view> // For the scanned text
+#include <vector> // For the index
+
+namespace Scan {
+
+    // Name of the block classifier chosen for this CPU: "avx2", "sse2" or "scalar"
+    const char* backend();
+
+    // Names of every classifier this build and CPU can run, fastest first; "scalar" is always
+    // last, so its table is exercised on x86 too (see tests/scan_check.cpp)
+    std::vector<const char*> backends();
+
+    // Whether `text` is exactly one JSON number: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    bool isNumber(std::string_view text);
+
+    // Positions of the tokens of one JSON text, reused across texts to keep its capacity
+    class StructuralIndex {
+    public:
+        // Index `json`; returns false if it ends inside a string or is larger than 4 GiB
+        bool build(std::string_view json);
+
+        // Index `json` with the named classifier from backends(); false as above or if it is unavailable
+        bool build(std::string_view json, std::string_view backend);
+
+        const std::vector<std::uint32_t>& positions() const { return positions_; }
+
+    private:
+        std::vector<std::uint32_t> positions_;
+    };
+
+    // Token-by-token walk over an indexed text
+    // It checks the grammar of what it reads and skips, but not the contents of skipped strings;
+    // callers treat a false return as "use the full parser", which also words the error.
+    class Cursor {
+    public:
+        Cursor(std::string_view json, const StructuralIndex& index) : json_(json), positions_(index.positions()) {}
+
+        bool done() const { return next_ >= positions_.size(); }
+
+        // Character at the current token, or '\0' at the end
+        char peek() const { return done() ? '\0' : json_[positions_[next_]]; }
+
+        // Step over the current token if it is `c`
+        bool consume(char c) {
+            if (peek() != c) {
+                return false;
+            }
+            ++next_;
+            return true;
+        }
+
+        // Read a string without escape sequences; `out` views its characters between the quotes
+        bool string(std::string_view& out);
+
+        // Read a scalar (number, true, false or null); `out` views its text
+        bool scalar(std::string_view& out);
+
+        // Step over one value of any kind
+        bool skipValue();
+
+    private:
+        // Step over an object key and its colon
+        bool skipKey();
+
+        std::string_view json_;
+        const std::vector<std::uint32_t>& positions_;
+        std::size_t next_ = 0;
+    };
+
+} // namespace Scan
@@ -0,0 +1,29 @@
+/*
+ * Endpoint and response schemas
+ * See schema.h for an overview.
+ */
+
+#include "schema.h"
+
+#include <algorithm> // For std::max
+#include <utility> // For std::move
+
+namespace Schema {
+
+    KeySet::KeySet(std::vector<std::string> keys) : keys_(std::move(keys)) {
+        // One bucket per key on average, slots at most half full
+        const std::size_t buckets = std::bit_ceil(std::max<std::size_t>(keys_.size(), 1));
+        seeds_.resize(buckets);
+        slots_.resize(2 * buckets);
+        std::vector<std::uint32_t> hashes;
+        hashes.reserve(keys_.size());
+        for (const auto& key : keys_) {
+            hashes.push_back(hashKey(key));
+        }
+        if (!buildPerfectHash(hashes, seeds_, slots_)) {
+            seeds_.clear();
+            slots_.clear();
+        }
+    }
+
+} // namespace Schema
@@ -0,0 +1,292 @@
+/*
+ * Endpoint and response schemas
+ * Each API endpoint declares its path and query parameters as template arguments, and each
+ * parsed JSON object the names of the fields the tracker reads. The literal fragments of the
+ * URL builder and the field lookup tables are computed at compile time: a key is resolved by
+ * one hash pass into a perfect-hash table and a single comparison with the one name it can be,
+ * instead of a chain of string comparisons or a map lookup. Keys only known at run time (the
+ * configured asset ids) use the same tables in a KeySet, built once per asset list.
+ */
+
+#pragma once
+
+#include <array> // For compile-time tables
+#include <bit> // For std::bit_ceil
+#include <charconv> // For integer query values
+#include <concepts> // For std::integral
+#include <cstddef> // For std::size_t
+#include <cstdint> // For fixed-width integers
+#include <string> // For built targets and run-time keys
+#include <string_view> // For names and lookups
+#include <vector> // For run-time key sets and joined values
+
+namespace Schema {
+
+    constexpr std::size_t NOT_FOUND = static_cast<std::size_t>(-1);
+
+    // String literal usable as a template argument, e.g. Endpoint<"/api/v3/simple/price", "ids">
+    template <std::size_t N>
+    struct FixedString {
+        char text[N]{};
+
+        constexpr FixedString(const char (&literal)[N]) {
+            for (std::size_t i = 0; i < N; ++i) {
+                text[i] = literal[i];
+            }
+        }
+
+        constexpr std::string_view view() const { return { text, N - 1 }; }
+    };
+
+    // FNV-1a over the key; the bucket and the slot are both derived from this one pass
+    constexpr std::uint32_t hashKey(std::string_view key) {
+        std::uint32_t hash = 2166136261u;
+        for (const char c : key) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+        }
+        return hash;
+    }
+
+    // Re-mix a key hash with a bucket's seed into a slot hash
+    constexpr std::uint32_t displace(std::uint32_t hash, std::uint32_t seed) {
+        hash ^= seed * 0x9e3779b9u;
+        hash ^= hash >> 16;
+        hash *= 0x7feb352du;
+        hash ^= hash >> 15;
+        hash *= 0x846ca68bu;
+        hash ^= hash >> 16;
+        return hash;
+    }
+
+    // Hash-and-displace perfect hash over the hashKey() of each key: the hash picks a bucket, the
+    // bucket's seed places each of its keys in a distinct slot. `seeds` and `slots` sizes are powers
+    // of two; slots hold key index + 1. Returns false when two keys share a hash (duplicates).
+    template <typename Hashes, typename Seeds, typename Slots>
+    constexpr bool buildPerfectHash(const Hashes& hashes, Seeds& seeds, Slots& slots) {
+        constexpr std::uint32_t MAX_SEED = 1u << 16;
+        const std::size_t bucketMask = seeds.size() - 1;
+        const std::size_t slotMask = slots.size() - 1;
+        for (std::size_t i = 0; i < hashes.size(); ++i) {
+            for (std::size_t j = i + 1; j < hashes.size(); ++j) {
+                if (hashes[i] == hashes[j]) {
+                    return false; // No seed can separate them
+                }
+            }
+        }
+        Seeds members = seeds; // Keys per bucket
+        for (auto& count : members) { count = 0; }
+        for (const auto hash : hashes) { ++members[hash & bucketMask]; }
+        for (auto& seed : seeds) { seed = 0; } // Empty buckets keep seed 0; their lookups miss
+        for (auto& slot : slots) { slot = 0; }
+        // Place the fullest buckets first, while most slots are still free
+        for (std::size_t want = hashes.size(); want > 0; --want) {
+            for (std::size_t bucket = 0; bucket < seeds.size(); ++bucket) {
+                if (members[bucket] != want) {
+                    continue;
+                }
+                std::uint32_t seed = 1;
+                for (; seed < MAX_SEED; ++seed) {
+                    bool placed = true;
+                    for (std::size_t i = 0; i < hashes.size() && placed; ++i) {
+                        if ((hashes[i] & bucketMask) != bucket) {
+                            continue;
+                        }
+                        auto& slot = slots[displace(hashes[i], seed) & slotMask];
+                        placed = slot == 0;
+                        if (placed) {
+                            slot = static_cast<std::uint32_t>(i + 1);
+                        }
+                    }
+                    if (placed) {
+                        break;
+                    }
+                    for (auto& slot : slots) { // Undo this bucket's partial placement
+                        if (slot != 0 && (hashes[slot - 1] & bucketMask) == bucket) {
+                            slot = 0;
+                        }
+                    }
+                }
+                if (seed == MAX_SEED) {
+                    return false;
+                }
+                seeds[bucket] = seed;
+            }
+        }
+        return true;
+    }
+
+    // Index of `key` in a table built by buildPerfectHash(), or NOT_FOUND
+    template <typename Keys, typename Seeds, typename Slots>
+    constexpr std::size_t findPerfectHash(const Keys& keys, const Seeds& seeds, const Slots& slots, std::string_view key) {
+        const std::uint32_t hash = hashKey(key);
+        const std::uint32_t entry = slots[displace(hash, seeds[hash & (seeds.size() - 1)]) & (slots.size() - 1)];
+        return entry != 0 && keys[entry - 1] == key ? entry - 1 : NOT_FOUND;
+    }
+
+    // Names of the fields a parser reads from one JSON object, looked up in a compile-time perfect hash
+    template <FixedString... Names>
+    class Fields {
+        static constexpr std::size_t COUNT = sizeof...(Names);
+        static constexpr std::array<std::string_view, COUNT> NAMES = { Names.view()... };
+
+        struct Table {
+            std::array<std::uint32_t, std::bit_ceil(COUNT)> seeds{};
+            std::array<std::uint32_t, 2 * std::bit_ceil(COUNT)> slots{};
+            bool ok = false;
+        };
+
+        static constexpr Table TABLE = [] {
+            std::array<std::uint32_t, COUNT> hashes{};
+            for (std::size_t i = 0; i < COUNT; ++i) {
+                hashes[i] = hashKey(NAMES[i]);
+            }
+            Table table;
+            table.ok = buildPerfectHash(hashes, table.seeds, table.slots);
+            return table;
+        }();
+        static_assert(TABLE.ok, "field names must be distinct");
+
+    public:
+        static constexpr std::size_t count = COUNT;
+
+        // Position of `key` among Names, or NOT_FOUND
+        static constexpr std::size_t find(std::string_view key) { return findPerfectHash(NAMES, TABLE.seeds, TABLE.slots, key); }
+
+        // Position of a declared name, checked at compile time, e.g. Fields<"a", "b">::index<"b"> == 1
+        template <FixedString Name>
+        static constexpr std::size_t index = [] {
+            constexpr std::size_t position = findPerfectHash(NAMES, TABLE.seeds, TABLE.slots, Name.view());
+            static_assert(position != NOT_FOUND, "name is not a field of this schema");
+            return position;
+        }();
+    };
+
+    // Perfect-hash set of keys known only at run time, such as the configured asset ids
+    // Duplicate keys cannot be placed; the set then falls back to a linear search.
+    class KeySet {
+    public:
+        KeySet() = default;
+        explicit KeySet(std::vector<std::string> keys);
+
+        // Position of `key` in keys(), or NOT_FOUND
+        std::size_t find(std::string_view key) const {
+            if (!seeds_.empty()) {
+                return findPerfectHash(keys_, seeds_, slots_, key);
+            }
+            for (std::size_t i = 0; i < keys_.size(); ++i) {
+                if (keys_[i] == key) {
+                    return i;
+                }
+            }
+            return NOT_FOUND;
+        }
+
+        const std::vector<std::string>& keys() const { return keys_; }
+        std::size_t size() const { return keys_.size(); }
+
+    private:
+        std::vector<std::string> keys_;
+        std::vector<std::uint32_t> seeds_; // Empty when the keys could not be placed
+        std::vector<std::uint32_t> slots_;
+    };
+
+    // Query and path values: text, integers, or lists joined with commas (CoinGecko's "ids=a,b")
+    inline void appendValue(std::string& out, std::string_view value) {
+        out += value;
+    }
+
+    template <std::integral T>
+    void appendValue(std::string& out, T value) {
+        char text[24];
+        const auto end = std::to_chars(text, text + sizeof(text), value).ptr;
+        out.append(text, end);
+    }
+
+    inline void appendValue(std::string& out, const std::vector<std::string>& values) {
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            if (i > 0) {
+                out += ',';
+            }
+            out += values[i];
+        }
+    }
+
+    // An endpoint path, with "{}" standing for path segments, and its named query parameters
+    // target() takes one value per "{}" and then one per parameter, in declaration order; the
+    // literal text between the values is laid out at compile time.
+    template <FixedString Path, FixedString... Params>
+    class Endpoint {
+    public:
+        static constexpr std::size_t PATH_VALUES = [] {
+            const std::string_view path = Path.view();
+            std::size_t placeholders = 0;
+            for (std::size_t i = 0; i + 1 < path.size(); ++i) {
+                placeholders += path[i] == '{' && path[i + 1] == '}' ? 1 : 0;
+            }
+            return placeholders;
+        }();
+        static constexpr std::size_t VALUES = PATH_VALUES + sizeof...(Params);
+
+        // e.g. SimplePrice::target(assets, "usd") == "/api/v3/simple/price?ids=bitcoin,ethereum&vs_currencies=usd"
+        template <typename... Values>
+        static std::string target(const Values&... values) {
+            static_assert(sizeof...(Values) == VALUES, "pass one value per path placeholder and query parameter");
+            std::string out;
+            out.reserve(LAYOUT.length + 16 * VALUES);
+            std::size_t next = 0;
+            ((appendFragment(out, next++), appendValue(out, values)), ...);
+            appendFragment(out, VALUES);
+            return out;
+        }
+
+    private:
+        // The literal text with the placeholders removed and "?name=" / "&name=" inserted;
+        // fragment i runs from offsets[i] to offsets[i + 1] and is followed by value i
+        static constexpr std::size_t TEXT_SIZE = Path.view().size() - 2 * PATH_VALUES + (0 + ... + (Params.view().size() + 2));
+
+        struct Layout {
+            std::array<char, TEXT_SIZE + 1> text{};
+            std::array<std::size_t, VALUES + 2> offsets{};
+            std::size_t length = 0;
+        };
+
+        static constexpr Layout LAYOUT = [] {
+            Layout layout;
+            std::size_t fragment = 0;
+            auto put = [&layout](char c) { layout.text[layout.length++] = c; };
+            const std::string_view path = Path.view();
+            for (std::size_t i = 0; i < path.size(); ++i) {
+                if (path[i] == '{' && i + 1 < path.size() && path[i + 1] == '}') {
+                    layout.offsets[++fragment] = layout.length;
+                    ++i;
+                } else {
+                    put(path[i]);
+                }
+            }
+            const std::array<std::string_view, sizeof...(Params)> names = { Params.view()... };
+            for (std::size_t p = 0; p < names.size(); ++p) {
+                put(p == 0 ? '?' : '&');
+                for (const char c : names[p]) {
+                    put(c);
+                }
+                put('=');
+                layout.offsets[++fragment] = layout.length;
+            }
+            layout.offsets[++fragment] = layout.length;
+            return layout;
+        }();
+
+        static void appendFragment(std::string& out, std::size_t fragment) {
+            out.append(LAYOUT.text.data() + LAYOUT.offsets[fragment], LAYOUT.offsets[fragment + 1] - LAYOUT.offsets[fragment]);
+        }
+    };
+
+    // CoinGecko endpoints
+    using SimplePrice = Endpoint<"/api/v3/simple/price", "ids", "vs_currencies">;
+    using MarketChartRange = Endpoint<"/api/v3/coins/{}/market_chart/range", "vs_currency", "from", "to">;
+    using CoinsMarkets = Endpoint<"/api/v3/coins/markets", "vs_currency", "per_page", "page">;
+
+    // Top-level fields of a /market_chart/range response
+    using MarketChartFields = Fields<"prices", "market_caps", "total_volumes">;
+
+} // namespace Schema
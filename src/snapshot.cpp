@@ -0,0 +1,470 @@
+/*
+ * State snapshots
+ * See snapshot.h for an overview of the file layout and the write protocol.
+ */
+
+#include "snapshot.h"
+
+#include <algorithm> // For std::min
+#include <cstdio> // For writing the rebuilt file
+#include <cstring> // For std::memcpy and std::memcmp
+#include <filesystem> // For the atomic rename of a rebuilt file
+
+#ifdef _WIN32
+#include <io.h> // For _commit and _fileno
+#include <windows.h> // For file mappings
+#else
+#include <fcntl.h> // For open()
+#include <sys/mman.h> // For mmap() and msync()
+#include <sys/stat.h> // For fstat()
+#include <unistd.h> // For ftruncate(), fsync() and close()
+#endif
+
+namespace Snapshot {
+
+    namespace {
+
+        constexpr char MAGIC[8] = { 'B', 'T', 'C', 'S', 'N', 'A', 'P', '1' };
+        constexpr std::uint32_t VERSION = 1;
+        constexpr std::size_t PAGE = 4096; // Header size and slot alignment
+
+        // Where and what each slot holds; a slot is valid when its checksum matches
+        struct SlotDescriptor {
+            std::uint64_t sequence;
+            std::uint64_t length;
+            std::uint64_t checksum;
+        };
+
+        struct FileHeader {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t reserved;
+            std::uint64_t slotCapacity; // Bytes per slot, a multiple of PAGE
+            SlotDescriptor slots[2];
+        };
+
+        struct CandleRecord {
+            std::int64_t openTime;
+            std::int64_t open;
+            std::int64_t high;
+            std::int64_t low;
+            std::int64_t close;
+            std::uint32_t ticks;
+            std::uint32_t reserved;
+        };
+
+        // Followed by tickCount Tick records, then the sealed candles of each resolution
+        struct AssetRecord {
+            char asset[MAX_ASSET_LENGTH + 1];
+            char currency[MAX_CURRENCY_LENGTH + 1];
+            std::uint32_t tickCount;
+            std::uint32_t barCounts[Candles::RESOLUTION_COUNT];
+            std::uint8_t scale;
+            std::uint8_t openActive[Candles::RESOLUTION_COUNT];
+            std::uint8_t reserved[2];
+            CandleRecord open[Candles::RESOLUTION_COUNT];
+        };
+
+        struct SlotHeader {
+            std::uint32_t assetCount;
+            std::uint32_t reserved;
+        };
+
+        static_assert(sizeof(AssetRecord) % 8 == 0 && sizeof(CandleRecord) % 8 == 0 && sizeof(Tick) % 8 == 0,
+                      "records must keep the slot 8-byte aligned for the checksum");
+
+        // FNV-1a over 64-bit words; slot lengths are multiples of 8
+        std::uint64_t checksum(const unsigned char* data, std::size_t length) {
+            std::uint64_t hash = 0xcbf29ce484222325ull;
+            for (std::size_t i = 0; i + 8 <= length; i += 8) {
+                std::uint64_t word;
+                std::memcpy(&word, data + i, sizeof(word));
+                hash = (hash ^ word) * 0x100000001b3ull;
+            }
+            return hash;
+        }
+
+        std::size_t roundUp(std::size_t size) {
+            return (size + PAGE - 1) / PAGE * PAGE;
+        }
+
+        bool saved(const AssetView& view) {
+            return view.asset.size() <= MAX_ASSET_LENGTH && view.currency.size() <= MAX_CURRENCY_LENGTH && view.ticks && view.aggregator && view.history;
+        }
+
+        std::size_t tickCount(const AssetView& view) {
+            return std::min(view.ticks->size(), RECENT_TICKS);
+        }
+
+        std::size_t serializedSize(const std::vector<AssetView>& assets) {
+            std::size_t size = sizeof(SlotHeader);
+            for (const auto& view : assets) {
+                if (!saved(view)) {
+                    continue;
+                }
+                size += sizeof(AssetRecord) + tickCount(view) * sizeof(Tick);
+                for (std::size_t r = 0; r < Candles::RESOLUTION_COUNT; ++r) {
+                    size += view.history->bars(static_cast<Candles::Resolution>(r)).size() * sizeof(CandleRecord);
+                }
+            }
+            return size;
+        }
+
+        CandleRecord toRecord(const Candles::Candle& candle) {
+            return { candle.openTime, candle.open.units, candle.high.units, candle.low.units, candle.close.units, candle.ticks, 0 };
+        }
+
+        Candles::Candle fromRecord(const CandleRecord& record, std::uint8_t scale) {
+            return { record.openTime, { record.open, scale }, { record.high, scale }, { record.low, scale }, { record.close, scale }, record.ticks };
+        }
+
+        // Write the snapshot into `out`, which holds serializedSize(assets) bytes
+        void serialize(unsigned char* out, const std::vector<AssetView>& assets) {
+            SlotHeader slot{};
+            unsigned char* cursor = out + sizeof(SlotHeader);
+            for (const auto& view : assets) {
+                if (!saved(view)) {
+                    continue;
+                }
+                AssetRecord record{};
+                std::memcpy(record.asset, view.asset.data(), view.asset.size());
+                std::memcpy(record.currency, view.currency.data(), view.currency.size());
+                record.tickCount = static_cast<std::uint32_t>(tickCount(view));
+                record.scale = view.scale;
+                for (std::size_t r = 0; r < Candles::RESOLUTION_COUNT; ++r) {
+                    const auto resolution = static_cast<Candles::Resolution>(r);
+                    record.barCounts[r] = static_cast<std::uint32_t>(view.history->bars(resolution).size());
+                    if (const Candles::Candle* open = view.aggregator->current(resolution)) {
+                        record.openActive[r] = 1;
+                        record.open[r] = toRecord(*open);
+                    }
+                }
+                std::memcpy(cursor, &record, sizeof(record));
+                cursor += sizeof(record);
+                for (auto tick = view.ticks->end() - record.tickCount; tick != view.ticks->end(); ++tick) {
+                    std::memcpy(cursor, &*tick, sizeof(Tick));
+                    cursor += sizeof(Tick);
+                }
+                for (std::size_t r = 0; r < Candles::RESOLUTION_COUNT; ++r) {
+                    for (const auto& candle : view.history->bars(static_cast<Candles::Resolution>(r))) {
+                        const CandleRecord bar = toRecord(candle);
+                        std::memcpy(cursor, &bar, sizeof(bar));
+                        cursor += sizeof(bar);
+                    }
+                }
+                ++slot.assetCount;
+            }
+            std::memcpy(out, &slot, sizeof(slot));
+        }
+
+        // Hand the assets of a validated slot to `restore`; false if the records overrun it
+        bool deserialize(const unsigned char* data, std::size_t length, const RestoreFunction& restore) {
+            if (length < sizeof(SlotHeader)) {
+                return false;
+            }
+            SlotHeader slot;
+            std::memcpy(&slot, data, sizeof(slot));
+            std::size_t offset = sizeof(SlotHeader);
+            AssetState state; // Reused, so its buffers stay warm across assets
+            for (std::uint32_t a = 0; a < slot.assetCount; ++a) {
+                AssetRecord record;
+                if (length - offset < sizeof(record)) {
+                    return false;
+                }
+                std::memcpy(&record, data + offset, sizeof(record));
+                offset += sizeof(record);
+                std::size_t needed = static_cast<std::size_t>(record.tickCount) * sizeof(Tick);
+                for (std::uint32_t count : record.barCounts) {
+                    needed += static_cast<std::size_t>(count) * sizeof(CandleRecord);
+                }
+                if (length - offset < needed) {
+                    return false;
+                }
+                record.asset[MAX_ASSET_LENGTH] = '\0';
+                state.asset = record.asset;
+                record.currency[MAX_CURRENCY_LENGTH] = '\0';
+                state.currency = record.currency;
+                state.scale = record.scale;
+                state.ticks.resize(record.tickCount);
+                std::memcpy(state.ticks.data(), data + offset, record.tickCount * sizeof(Tick));
+                offset += record.tickCount * sizeof(Tick);
+                for (std::size_t r = 0; r < Candles::RESOLUTION_COUNT; ++r) {
+                    state.openActive[r] = record.openActive[r] != 0;
+                    state.open[r] = fromRecord(record.open[r], record.scale);
+                    auto& bars = state.bars[r];
+                    bars.resize(record.barCounts[r]);
+                    for (auto& candle : bars) {
+                        CandleRecord bar;
+                        std::memcpy(&bar, data + offset, sizeof(bar));
+                        offset += sizeof(bar);
+                        candle = fromRecord(bar, record.scale);
+                    }
+                }
+                restore(state);
+            }
+            return true;
+        }
+
+        // Index of the valid slot with the highest sequence, or -1
+        int newestSlot(const unsigned char* data, std::size_t size) {
+            if (size < PAGE) {
+                return -1;
+            }
+            FileHeader header;
+            std::memcpy(&header, data, sizeof(header));
+            if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+                header.slotCapacity == 0 || header.slotCapacity % PAGE != 0 || size < PAGE + 2 * header.slotCapacity) {
+                return -1;
+            }
+            // Check the newer slot first; the older one is only read if the newer one is torn
+            const int first = header.slots[1].sequence > header.slots[0].sequence ? 1 : 0;
+            for (int i : { first, 1 - first }) {
+                const SlotDescriptor& slot = header.slots[i];
+                if (slot.sequence != 0 && slot.length <= header.slotCapacity &&
+                    checksum(data + PAGE + i * header.slotCapacity, slot.length) == slot.checksum) {
+                    return i;
+                }
+            }
+            return -1;
+        }
+
+        FileHeader readHeader(const unsigned char* data) {
+            FileHeader header;
+            std::memcpy(&header, data, sizeof(header));
+            return header;
+        }
+
+        // Write a whole file and force it to disk before it replaces the snapshot
+        bool writeDurably(const std::string& path, const std::vector<unsigned char>& bytes) {
+            std::FILE* file = std::fopen(path.c_str(), "wb");
+            if (!file) {
+                return false;
+            }
+            bool ok = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size() && std::fflush(file) == 0;
+#ifdef _WIN32
+            ok = ok && _commit(_fileno(file)) == 0;
+#else
+            ok = ok && fsync(fileno(file)) == 0;
+#endif
+            return std::fclose(file) == 0 && ok;
+        }
+
+    } // namespace
+
+    bool MappedFile::open(const std::string& path, bool writable) {
+        close();
+        writable_ = writable;
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  writable ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER size;
+        GetFileSizeEx(file, &size);
+        file_ = file;
+        size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+        fd_ = ::open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+        if (fd_ < 0) {
+            return false;
+        }
+        struct stat info{};
+        fstat(fd_, &info);
+        size_ = static_cast<std::size_t>(info.st_size);
+#endif
+        if (!map()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    bool MappedFile::map() {
+        if (size_ == 0) {
+            return true; // Nothing to map yet
+        }
+#ifdef _WIN32
+        mapping_ = CreateFileMappingA(file_, nullptr, writable_ ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping_) {
+            return false;
+        }
+        data_ = static_cast<unsigned char*>(MapViewOfFile(mapping_, writable_ ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size_));
+        return data_ != nullptr;
+#else
+        int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+        if (!writable_) {
+            flags |= MAP_POPULATE; // Loads read everything once: fault the pages in up front
+        }
+#endif
+        void* data = mmap(nullptr, size_, writable_ ? PROT_READ | PROT_WRITE : PROT_READ, flags, fd_, 0);
+        if (data == MAP_FAILED) {
+            return false;
+        }
+        data_ = static_cast<unsigned char*>(data);
+        return true;
+#endif
+    }
+
+    void MappedFile::unmap() {
+#ifdef _WIN32
+        if (data_) {
+            UnmapViewOfFile(data_);
+        }
+        if (mapping_) {
+            CloseHandle(mapping_);
+            mapping_ = nullptr;
+        }
+#else
+        if (data_) {
+            munmap(data_, size_);
+        }
+#endif
+        data_ = nullptr;
+    }
+
+    bool MappedFile::resize(std::size_t length) {
+        unmap();
+#ifdef _WIN32
+        LARGE_INTEGER size;
+        size.QuadPart = static_cast<LONGLONG>(length);
+        if (!SetFilePointerEx(file_, size, nullptr, FILE_BEGIN) || !SetEndOfFile(file_)) {
+            return false;
+        }
+#else
+        if (ftruncate(fd_, static_cast<off_t>(length)) != 0) {
+            return false;
+        }
+#endif
+        size_ = length;
+        return map();
+    }
+
+    void MappedFile::flush(std::size_t offset, std::size_t length) {
+        if (!data_) {
+            return;
+        }
+#ifdef _WIN32
+        FlushViewOfFile(data_ + offset, length);
+        FlushFileBuffers(file_);
+#else
+        msync(data_ + offset, length, MS_SYNC); // offset is page-aligned
+#endif
+    }
+
+    void MappedFile::close() {
+        unmap();
+#ifdef _WIN32
+        if (file_) {
+            CloseHandle(file_);
+            file_ = nullptr;
+        }
+#else
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+#endif
+        size_ = 0;
+    }
+
+    bool load(const std::string& path, const RestoreFunction& restore, std::string& error) {
+        MappedFile file;
+        if (!file.open(path, false)) {
+            error = "cannot open snapshot " + path;
+            return false;
+        }
+        const int newest = newestSlot(file.data(), file.size());
+        if (newest < 0) {
+            error = "no valid snapshot in " + path;
+            return false;
+        }
+        const FileHeader header = readHeader(file.data());
+        if (!deserialize(file.data() + PAGE + newest * header.slotCapacity, header.slots[newest].length, restore)) {
+            error = "corrupt snapshot in " + path;
+            return false;
+        }
+        return true;
+    }
+
+    bool Writer::open(const std::string& path, std::string& error) {
+        path_ = path;
+        if (!file_.open(path, true)) {
+            error = "cannot write snapshot " + path;
+            return false;
+        }
+        newest_ = newestSlot(file_.data(), file_.size());
+        if (newest_ >= 0) {
+            sequence_ = readHeader(file_.data()).slots[newest_].sequence;
+            return true;
+        }
+        // New or unusable file: start over with small empty slots
+        if (!file_.resize(PAGE + 2 * PAGE)) {
+            error = "cannot write snapshot " + path;
+            return false;
+        }
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.slotCapacity = PAGE;
+        std::memcpy(file_.data(), &header, sizeof(header));
+        file_.flush(0, PAGE);
+        sequence_ = 0;
+        return true;
+    }
+
+    bool Writer::write(const std::vector<AssetView>& assets) {
+        if (!file_.data()) {
+            return false;
+        }
+        const std::size_t size = serializedSize(assets);
+        FileHeader header = readHeader(file_.data());
+        if (size > header.slotCapacity) {
+            return rebuild(assets, size);
+        }
+        // Fill and flush the other slot, then publish it in the header
+        const int slot = newest_ == 0 ? 1 : 0;
+        const std::size_t offset = PAGE + slot * header.slotCapacity;
+        serialize(file_.data() + offset, assets);
+        file_.flush(offset, roundUp(size));
+        header.slots[slot] = { sequence_ + 1, size, checksum(file_.data() + offset, size) };
+        std::memcpy(file_.data(), &header, sizeof(header));
+        file_.flush(0, PAGE);
+        ++sequence_;
+        newest_ = slot;
+        return true;
+    }
+
+    bool Writer::rebuild(const std::vector<AssetView>& assets, std::size_t size) {
+        // Slots cannot move in place without a window where neither is valid, so the
+        // larger file is written beside the old one and renamed over it
+        const std::size_t capacity = roundUp(size + size / 2); // Headroom for growing histories
+        std::vector<unsigned char> bytes(PAGE + 2 * capacity);
+        serialize(bytes.data() + PAGE, assets);
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.slotCapacity = capacity;
+        header.slots[0] = { sequence_ + 1, size, checksum(bytes.data() + PAGE, size) };
+        std::memcpy(bytes.data(), &header, sizeof(header));
+
+        const std::string temporary = path_ + ".tmp";
+        std::error_code ec;
+        if (!writeDurably(temporary, bytes)) {
+            std::filesystem::remove(temporary, ec);
+            return false;
+        }
+        file_.close();
+        std::filesystem::rename(temporary, path_, ec);
+        std::string error;
+        const bool reopened = open(path_, error); // The old file if the rename failed
+        return !ec && reopened;
+    }
+
+    void Writer::close() {
+        file_.close();
+        newest_ = -1;
+    }
+
+} // namespace Snapshot
@@ -0,0 +1,128 @@
+/*
+ * State snapshots
+ * Periodically saves the per-asset analytics state (open and sealed candles, recent
+ * ticks) to a double-buffered memory-mapped file, and maps it back at startup so candles,
+ * alert windows and charts are valid right away instead of starting empty.
+ *
+ * The file holds a header page and two slots. A snapshot is written into the slot that
+ * does not hold the newest valid snapshot, flushed, and only then published by writing
+ * that slot's sequence number and checksum into the header. A crash at any point leaves
+ * at least one slot whose checksum matches, and the loader picks the newest such slot.
+ */
+
+#pragma once
+
+#include <array> // For per-resolution state
+#include <cstddef> // For std::size_t
+#include <cstdint> // For fixed-width integers
+#include <deque> // For recent ticks
+#include <functional> // For the restore callback
+#include <string> // For paths and names
+#include <string_view> // For asset names
+#include <vector> // For asset lists
+
+#include "candles.h" // For candle state
+#include "tickstore.h" // For the tick type
+
+namespace Snapshot {
+
+    // Recent ticks kept per asset, enough to refill charts and alert windows
+    constexpr std::size_t RECENT_TICKS = 1024;
+
+    // Asset ids and currency codes are stored in fixed-size fields; longer ones are not saved
+    constexpr std::size_t MAX_ASSET_LENGTH = 63;
+    constexpr std::size_t MAX_CURRENCY_LENGTH = 7;
+
+    using Tick = Ticks::Tick;
+
+    // Live state of one asset to save; the pointers must stay valid during write()
+    struct AssetView {
+        std::string_view asset;
+        std::string_view currency; // vs_currency the prices are quoted in
+        std::uint8_t scale = 0;
+        const std::deque<Tick>* ticks = nullptr; // Oldest first, at most RECENT_TICKS are saved
+        const Candles::CandleAggregator* aggregator = nullptr;
+        const Candles::CandleHistory* history = nullptr;
+    };
+
+    // State of one asset as loaded
+    struct AssetState {
+        std::string asset;
+        std::string currency;
+        std::uint8_t scale = 0;
+        std::vector<Tick> ticks; // Oldest first
+        std::array<std::vector<Candles::Candle>, Candles::RESOLUTION_COUNT> bars; // Sealed, oldest first
+        std::array<Candles::Candle, Candles::RESOLUTION_COUNT> open{}; // Candles still open when saved
+        std::array<bool, Candles::RESOLUTION_COUNT> openActive{};
+    };
+
+    // Whole-file memory mapping (mmap, or a file mapping on Windows)
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile() { close(); }
+
+        // Map an existing file, or create it when `writable`; an empty file maps to no data
+        bool open(const std::string& path, bool writable);
+
+        // Change the file length and map it again (writable files only)
+        bool resize(std::size_t length);
+
+        // Write a mapped range back to disk
+        void flush(std::size_t offset, std::size_t length);
+
+        void close();
+
+        unsigned char* data() const { return data_; }
+        std::size_t size() const { return size_; }
+
+    private:
+        bool map();
+        void unmap();
+
+        unsigned char* data_ = nullptr;
+        std::size_t size_ = 0;
+        bool writable_ = false;
+#ifdef _WIN32
+        void* file_ = nullptr;
+        void* mapping_ = nullptr;
+#else
+        int fd_ = -1;
+#endif
+    };
+
+    // Called once per saved asset; the state is reused for the next asset, so copy what is kept
+    using RestoreFunction = std::function<void(const AssetState&)>;
+
+    // Map a snapshot file and hand every asset of the newest valid snapshot to `restore`
+    // Returns false and fills `error` if the file is missing or holds no valid snapshot
+    bool load(const std::string& path, const RestoreFunction& restore, std::string& error);
+
+    // Writes snapshots into the two slots of a file in turn
+    class Writer {
+    public:
+        Writer() = default;
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        // Open or create the file, keeping any valid snapshot it already holds
+        bool open(const std::string& path, std::string& error);
+
+        // Save one snapshot; returns false if it could not be written
+        // The previous snapshot stays valid until this one is complete
+        bool write(const std::vector<AssetView>& assets);
+
+        void close();
+
+    private:
+        bool rebuild(const std::vector<AssetView>& assets, std::size_t size);
+
+        std::string path_;
+        MappedFile file_;
+        std::uint64_t sequence_ = 0; // Sequence of the newest valid snapshot
+        int newest_ = -1; // Slot holding it, or -1
+    };
+
+} // namespace Snapshot
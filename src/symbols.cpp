@@ -0,0 +1,61 @@
+/*
+ * Symbol table
+ * See symbols.h for an overview.
+ */
+
+#include "symbols.h"
+
+#include <mutex> // For exclusive inserts
+
+namespace Symbols {
+
+    Id SymbolTable::intern(std::string_view name) {
+        {
+            std::shared_lock lock(mutex_);
+            auto found = ids_.find(name);
+            if (found != ids_.end()) {
+                return found->second;
+            }
+        }
+        std::unique_lock lock(mutex_);
+        auto found = ids_.find(name); // Another thread may have added it meanwhile
+        if (found != ids_.end()) {
+            return found->second;
+        }
+        const auto id = static_cast<Id>(names_.size());
+        const std::string& stored = names_.emplace_back(name);
+        ids_.emplace(stored, id);
+        return id;
+    }
+
+    Id SymbolTable::find(std::string_view name) const {
+        std::shared_lock lock(mutex_);
+        auto found = ids_.find(name);
+        return found == ids_.end() ? NONE : found->second;
+    }
+
+    std::string_view SymbolTable::name(Id id) const {
+        std::shared_lock lock(mutex_);
+        return id < names_.size() ? std::string_view(names_[id]) : std::string_view();
+    }
+
+    std::size_t SymbolTable::size() const {
+        std::shared_lock lock(mutex_);
+        return names_.size();
+    }
+
+    SymbolTable& table() {
+        static SymbolTable instance;
+        return instance;
+    }
+
+    std::vector<Id> intern(const std::vector<std::string>& names) {
+        std::vector<Id> ids;
+        ids.reserve(names.size());
+        for (const auto& name : names) {
+            ids.push_back(table().intern(name));
+        }
+        return ids;
+    }
+
+} // namespace Symbols
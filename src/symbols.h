@@ -0,0 +1,83 @@
+/*
+ * Symbol table
+ * Asset ids (and any other names the tracker keys data by) are interned once, when the
+ * configuration or a rules file is loaded, into dense 32-bit ids. Per-tick structures (the
+ * engine's asset state, the tick store's series, alert tables, price gauges) are then plain
+ * vectors indexed by id, so an update never hashes or compares a string to find its data.
+ * Ids are process-wide and never reused, and the name of an id stays valid for the life of
+ * the process.
+ */
+
+#pragma once
+
+#include <cstdint> // For fixed-width ids
+#include <deque> // For names with stable addresses
+#include <shared_mutex> // For concurrent lookups
+#include <string> // For owned names
+#include <string_view> // For lookups
+#include <unordered_map> // For the name index
+#include <vector> // For id lists
+
+namespace Symbols {
+
+    using Id = std::uint32_t;
+
+    constexpr Id NONE = static_cast<Id>(-1);
+
+    // Intern table; safe to use from several threads
+    class SymbolTable {
+    public:
+        // Id of `name`, assigning the next free id the first time it is seen
+        Id intern(std::string_view name);
+
+        // Id of `name`, or NONE if it was never interned
+        Id find(std::string_view name) const;
+
+        // Name of an interned id
+        std::string_view name(Id id) const;
+
+        std::size_t size() const;
+
+    private:
+        mutable std::shared_mutex mutex_;
+        std::deque<std::string> names_; // Indexed by id; deque elements never move
+        std::unordered_map<std::string_view, Id> ids_; // Views into names_
+    };
+
+    // The process-wide table
+    SymbolTable& table();
+
+    inline Id intern(std::string_view name) { return table().intern(name); }
+    inline Id find(std::string_view name) { return table().find(name); }
+    inline std::string_view name(Id id) { return table().name(id); }
+
+    // Ids of a list of names, in the same order
+    std::vector<Id> intern(const std::vector<std::string>& names);
+
+    // Vector indexed by id, grown on demand; slots of ids never stored hold a default T
+    template <typename T>
+    class IdMap {
+    public:
+        // Slot of `id`, created if needed
+        T& operator[](Id id) {
+            if (id >= slots_.size()) {
+                slots_.resize(static_cast<std::size_t>(id) + 1);
+            }
+            return slots_[id];
+        }
+
+        // Slot of `id`, or nullptr if it was never created
+        const T* find(Id id) const { return id < slots_.size() ? &slots_[id] : nullptr; }
+        T* find(Id id) { return id < slots_.size() ? &slots_[id] : nullptr; }
+
+        std::size_t size() const { return slots_.size(); }
+        auto begin() { return slots_.begin(); }
+        auto end() { return slots_.end(); }
+        auto begin() const { return slots_.begin(); }
+        auto end() const { return slots_.end(); }
+
+    private:
+        std::vector<T> slots_;
+    };
+
+} // namespace Symbols
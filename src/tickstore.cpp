@@ -0,0 +1,107 @@
+/*
+ * Tick store
+ * See tickstore.h for an overview.
+ */
+
+#include "tickstore.h"
+
+#include <algorithm> // For sorting, merging and block search
+#include <mutex> // For the write lock
+#include <utility> // For std::move
+
+namespace Ticks {
+
+    void Series::push(Tick tick) {
+        // Every block but the last one is full
+        if (blocks_.empty() || blocks_.back().size() == BLOCK_TICKS) {
+            Block& block = blocks_.emplace_back();
+            block.timestamps.reserve(BLOCK_TICKS);
+            block.units.reserve(BLOCK_TICKS);
+            block.minTimestamp = tick.timestampMs;
+            block.minUnits = block.maxUnits = tick.units;
+        }
+        Block& block = blocks_.back();
+        block.timestamps.push_back(tick.timestampMs);
+        block.units.push_back(tick.units);
+        block.maxTimestamp = tick.timestampMs;
+        block.minUnits = std::min(block.minUnits, tick.units);
+        block.maxUnits = std::max(block.maxUnits, tick.units);
+        ++size_;
+    }
+
+    void Series::append(Tick tick) {
+        if (!blocks_.empty() && tick.timestampMs <= blocks_.back().maxTimestamp) {
+            insert({ tick });
+            return;
+        }
+        push(tick);
+    }
+
+    std::size_t Series::insert(std::vector<Tick> ticks) {
+        if (ticks.empty()) {
+            return 0;
+        }
+        auto byTime = [](const Tick& a, const Tick& b) { return a.timestampMs < b.timestampMs; };
+        std::stable_sort(ticks.begin(), ticks.end(), byTime);
+        ticks.erase(std::unique(ticks.begin(), ticks.end(), [](const Tick& a, const Tick& b) { return a.timestampMs == b.timestampMs; }), ticks.end());
+
+        // Everything is newer: plain append (the common case for backfills into an empty store)
+        if (blocks_.empty() || ticks.front().timestampMs > blocks_.back().maxTimestamp) {
+            for (const Tick& tick : ticks) {
+                push(tick);
+            }
+            return ticks.size();
+        }
+
+        // Re-merge from the first block the new ticks can fall into; earlier blocks stay untouched
+        const auto first = std::partition_point(blocks_.begin(), blocks_.end(),
+                                                [&](const Block& block) { return block.maxTimestamp < ticks.front().timestampMs; });
+        std::vector<Tick> existing;
+        for (auto block = first; block != blocks_.end(); ++block) {
+            for (std::size_t i = 0; i < block->size(); ++i) {
+                existing.push_back({ block->timestamps[i], block->units[i] });
+            }
+        }
+        size_ -= existing.size();
+        blocks_.erase(first, blocks_.end());
+
+        std::size_t added = 0;
+        auto next = ticks.begin();
+        for (const Tick& tick : existing) {
+            for (; next != ticks.end() && next->timestampMs < tick.timestampMs; ++next, ++added) {
+                push(*next);
+            }
+            if (next != ticks.end() && next->timestampMs == tick.timestampMs) {
+                ++next; // Already stored: keep the existing price
+            }
+            push(tick);
+        }
+        for (; next != ticks.end(); ++next, ++added) {
+            push(*next);
+        }
+        return added;
+    }
+
+    Series& TickStore::seriesFor(Symbols::Id asset, std::uint8_t scale) {
+        auto& series = series_[asset];
+        if (!series) {
+            series = std::make_unique<Series>(scale);
+        }
+        return *series;
+    }
+
+    std::size_t TickStore::insert(Symbols::Id asset, std::uint8_t scale, std::vector<Tick> ticks) {
+        std::unique_lock lock(mutex_);
+        return seriesFor(asset, scale).insert(std::move(ticks));
+    }
+
+    void TickStore::append(Symbols::Id asset, std::uint8_t scale, Tick tick) {
+        std::unique_lock lock(mutex_);
+        seriesFor(asset, scale).append(tick);
+    }
+
+    std::size_t TickStore::tickCount(Symbols::Id asset) const {
+        return read(asset, [](const Series* series) { return series ? series->size() : 0; });
+    }
+
+} // namespace Ticks
@@ -0,0 +1,90 @@
+/*
+ * Tick store
+ * In-memory price history per asset, stored column-wise in fixed-size blocks
+ * (timestamps and fixed-point units in separate arrays). Each block carries the
+ * min/max of both columns so range scans can skip whole blocks. Inserts are kept
+ * sorted by timestamp and deduplicated: a timestamp that is already stored keeps
+ * its existing price.
+ */
+
+#pragma once
+
+#include <cstddef> // For std::size_t
+#include <cstdint> // For fixed-width integers
+#include <memory> // For the per-asset series
+#include <shared_mutex> // For concurrent readers
+#include <vector> // For columns and blocks
+
+#include "symbols.h" // For interned asset ids
+
+namespace Ticks {
+
+    struct Tick {
+        std::int64_t timestampMs;
+        std::int64_t units; // Fixed-point units at the series' scale
+    };
+
+    constexpr std::size_t BLOCK_TICKS = 4096; // Ticks per full block
+
+    // One column chunk of a series; ticks are sorted by timestamp within and across blocks
+    struct Block {
+        std::vector<std::int64_t> timestamps;
+        std::vector<std::int64_t> units;
+        std::int64_t minTimestamp = 0;
+        std::int64_t maxTimestamp = 0;
+        std::int64_t minUnits = 0;
+        std::int64_t maxUnits = 0;
+
+        std::size_t size() const { return timestamps.size(); }
+    };
+
+    // Sorted, deduplicated ticks of one asset
+    class Series {
+    public:
+        explicit Series(std::uint8_t scale) : scale_(scale) {}
+
+        // Merge ticks in any order; returns how many were new
+        std::size_t insert(std::vector<Tick> ticks);
+
+        // Fast path for a tick later than every stored one (live updates); older or
+        // duplicate timestamps go through insert()
+        void append(Tick tick);
+
+        const std::vector<Block>& blocks() const { return blocks_; }
+        std::size_t size() const { return size_; }
+        std::uint8_t scale() const { return scale_; }
+
+    private:
+        void push(Tick tick);
+
+        std::vector<Block> blocks_;
+        std::size_t size_ = 0;
+        std::uint8_t scale_;
+    };
+
+    // Series of every asset, indexed by symbol id, safe to read from one thread while another writes
+    class TickStore {
+    public:
+        // Merge ticks into an asset's series, creating it at `scale`; returns how many were new
+        std::size_t insert(Symbols::Id asset, std::uint8_t scale, std::vector<Tick> ticks);
+
+        void append(Symbols::Id asset, std::uint8_t scale, Tick tick);
+
+        // Run `reader` on an asset's series (nullptr if unknown, including Symbols::NONE) under the read lock
+        template <typename Reader>
+        auto read(Symbols::Id asset, Reader&& reader) const {
+            std::shared_lock lock(mutex_);
+            const auto* slot = series_.find(asset);
+            return reader(slot != nullptr ? slot->get() : nullptr);
+        }
+
+        std::size_t tickCount(Symbols::Id asset) const;
+
+    private:
+        Series& seriesFor(Symbols::Id asset, std::uint8_t scale);
+
+        mutable std::shared_mutex mutex_;
+        Symbols::IdMap<std::unique_ptr<Series>> series_;
+    };
+
+} // namespace Ticks
@@ -0,0 +1,163 @@
+/*
+ * Timestamp formatting
+ * See timefmt.h for an overview.
+ */
+
+#include "timefmt.h"
+
+#include <ctime> // For the reentrant localtime_r / localtime_s
+
+namespace TimeFormat {
+
+    namespace {
+
+        constexpr std::int64_t SECONDS_PER_DAY = 86400;
+        constexpr std::int64_t OFFSET_CHECK_SECONDS = 900; // Granularity of UTC offset transitions
+
+        // Write `value` as exactly `width` zero-padded digits
+        char* writeDigits(char* out, std::int64_t value, int width) {
+            for (int i = width - 1; i >= 0; --i) {
+                out[i] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            }
+            return out + width;
+        }
+
+        // Offset of local time from UTC in seconds at `seconds` since epoch, via the reentrant C API
+        std::int64_t localOffsetSeconds(std::int64_t seconds) {
+            std::time_t time = static_cast<std::time_t>(seconds);
+            std::tm local{};
+#ifdef _WIN32
+            localtime_s(&local, &time);
+#else
+            localtime_r(&time, &local);
+#endif
+            const std::int64_t localSeconds = daysFromCivil(local.tm_year + 1900, static_cast<unsigned>(local.tm_mon + 1),
+                                                            static_cast<unsigned>(local.tm_mday)) * SECONDS_PER_DAY
+                                              + local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec;
+            return localSeconds - seconds;
+        }
+
+        // Per-thread cache for the display format: the text only changes once per minute
+        struct LocalCache {
+            std::int64_t minute = INT64_MIN; // Epoch minute the text was built for
+            std::int64_t offsetQuarter = INT64_MIN; // Epoch quarter-hour the UTC offset was computed for
+            std::int64_t offset = 0;
+            TimeText text;
+        };
+
+        // Per-thread cache for ISO-8601: the "YYYY-MM-DDT" prefix only changes once per day
+        struct UtcCache {
+            std::int64_t day = INT64_MIN;
+            char prefix[16];
+            std::size_t prefixLength = 0;
+        };
+
+        thread_local LocalCache localCache;
+        thread_local UtcCache utcCache;
+
+    } // namespace
+
+    CivilDate civilFromDays(std::int64_t days) {
+        // Howard Hinnant's days_from_civil inverse, valid for the whole int64 day range we use
+        days += 719468;
+        const std::int64_t era = floorDiv(days, 146097);
+        const auto dayOfEra = static_cast<unsigned>(days - era * 146097);
+        const unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const unsigned monthIndex = (5 * dayOfYear + 2) / 153;
+        const unsigned day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+        const unsigned month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+        const std::int64_t year = static_cast<std::int64_t>(yearOfEra) + era * 400 + (month <= 2 ? 1 : 0);
+        return { year, month, day };
+    }
+
+    std::int64_t daysFromCivil(std::int64_t year, unsigned month, unsigned day) {
+        year -= month <= 2 ? 1 : 0;
+        const std::int64_t era = floorDiv(year, 400);
+        const auto yearOfEra = static_cast<unsigned>(year - era * 400);
+        const unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + static_cast<std::int64_t>(dayOfEra) - 719468;
+    }
+
+    TimeText localUS(std::chrono::system_clock::time_point time) {
+        const std::int64_t seconds = std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+        const std::int64_t minute = floorDiv(seconds, 60);
+        LocalCache& cache = localCache;
+        if (minute == cache.minute) {
+            return cache.text; // Same minute: nothing visible changed
+        }
+
+        // Offsets are whole quarter-hours and change at a local wall-clock time, so transitions fall
+        // on quarter-hour UTC instants (not always whole hours: St. John's, Lord Howe, Chatham);
+        // ask the C library once per quarter-hour
+        const std::int64_t quarter = floorDiv(seconds, OFFSET_CHECK_SECONDS);
+        if (quarter != cache.offsetQuarter) {
+            cache.offset = localOffsetSeconds(seconds);
+            cache.offsetQuarter = quarter;
+        }
+
+        const std::int64_t local = seconds + cache.offset;
+        const std::int64_t days = floorDiv(local, SECONDS_PER_DAY);
+        const std::int64_t secondOfDay = local - days * SECONDS_PER_DAY;
+        const CivilDate date = civilFromDays(days);
+        const std::int64_t hours24 = secondOfDay / 3600;
+        const std::int64_t hours12 = hours24 % 12 == 0 ? 12 : hours24 % 12;
+
+        char* out = cache.text.buffer;
+        out = writeDigits(out, date.month, 2);
+        *out++ = '/';
+        out = writeDigits(out, date.day, 2);
+        *out++ = '/';
+        out = writeDigits(out, date.year, 4);
+        *out++ = ' ';
+        out = writeDigits(out, hours12, 2);
+        *out++ = ':';
+        out = writeDigits(out, secondOfDay / 60 % 60, 2);
+        *out++ = ' ';
+        *out++ = hours24 < 12 ? 'A' : 'P';
+        *out++ = 'M';
+        cache.text.length = static_cast<std::size_t>(out - cache.text.buffer);
+        cache.minute = minute;
+        return cache.text;
+    }
+
+    TimeText iso8601Utc(std::chrono::system_clock::time_point time) {
+        const std::int64_t millis = std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+        const std::int64_t days = floorDiv(millis, SECONDS_PER_DAY * 1000);
+        const std::int64_t millisOfDay = millis - days * SECONDS_PER_DAY * 1000;
+
+        UtcCache& cache = utcCache;
+        if (days != cache.day) {
+            // New day: rebuild the "YYYY-MM-DDT" prefix
+            const CivilDate date = civilFromDays(days);
+            char* out = cache.prefix;
+            out = writeDigits(out, date.year, 4);
+            *out++ = '-';
+            out = writeDigits(out, date.month, 2);
+            *out++ = '-';
+            out = writeDigits(out, date.day, 2);
+            *out++ = 'T';
+            cache.prefixLength = static_cast<std::size_t>(out - cache.prefix);
+            cache.day = days;
+        }
+
+        TimeText text;
+        char* out = text.buffer;
+        for (std::size_t i = 0; i < cache.prefixLength; ++i) {
+            *out++ = cache.prefix[i];
+        }
+        out = writeDigits(out, millisOfDay / 3600000, 2);
+        *out++ = ':';
+        out = writeDigits(out, millisOfDay / 60000 % 60, 2);
+        *out++ = ':';
+        out = writeDigits(out, millisOfDay / 1000 % 60, 2);
+        *out++ = '.';
+        out = writeDigits(out, millisOfDay % 1000, 3);
+        *out++ = 'Z';
+        text.length = static_cast<std::size_t>(out - text.buffer);
+        return text;
+    }
+
+} // namespace TimeFormat
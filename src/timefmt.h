@@ -0,0 +1,50 @@
+/*
+ * Timestamp formatting
+ * Thread-safe, allocation-free formatting of wall-clock times for the display and logs.
+ * Each thread caches the part of the text that rarely changes (the date, or the whole
+ * minute for the display format) and only recomputes the changed fields with integer math.
+ */
+
+#pragma once
+
+#include <chrono> // For std::chrono::system_clock
+#include <cstddef> // For std::size_t
+#include <cstdint> // For fixed-width integers
+#include <string_view> // For non-owning text
+
+namespace TimeFormat {
+
+    // Stack buffer holding a formatted timestamp
+    struct TimeText {
+        char buffer[32];
+        std::size_t length = 0;
+        std::string_view view() const { return { buffer, length }; }
+    };
+
+    // Local time in US format "MM/DD/YYYY HH:MM AM/PM", as shown in the tracker panel
+    TimeText localUS(std::chrono::system_clock::time_point time = std::chrono::system_clock::now());
+
+    // UTC time in ISO-8601 format with milliseconds, "YYYY-MM-DDTHH:MM:SS.mmmZ"
+    TimeText iso8601Utc(std::chrono::system_clock::time_point time = std::chrono::system_clock::now());
+
+    // Floor division, so times before the epoch land in the right day, minute or bucket
+    constexpr std::int64_t floorDiv(std::int64_t value, std::int64_t divisor) {
+        std::int64_t quotient = value / divisor;
+        if ((value % divisor != 0) && ((value < 0) != (divisor < 0))) {
+            --quotient;
+        }
+        return quotient;
+    }
+
+    // Civil date for a count of days since 1970-01-01 (proleptic Gregorian calendar)
+    struct CivilDate {
+        std::int64_t year;
+        unsigned month; // 1-12
+        unsigned day; // 1-31
+    };
+    CivilDate civilFromDays(std::int64_t days);
+
+    // Inverse of civilFromDays
+    std::int64_t daysFromCivil(std::int64_t year, unsigned month, unsigned day);
+
+} // namespace TimeFormat
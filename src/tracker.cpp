@@ -0,0 +1,87 @@
+/*
+ * Tracker engine
+ * See tracker.h for an overview.
+ */
+
+#include "tracker.h"
+
+#include <utility> // For std::move
+
+namespace Tracker {
+
+    Engine::Engine(std::string currencyCode, Alerts::AlertEngine* alerts)
+        : currencyCode_(std::move(currencyCode)), currency_(Pricing::currencySpec(currencyCode_)), alerts_(alerts) {
+    }
+
+    AssetState& Engine::stateFor(Symbols::Id asset) {
+        auto& state = assets_[asset];
+        if (!state) {
+            state = std::make_unique<AssetState>();
+            state->aggregator.addSink(state->history.sink());
+        }
+        return *state;
+    }
+
+    void Engine::ingest(Symbols::Id asset, std::int64_t timestampMs, Pricing::Price price) {
+        AssetState& state = stateFor(asset);
+        state.aggregator.addTick(timestampMs, price); // Update every candle resolution with the new price
+        state.recent.push_back({ timestampMs, price.units });
+        if (state.recent.size() > Snapshot::RECENT_TICKS) {
+            state.recent.pop_front();
+        }
+        ticks_.append(asset, currency_.scale, { timestampMs, price.units });
+        if (alerts_) {
+            alerts_->onTick(asset, timestampMs, price); // Evaluate alert rules; actions run in the background
+        }
+    }
+
+    bool Engine::restore(const Snapshot::AssetState& saved) {
+        if (saved.currency != currencyCode_ || saved.scale != currency_.scale) {
+            return false;
+        }
+        const Symbols::Id asset = Symbols::intern(saved.asset);
+        AssetState& state = stateFor(asset);
+        for (std::size_t r = 0; r < Candles::RESOLUTION_COUNT; ++r) {
+            const auto resolution = static_cast<Candles::Resolution>(r);
+            for (const auto& bar : saved.bars[r]) {
+                state.history.append(resolution, bar);
+            }
+            if (saved.openActive[r]) {
+                state.aggregator.restore(resolution, saved.open[r]);
+            }
+        }
+        state.recent.assign(saved.ticks.begin(), saved.ticks.end());
+        ticks_.insert(asset, saved.scale, saved.ticks);
+        if (alerts_) {
+            for (const auto& tick : saved.ticks) {
+                alerts_->warm(asset, tick.timestampMs, Pricing::Price{ tick.units, saved.scale });
+            }
+        }
+        return true;
+    }
+
+    std::vector<Snapshot::AssetView> Engine::snapshotViews() const {
+        std::vector<Snapshot::AssetView> views;
+        views.reserve(assets_.size());
+        for (Symbols::Id asset = 0; asset < assets_.size(); ++asset) {
+            if (const auto& state = *assets_.find(asset)) {
+                views.push_back({ Symbols::name(asset), currencyCode_, currency_.scale, &state->recent, &state->aggregator, &state->history });
+            }
+        }
+        return views;
+    }
+
+    const AssetState* Engine::find(Symbols::Id asset) const {
+        const auto* slot = assets_.find(asset);
+        return slot != nullptr ? slot->get() : nullptr;
+    }
+
+    void Engine::flush() {
+        for (auto& state : assets_) {
+            if (state) {
+                state->aggregator.flush();
+            }
+        }
+    }
+
+} // namespace Tracker
@@ -0,0 +1,72 @@
+/*
+ * Tracker engine
+ * Owns the analytics state fed by every price: per-asset candles and recent ticks, the
+ * queryable tick store and the alert engine hook. Fetching and display stay outside, so
+ * the engine can be embedded in another service or driven by a benchmark directly.
+ */
+
+#pragma once
+
+#include <cstdint> // For fixed-width integers
+#include <deque> // For recent ticks
+#include <memory> // For per-asset state
+#include <string> // For the currency code
+#include <vector> // For snapshot views
+
+#include "alerts.h" // For the alert hook
+#include "candles.h" // For candle aggregation
+#include "price.h" // For fixed-point prices
+#include "snapshot.h" // For saving and restoring state
+#include "symbols.h" // For interned asset ids
+#include "tickstore.h" // For the queryable history
+
+namespace Tracker {
+
+    // Analytics state of one asset
+    struct AssetState {
+        Candles::CandleAggregator aggregator;
+        Candles::CandleHistory history;
+        std::deque<Snapshot::Tick> recent; // Last ticks, saved in snapshots to refill charts and alert windows
+    };
+
+    class Engine {
+    public:
+        // Prices are quoted in `currencyCode`; `alerts` may be null and must outlive the engine
+        explicit Engine(std::string currencyCode, Alerts::AlertEngine* alerts = nullptr);
+
+        Engine(const Engine&) = delete;
+        Engine& operator=(const Engine&) = delete;
+
+        const std::string& currencyCode() const { return currencyCode_; }
+        const Pricing::CurrencySpec& currency() const { return currency_; }
+
+        // Feed a live price: candles, recent ticks, tick store, then alerts
+        void ingest(Symbols::Id asset, std::int64_t timestampMs, Pricing::Price price);
+
+        // Restore one asset from a snapshot; returns false (and changes nothing) when it was saved
+        // in another currency, whose prices would be read at the wrong scale
+        bool restore(const Snapshot::AssetState& saved);
+
+        // Views of every asset for Snapshot::Writer::write(), valid until the next ingest()
+        std::vector<Snapshot::AssetView> snapshotViews() const;
+
+        // State of an asset, or nullptr before its first price
+        const AssetState* find(Symbols::Id asset) const;
+
+        // Seal the open candles so sinks see the last bars
+        void flush();
+
+        Ticks::TickStore& ticks() { return ticks_; }
+        const Ticks::TickStore& ticks() const { return ticks_; }
+
+    private:
+        AssetState& stateFor(Symbols::Id asset);
+
+        std::string currencyCode_; // Config currency, also for generic currencies without a spec of their own
+        const Pricing::CurrencySpec& currency_;
+        Alerts::AlertEngine* alerts_;
+        Symbols::IdMap<std::unique_ptr<AssetState>> assets_; // Heap-held: the aggregator's sink points into the history
+        Ticks::TickStore ticks_; // Every price seen (backfilled, restored or live)
+    };
+
+} // namespace Tracker
@@ -0,0 +1,756 @@
+/*
+ * io_uring backend
+ * See uring.h for an overview.
+ */
+
+#include "uring.h"
+
+#include <algorithm> // For std::min and std::max
+#include <cerrno> // For syscall errors
+#include <charconv> // For ports, statuses and chunk sizes
+#include <cstring> // For std::memset, std::memcpy and std::strerror
+
+#include <fcntl.h> // For open()
+#include <netdb.h> // For getaddrinfo()
+#include <netinet/in.h> // For IPPROTO_TCP
+#include <netinet/tcp.h> // For TCP_NODELAY
+#include <sys/mman.h> // For the queue mappings
+#include <sys/syscall.h> // For the io_uring syscall numbers
+#include <unistd.h> // For syscall(), lseek() and close()
+
+namespace Uring {
+
+    namespace {
+
+        constexpr std::size_t RECEIVE_BYTES = 16 * 1024; // Per receive while reading headers or unsized bodies
+        constexpr std::size_t MAX_DIRECT_RECEIVE_BYTES = 1024 * 1024; // So a bogus Content-Length cannot reserve gigabytes
+        constexpr std::size_t MAX_HEADER_BYTES = 64 * 1024;
+        constexpr std::size_t WRITE_BUFFER_BYTES = 64 * 1024;
+        constexpr std::size_t WRITE_BUFFERS = 4; // Up to three in flight while the fourth fills
+
+        int setup(unsigned entries, io_uring_params& params) {
+            return static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        }
+
+        std::string systemError(const char* what, int code) {
+            return std::string(what) + ": " + std::strerror(code);
+        }
+
+        bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+            return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+                return (x | 0x20) == (y | 0x20); // ASCII letters only, which is all header names use
+            });
+        }
+
+        bool containsIgnoreCase(std::string_view text, std::string_view word) {
+            for (std::size_t i = 0; i + word.size() <= text.size(); ++i) {
+                if (equalsIgnoreCase(text.substr(i, word.size()), word)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::string_view trim(std::string_view text) {
+            while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+                text.remove_prefix(1);
+            }
+            while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+                text.remove_suffix(1);
+            }
+            return text;
+        }
+
+    } // namespace
+
+    bool available() {
+        static const bool supported = [] {
+            io_uring_params params{};
+            const int fd = setup(1, params);
+            if (fd < 0) {
+                return false;
+            }
+            ::close(fd);
+            return true;
+        }();
+        return supported;
+    }
+
+    bool parseHttpUrl(std::string_view url, std::string& host, int& port) {
+        constexpr std::string_view SCHEME = "http://";
+        if (url.substr(0, SCHEME.size()) != SCHEME) {
+            return false;
+        }
+        url.remove_prefix(SCHEME.size());
+        if (!url.empty() && url.back() == '/') {
+            url.remove_suffix(1);
+        }
+        if (url.empty() || url.find('/') != std::string_view::npos || url.front() == '[') {
+            return false; // Paths and IPv6 literals are left to httplib
+        }
+        const std::size_t colon = url.find(':');
+        port = 80;
+        if (colon != std::string_view::npos) {
+            const std::string_view digits = url.substr(colon + 1);
+            const auto parsed = std::from_chars(digits.data(), digits.data() + digits.size(), port);
+            if (digits.empty() || parsed.ptr != digits.data() + digits.size() || port <= 0 || port > 65535) {
+                return false;
+            }
+        }
+        host.assign(url.substr(0, colon));
+        return !host.empty();
+    }
+
+    // Ring
+
+    Ring::~Ring() {
+        close();
+    }
+
+    bool Ring::open(unsigned entries, std::string& error) {
+        close();
+        io_uring_params params{};
+        fd_ = setup(entries, params);
+        if (fd_ < 0) {
+            error = systemError("io_uring_setup", errno);
+            return false;
+        }
+        sqMapBytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqMapBytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap) {
+            sqMapBytes_ = cqMapBytes_ = std::max(sqMapBytes_, cqMapBytes_);
+        }
+        sqMap_ = ::mmap(nullptr, sqMapBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+        cqMap_ = singleMap ? sqMap_ : ::mmap(nullptr, cqMapBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+        sqesBytes_ = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, sqesBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+        if (sqMap_ == MAP_FAILED || cqMap_ == MAP_FAILED || sqes == MAP_FAILED) {
+            error = systemError("io_uring mmap", errno);
+            sqMap_ = sqMap_ == MAP_FAILED ? nullptr : sqMap_;
+            cqMap_ = cqMap_ == MAP_FAILED ? nullptr : cqMap_;
+            sqes_ = sqes == MAP_FAILED ? nullptr : static_cast<io_uring_sqe*>(sqes);
+            close();
+            return false;
+        }
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+        auto* sq = static_cast<char*>(sqMap_);
+        sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqEntries_ = params.sq_entries;
+        auto* cq = static_cast<char*>(cqMap_);
+        cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        tail_ = *sqTail_;
+        queued_ = 0;
+        return true;
+    }
+
+    void Ring::close() {
+        if (sqes_ != nullptr) {
+            ::munmap(sqes_, sqesBytes_);
+        }
+        if (cqMap_ != nullptr && cqMap_ != sqMap_) {
+            ::munmap(cqMap_, cqMapBytes_);
+        }
+        if (sqMap_ != nullptr) {
+            ::munmap(sqMap_, sqMapBytes_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        fd_ = -1;
+        sqMap_ = cqMap_ = nullptr;
+        sqes_ = nullptr;
+    }
+
+    io_uring_sqe* Ring::next() {
+        if (!reserve(1)) {
+            return nullptr;
+        }
+        const unsigned index = tail_ & sqMask_;
+        io_uring_sqe* sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqArray_[index] = index;
+        ++tail_;
+        ++queued_;
+        return sqe;
+    }
+
+    bool Ring::reserve(unsigned count) {
+        // Without SQPOLL the kernel consumes every submitted entry inside io_uring_enter
+        auto full = [&] { return tail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) + count > sqEntries_; };
+        return !full() || (submit(0) && !full());
+    }
+
+    bool Ring::submit(unsigned waitFor) {
+        __atomic_store_n(sqTail_, tail_, __ATOMIC_RELEASE);
+        while (true) {
+            const long submitted = ::syscall(__NR_io_uring_enter, fd_, queued_, waitFor, waitFor > 0 ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+            if (submitted >= 0) {
+                queued_ -= std::min<unsigned>(queued_, static_cast<unsigned>(submitted));
+                return true;
+            }
+            if (errno != EINTR) {
+                return false;
+            }
+        }
+    }
+
+    bool Ring::registerBuffers(const iovec* buffers, unsigned count, std::string& error) {
+        if (::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS, buffers, count) != 0) {
+            error = systemError("io_uring_register", errno);
+            return false;
+        }
+        return true;
+    }
+
+    // HttpClient
+
+    HttpClient::HttpClient(std::string host, int port, std::size_t connections)
+        : host_(std::move(host)), port_(port), connections_(std::max<std::size_t>(connections, 1)) {
+        hostHeader_ = port_ == 80 ? host_ : host_ + ":" + std::to_string(port_);
+    }
+
+    HttpClient::~HttpClient() {
+        for (auto& connection : connections_) {
+            closeSocket(connection);
+        }
+    }
+
+    bool HttpClient::open(std::string& error) {
+        // Two entries per connection (an operation and its linked timeout), doubled for headroom
+        if (!ring_.open(static_cast<unsigned>(std::max<std::size_t>(8, 4 * connections_.size())), error)) {
+            return false;
+        }
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* found = nullptr;
+        const int result = ::getaddrinfo(host_.c_str(), std::to_string(port_).c_str(), &hints, &found);
+        if (result != 0 || found == nullptr) {
+            error = std::string("resolve ") + host_ + ": " + ::gai_strerror(result);
+            return false;
+        }
+        std::memcpy(&address_, found->ai_addr, found->ai_addrlen);
+        addressLength_ = static_cast<unsigned>(found->ai_addrlen);
+        ::freeaddrinfo(found);
+        return true;
+    }
+
+    void HttpClient::setTimeouts(int connectSeconds, int readSeconds) {
+        connectTimeoutSeconds_ = connectSeconds;
+        readTimeoutSeconds_ = readSeconds;
+    }
+
+    void HttpClient::start(std::size_t index, Request& request) {
+        Connection& connection = connections_[index];
+        request.status = 0;
+        request.error.clear();
+        request.headers.clear();
+        request.socketReady = request.connected = request.headersReceived = Request::Clock::time_point();
+        connection.request = &request;
+        connection.out.clear();
+        connection.out.append("GET ").append(request.target).append(" HTTP/1.1\r\nHost: ").append(hostHeader_)
+            .append("\r\nAccept: */*\r\nUser-Agent: btc-price-tracker\r\nConnection: keep-alive\r\n\r\n");
+        connection.sent = 0;
+        connection.in.clear();
+        connection.headersDone = false;
+        connection.keepAlive = true;
+        ++active_;
+        connection.reused = connection.fd >= 0;
+        std::string error;
+        if (connection.reused) {
+            queueSend(index);
+        } else if (!queueConnect(index, error)) {
+            request.error = error;
+            closeSocket(connection);
+            failedEarly_.push_back(index);
+        }
+    }
+
+    void HttpClient::poll(std::vector<std::size_t>& finished) {
+        const std::size_t before = finished.size();
+        for (std::size_t index : failedEarly_) {
+            connections_[index].request = nullptr;
+            --active_;
+            finished.push_back(index);
+        }
+        failedEarly_.clear();
+        while (finished.size() == before && active_ > 0) {
+            if (broken_ || !ring_.submit(1)) {
+                broken_ = true;
+                const std::string error = systemError("io_uring_enter", errno);
+                for (std::size_t index = 0; index < connections_.size(); ++index) {
+                    if (connections_[index].request != nullptr) {
+                        fail(index, error, finished);
+                    }
+                }
+                return;
+            }
+            ring_.reap([&](std::uint64_t userData, int result, unsigned) { handle(userData, result, finished); });
+        }
+    }
+
+    void HttpClient::perform(Request* requests, std::size_t count) {
+        count = std::min(count, connections_.size());
+        for (std::size_t i = 0; i < count; ++i) {
+            start(i, requests[i]);
+        }
+        while (active_ > 0) {
+            finished_.clear();
+            poll(finished_);
+        }
+    }
+
+    void HttpClient::disconnect(std::size_t index) {
+        if (connections_[index].request == nullptr) {
+            closeSocket(connections_[index]);
+        }
+    }
+
+    bool HttpClient::queueConnect(std::size_t index, std::string& error) {
+        Connection& connection = connections_[index];
+        connection.fd = ::socket(address_.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (connection.fd < 0) {
+            error = systemError("socket", errno);
+            return false;
+        }
+        const int noDelay = 1;
+        ::setsockopt(connection.fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay)); // As httplib, no Nagle stalls on small requests
+        connection.request->socketReady = Request::Clock::now();
+        if (!ring_.reserve(2)) {
+            broken_ = true; // Reported by poll()
+            return true;
+        }
+        io_uring_sqe* sqe = ring_.next();
+        sqe->opcode = IORING_OP_CONNECT;
+        sqe->fd = connection.fd;
+        sqe->addr = reinterpret_cast<std::uint64_t>(&address_);
+        sqe->off = addressLength_;
+        sqe->flags = IOSQE_IO_LINK;
+        sqe->user_data = tag(index, Op::Connect);
+        linkTimeout(index, connectTimeoutSeconds_);
+        return true;
+    }
+
+    void HttpClient::queueSend(std::size_t index) {
+        Connection& connection = connections_[index];
+        if (!ring_.reserve(2)) {
+            broken_ = true;
+            return;
+        }
+        io_uring_sqe* sqe = ring_.next();
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = connection.fd;
+        sqe->addr = reinterpret_cast<std::uint64_t>(connection.out.data() + connection.sent);
+        sqe->len = static_cast<std::uint32_t>(connection.out.size() - connection.sent);
+        sqe->msg_flags = MSG_NOSIGNAL;
+        sqe->flags = IOSQE_IO_LINK;
+        sqe->user_data = tag(index, Op::Send);
+        linkTimeout(index, readTimeoutSeconds_);
+    }
+
+    void HttpClient::queueReceive(std::size_t index) {
+        Connection& connection = connections_[index];
+        // Sized bodies are received straight into the caller's buffer, everything else into `in`
+        const bool direct = connection.headersDone && connection.mode == BodyMode::Length;
+        const std::size_t length = direct ? std::min(connection.remaining, MAX_DIRECT_RECEIVE_BYTES) : RECEIVE_BYTES;
+        char* destination = direct ? connection.request->body->prepare(length) : connection.in.prepare(length);
+        if (!ring_.reserve(2)) {
+            broken_ = true;
+            return;
+        }
+        io_uring_sqe* sqe = ring_.next();
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = connection.fd;
+        sqe->addr = reinterpret_cast<std::uint64_t>(destination);
+        sqe->len = static_cast<std::uint32_t>(length);
+        sqe->flags = IOSQE_IO_LINK;
+        sqe->user_data = tag(index, Op::Receive);
+        linkTimeout(index, readTimeoutSeconds_);
+    }
+
+    void HttpClient::linkTimeout(std::size_t index, int seconds) {
+        Connection& connection = connections_[index];
+        connection.timeout.tv_sec = seconds;
+        connection.timeout.tv_nsec = 0;
+        io_uring_sqe* sqe = ring_.next();
+        sqe->opcode = IORING_OP_LINK_TIMEOUT;
+        sqe->addr = reinterpret_cast<std::uint64_t>(&connection.timeout);
+        sqe->len = 1;
+        sqe->user_data = tag(index, Op::Timeout);
+    }
+
+    void HttpClient::handle(std::uint64_t userData, int result, std::vector<std::size_t>& finished) {
+        const auto index = static_cast<std::size_t>(userData >> 8);
+        const auto op = static_cast<Op>(userData & 0xff);
+        Connection& connection = connections_[index];
+        if (op == Op::Timeout || connection.request == nullptr) {
+            return; // A timeout that fired shows up as -ECANCELED on the operation it guarded
+        }
+        switch (op) {
+            case Op::Connect:
+                if (result < 0) {
+                    fail(index, result == -ECANCELED ? "connect timed out" : systemError("connect", -result), finished);
+                    return;
+                }
+                connection.request->connected = Request::Clock::now();
+                queueSend(index);
+                return;
+            case Op::Send:
+                if (result < 0) {
+                    retryOrFail(index, op, result, finished);
+                    return;
+                }
+                connection.sent += static_cast<std::size_t>(result);
+                if (connection.sent < connection.out.size()) {
+                    queueSend(index);
+                } else {
+                    queueReceive(index);
+                }
+                return;
+            case Op::Receive:
+                if (result > 0) {
+                    onReceived(index, static_cast<std::size_t>(result), finished);
+                } else if (result == 0 && connection.headersDone && connection.mode == BodyMode::UntilClose) {
+                    connection.keepAlive = false;
+                    finish(index, finished);
+                } else {
+                    retryOrFail(index, op, result, finished);
+                }
+                return;
+            case Op::Timeout:
+                return;
+        }
+    }
+
+    void HttpClient::onReceived(std::size_t index, std::size_t length, std::vector<std::size_t>& finished) {
+        Connection& connection = connections_[index];
+        Request& request = *connection.request;
+        if (connection.headersDone && connection.mode == BodyMode::Length) {
+            request.body->commit(length);
+            connection.remaining -= length;
+        } else {
+            connection.in.commit(length);
+            if (!connection.headersDone) {
+                const int parsed = parseHeaders(connection);
+                if (parsed < 0) {
+                    fail(index, "malformed response headers", finished);
+                    return;
+                }
+                if (parsed == 0) {
+                    queueReceive(index);
+                    return;
+                }
+            } else if (connection.mode == BodyMode::UntilClose) {
+                request.body->append(connection.in.data(), connection.in.size());
+                connection.in.clear();
+            }
+        }
+        bool done = false;
+        switch (connection.mode) {
+            case BodyMode::Length:
+                done = connection.remaining == 0;
+                break;
+            case BodyMode::Chunked:
+                if (!decodeChunks(connection, done)) {
+                    fail(index, "malformed chunked body", finished);
+                    return;
+                }
+                break;
+            case BodyMode::UntilClose:
+                break;
+        }
+        if (done) {
+            finish(index, finished);
+        } else {
+            queueReceive(index);
+        }
+    }
+
+    int HttpClient::parseHeaders(Connection& connection) {
+        const std::string_view received = connection.in.view();
+        const std::size_t end = received.find("\r\n\r\n");
+        if (end == std::string_view::npos) {
+            return received.size() > MAX_HEADER_BYTES ? -1 : 0;
+        }
+        Request& request = *connection.request;
+        connection.head.assign(received.data(), end + 2); // Every line keeps its CRLF
+        const std::string_view head = connection.head;
+        const std::size_t statusEnd = head.find("\r\n");
+        const std::string_view statusLine = head.substr(0, statusEnd);
+        int status = 0;
+        if (statusLine.size() < 12 || statusLine.substr(0, 7) != "HTTP/1."
+            || std::from_chars(statusLine.data() + 9, statusLine.data() + 12, status).ptr != statusLine.data() + 12) {
+            return -1;
+        }
+        connection.keepAlive = statusLine[7] == '1'; // HTTP/1.0 closes unless told otherwise
+        bool chunked = false;
+        bool sized = false;
+        std::size_t length = 0;
+        for (std::size_t line = statusEnd + 2; line < head.size();) {
+            const std::size_t lineEnd = head.find("\r\n", line);
+            const std::string_view field = head.substr(line, lineEnd - line);
+            line = lineEnd + 2;
+            const std::size_t colon = field.find(':');
+            if (colon == std::string_view::npos) {
+                return -1;
+            }
+            const std::string_view name = trim(field.substr(0, colon));
+            const std::string_view value = trim(field.substr(colon + 1));
+            request.headers.emplace_back(name, value);
+            if (equalsIgnoreCase(name, "Content-Length")) {
+                sized = std::from_chars(value.data(), value.data() + value.size(), length).ptr == value.data() + value.size();
+                if (!sized) {
+                    return -1;
+                }
+            } else if (equalsIgnoreCase(name, "Transfer-Encoding")) {
+                chunked = containsIgnoreCase(value, "chunked");
+            } else if (equalsIgnoreCase(name, "Connection")) {
+                connection.keepAlive = containsIgnoreCase(value, "keep-alive") || (connection.keepAlive && !containsIgnoreCase(value, "close"));
+            }
+        }
+        request.status = status;
+        request.headersReceived = Request::Clock::now();
+        connection.headersDone = true;
+        const std::string_view rest = received.substr(end + 4);
+        if (chunked) {
+            connection.mode = BodyMode::Chunked;
+            connection.chunkCursor = end + 4;
+            return 1;
+        }
+        if (!sized && (status == 204 || status == 304 || status < 200)) {
+            sized = true; // No body
+        }
+        if (sized) {
+            connection.mode = BodyMode::Length;
+            const std::size_t take = std::min(rest.size(), length);
+            request.body->append(rest.data(), take);
+            connection.remaining = length - take;
+        } else {
+            connection.mode = BodyMode::UntilClose;
+            connection.keepAlive = false;
+            request.body->append(rest.data(), rest.size());
+        }
+        connection.in.clear();
+        return 1;
+    }
+
+    bool HttpClient::decodeChunks(Connection& connection, bool& done) {
+        const std::string_view data = connection.in.view();
+        while (true) {
+            const std::size_t lineEnd = data.find("\r\n", connection.chunkCursor);
+            if (lineEnd == std::string_view::npos) {
+                return true; // Size line still incomplete
+            }
+            std::size_t size = 0;
+            const char* first = data.data() + connection.chunkCursor;
+            if (std::from_chars(first, data.data() + lineEnd, size, 16).ptr == first) {
+                return false;
+            }
+            if (size == 0) {
+                done = data.find("\r\n\r\n", lineEnd) != std::string_view::npos; // Optional trailers, then an empty line
+                return true;
+            }
+            const std::size_t chunk = lineEnd + 2;
+            if (data.size() < chunk + size + 2) {
+                return true; // Chunk still incomplete
+            }
+            connection.request->body->append(data.data() + chunk, size);
+            connection.chunkCursor = chunk + size + 2;
+        }
+    }
+
+    void HttpClient::retryOrFail(std::size_t index, Op op, int result, std::vector<std::size_t>& finished) {
+        Connection& connection = connections_[index];
+        // A kept-alive connection the server closed meanwhile fails before any byte of the
+        // response; reconnect once, as httplib does
+        const bool stale = result == 0 || result == -ECONNRESET || result == -EPIPE;
+        if (connection.reused && stale && !connection.headersDone && connection.in.size() == 0) {
+            closeSocket(connection);
+            connection.reused = false;
+            connection.sent = 0;
+            std::string error;
+            if (!queueConnect(index, error)) {
+                fail(index, error, finished);
+            }
+            return;
+        }
+        const char* what = op == Op::Send ? "send" : "receive";
+        if (result == -ECANCELED) {
+            fail(index, std::string(what) + " timed out", finished);
+        } else if (result == 0) {
+            fail(index, "connection closed by the server", finished);
+        } else {
+            fail(index, systemError(what, -result), finished);
+        }
+    }
+
+    void HttpClient::finish(std::size_t index, std::vector<std::size_t>& finished) {
+        Connection& connection = connections_[index];
+        connection.request = nullptr;
+        if (!connection.keepAlive) {
+            closeSocket(connection);
+        }
+        --active_;
+        finished.push_back(index);
+    }
+
+    void HttpClient::fail(std::size_t index, std::string error, std::vector<std::size_t>& finished) {
+        Connection& connection = connections_[index];
+        connection.request->status = 0;
+        connection.request->error = std::move(error);
+        connection.keepAlive = false;
+        finish(index, finished);
+    }
+
+    void HttpClient::closeSocket(Connection& connection) {
+        if (connection.fd >= 0) {
+            ::close(connection.fd);
+            connection.fd = -1;
+        }
+    }
+
+    // FileWriter
+
+    FileWriter::~FileWriter() {
+        close();
+    }
+
+    bool FileWriter::open(const std::string& path, bool truncate, std::string& error) {
+        close();
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+        if (fd_ < 0) {
+            error = systemError(path.c_str(), errno);
+            return false;
+        }
+        const off_t end = ::lseek(fd_, 0, SEEK_END);
+        if (end < 0 || !ring_.open(static_cast<unsigned>(2 * WRITE_BUFFERS), error)) {
+            error = end < 0 ? systemError("lseek", errno) : error;
+            ::close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        offset_ = static_cast<std::uint64_t>(end);
+        block_ = std::make_unique<char[]>(WRITE_BUFFERS * WRITE_BUFFER_BYTES);
+        slots_.assign(WRITE_BUFFERS, Slot{});
+        iovec buffers[WRITE_BUFFERS];
+        for (std::size_t i = 0; i < WRITE_BUFFERS; ++i) {
+            slots_[i].data = block_.get() + i * WRITE_BUFFER_BYTES;
+            buffers[i] = { slots_[i].data, WRITE_BUFFER_BYTES };
+        }
+        std::string registerError;
+        registered_ = ring_.registerBuffers(buffers, WRITE_BUFFERS, registerError); // Fails under a low RLIMIT_MEMLOCK on older kernels
+        current_ = 0;
+        inFlight_ = 0;
+        failed_ = false;
+        dead_ = false;
+        return true;
+    }
+
+    void FileWriter::append(const char* data, std::size_t length) {
+        while (length > 0 && !dead_ && fd_ >= 0) {
+            Slot& slot = slots_[current_];
+            const std::size_t take = std::min(length, WRITE_BUFFER_BYTES - slot.filled);
+            std::memcpy(slot.data + slot.filled, data, take);
+            slot.filled += take;
+            data += take;
+            length -= take;
+            if (slot.filled == WRITE_BUFFER_BYTES) {
+                queueCurrent();
+            }
+        }
+    }
+
+    bool FileWriter::flush() {
+        if (fd_ < 0) {
+            return false;
+        }
+        queueCurrent();
+        while (inFlight_ > 0 && !dead_) {
+            if (!ring_.submit(1)) {
+                dead_ = true;
+                break;
+            }
+            ring_.reap([this](std::uint64_t userData, int result, unsigned) { complete(static_cast<std::size_t>(userData), result); });
+        }
+        const bool ok = !failed_ && !dead_;
+        failed_ = false;
+        return ok;
+    }
+
+    void FileWriter::close() {
+        if (fd_ < 0) {
+            return;
+        }
+        flush();
+        ring_.close(); // Unregisters the buffers
+        if (dead_) {
+            (void)block_.release(); // Writes the kernel may still run could read it; leak it instead
+        }
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+    void FileWriter::queueCurrent() {
+        Slot& slot = slots_[current_];
+        if (slot.filled == 0 || dead_) {
+            return;
+        }
+        // Each buffer gets its own range of the file, so buffers may complete in any order
+        slot.offset = offset_;
+        slot.written = 0;
+        slot.inFlight = true;
+        offset_ += slot.filled;
+        ++inFlight_;
+        queueWrite(current_);
+        current_ = (current_ + 1) % slots_.size();
+        waitForSlot();
+    }
+
+    void FileWriter::queueWrite(std::size_t index) {
+        const Slot& slot = slots_[index];
+        io_uring_sqe* sqe = ring_.next();
+        if (sqe == nullptr) {
+            dead_ = true;
+            return;
+        }
+        sqe->opcode = registered_ ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+        sqe->fd = fd_;
+        sqe->addr = reinterpret_cast<std::uint64_t>(slot.data + slot.written);
+        sqe->len = static_cast<std::uint32_t>(slot.filled - slot.written);
+        sqe->off = slot.offset + slot.written;
+        sqe->buf_index = registered_ ? static_cast<std::uint16_t>(index) : 0;
+        sqe->user_data = index;
+    }
+
+    void FileWriter::waitForSlot() {
+        // Full buffers stay queued, and are submitted together, until one is needed again
+        while (slots_[current_].inFlight && !dead_) {
+            if (!ring_.submit(1)) {
+                dead_ = true;
+                return;
+            }
+            ring_.reap([this](std::uint64_t userData, int result, unsigned) { complete(static_cast<std::size_t>(userData), result); });
+        }
+    }
+
+    void FileWriter::complete(std::size_t index, int result) {
+        Slot& slot = slots_[index];
+        if (result > 0 && slot.written + static_cast<std::size_t>(result) < slot.filled) {
+            slot.written += static_cast<std::size_t>(result);
+            queueWrite(index); // Short write: the rest goes right after it
+            return;
+        }
+        failed_ = failed_ || result <= 0;
+        slot.inFlight = false;
+        slot.filled = 0;
+        --inFlight_;
+    }
+
+} // namespace Uring
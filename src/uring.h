@@ -0,0 +1,252 @@
+/*
+ * io_uring backend
+ * Linux-only I/O through io_uring, built with BTC_IO_URING and talking to the kernel with
+ * the raw io_uring_setup/io_uring_enter/io_uring_register syscalls (no liburing). Work is
+ * queued as submission entries and handed to the kernel in one io_uring_enter per batch,
+ * which matters when many connections or appends are in flight at high tick rates.
+ *
+ * - Ring: the shared submission and completion queues.
+ * - HttpClient: plain-HTTP/1.1 GETs over kept-alive connections, many of them driven from one
+ *   thread and one ring (connect, send and receive with linked timeouts). TLS is not handled;
+ *   https endpoints stay on httplib.
+ * - FileWriter: appends through a few registered (pinned) buffers, written at explicit offsets
+ *   so several buffers can be in flight at once; the writer must be the file's only appender.
+ */
+
+#pragma once
+
+#include <chrono> // For phase timestamps and timeouts
+#include <cstddef> // For std::size_t
+#include <cstdint> // For user data
+#include <memory> // For the buffer block
+#include <string> // For hosts and errors
+#include <string_view> // For targets and headers
+#include <utility> // For header pairs
+#include <vector> // For connections and headers
+
+#include <linux/io_uring.h> // For the kernel ABI
+#include <linux/time_types.h> // For __kernel_timespec
+#include <sys/socket.h> // For sockaddr_storage
+#include <sys/uio.h> // For iovec
+
+#include "buffers.h" // For response bodies
+
+namespace Uring {
+
+    // Whether the kernel lets this process create a ring (it may be disabled by sysctl or seccomp)
+    bool available();
+
+    // Split "http://host[:port]" into host and port; false for other schemes or URLs with a path
+    bool parseHttpUrl(std::string_view url, std::string& host, int& port);
+
+    // Submission and completion queues of one io_uring instance; used by one thread at a time
+    class Ring {
+    public:
+        Ring() = default;
+        ~Ring();
+        Ring(const Ring&) = delete;
+        Ring& operator=(const Ring&) = delete;
+
+        // Create a ring of at least `entries` submission slots (rounded up to a power of two)
+        bool open(unsigned entries, std::string& error);
+
+        bool isOpen() const { return fd_ >= 0; }
+
+        // Unmap the queues and close the ring; the kernel cancels whatever is still in flight
+        void close();
+
+        // A zeroed submission entry, queued for the next submit(); submits the queue first when
+        // full, and returns nullptr if that submission fails
+        io_uring_sqe* next();
+
+        // Submit the queue now if fewer than `count` entries are free, so a linked chain of
+        // `count` entries is never split across two submissions; false if the kernel refused the
+        // submission and there is still no room
+        bool reserve(unsigned count);
+
+        // Hand the queued entries to the kernel and wait for at least `waitFor` completions;
+        // returns false (and errno) if the kernel refused them
+        bool submit(unsigned waitFor);
+
+        // Call handle(userData, result, flags) for every available completion; returns how many
+        template <typename Handler>
+        unsigned reap(Handler&& handle) {
+            unsigned count = 0;
+            unsigned head = *cqHead_;
+            const unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head, ++count) {
+                const io_uring_cqe& cqe = cqes_[head & cqMask_];
+                handle(cqe.user_data, cqe.res, cqe.flags);
+            }
+            __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+            return count;
+        }
+
+        // Pin `count` buffers for IORING_OP_READ_FIXED/WRITE_FIXED, addressed by index
+        bool registerBuffers(const iovec* buffers, unsigned count, std::string& error);
+
+        unsigned entries() const { return sqEntries_; }
+
+    private:
+        int fd_ = -1;
+        void* sqMap_ = nullptr;
+        std::size_t sqMapBytes_ = 0;
+        void* cqMap_ = nullptr; // Same mapping as sqMap_ with IORING_FEAT_SINGLE_MMAP
+        std::size_t cqMapBytes_ = 0;
+        io_uring_sqe* sqes_ = nullptr;
+        std::size_t sqesBytes_ = 0;
+        unsigned* sqHead_ = nullptr;
+        unsigned* sqTail_ = nullptr;
+        unsigned* sqArray_ = nullptr;
+        unsigned sqMask_ = 0;
+        unsigned sqEntries_ = 0;
+        unsigned* cqHead_ = nullptr;
+        unsigned* cqTail_ = nullptr;
+        io_uring_cqe* cqes_ = nullptr;
+        unsigned cqMask_ = 0;
+        unsigned tail_ = 0; // Local submission tail, published by submit()
+        unsigned queued_ = 0; // Entries queued since the last submit()
+    };
+
+    // One GET issued through an HttpClient
+    struct Request {
+        using Clock = std::chrono::steady_clock;
+
+        std::string_view target; // Path and query, kept alive by the caller until the request finishes
+        Buffers::Buffer* body = nullptr; // Receives the body (decoded if chunked)
+
+        // Filled in when the request finishes
+        int status = 0; // HTTP status, 0 if no response was received
+        std::string error; // Why no response was received
+        std::vector<std::pair<std::string_view, std::string_view>> headers; // Valid until the connection's next request
+        Clock::time_point socketReady; // Socket created (new connections only; the host is resolved once, in open())
+        Clock::time_point connected; // TCP connected (new connections only)
+        Clock::time_point headersReceived; // Status line and headers received
+    };
+
+    // HTTP/1.1 client for one http:// host with up to `connections` kept-alive connections, all
+    // driven from the calling thread through one ring
+    class HttpClient {
+    public:
+        HttpClient(std::string host, int port, std::size_t connections = 1);
+        ~HttpClient();
+        HttpClient(const HttpClient&) = delete;
+        HttpClient& operator=(const HttpClient&) = delete;
+
+        // Create the ring and resolve the host; false if either fails
+        bool open(std::string& error);
+
+        void setTimeouts(int connectSeconds, int readSeconds);
+
+        // Queue `request` on connection `connection` (which must be idle); nothing is sent until poll()
+        void start(std::size_t connection, Request& request);
+
+        // Submit everything queued, wait until at least one request finishes and append the
+        // connections whose request finished to `finished`
+        void poll(std::vector<std::size_t>& finished);
+
+        // Close an idle connection; its next request opens a new one
+        void disconnect(std::size_t connection);
+
+        // Run `count` requests concurrently, request i on connection i, and wait for all of them
+        void perform(Request* requests, std::size_t count);
+
+        std::size_t connections() const { return connections_.size(); }
+        std::size_t active() const { return active_; }
+
+    private:
+        enum class Op : std::uint8_t { Connect, Send, Receive, Timeout };
+        enum class BodyMode : std::uint8_t { Length, Chunked, UntilClose };
+
+        struct Connection {
+            int fd = -1;
+            Request* request = nullptr;
+            bool reused = false; // Kept alive from an earlier request, so a stale close may be retried once
+            std::string out; // Request text
+            std::size_t sent = 0;
+            Buffers::Buffer in; // Received bytes: headers, and the whole body when chunked
+            std::string head; // Status line and headers, which Request::headers point into
+            bool headersDone = false;
+            BodyMode mode = BodyMode::Length;
+            std::size_t remaining = 0; // Body bytes still expected in Length mode
+            std::size_t chunkCursor = 0; // Next undecoded byte of `in` in Chunked mode
+            bool keepAlive = true;
+            __kernel_timespec timeout{}; // Read by the kernel when the linked timeout is submitted
+        };
+
+        bool queueConnect(std::size_t index, std::string& error);
+        void queueSend(std::size_t index);
+        void queueReceive(std::size_t index);
+        void linkTimeout(std::size_t index, int seconds);
+        void handle(std::uint64_t userData, int result, std::vector<std::size_t>& finished);
+        void onReceived(std::size_t index, std::size_t length, std::vector<std::size_t>& finished);
+        int parseHeaders(Connection& connection); // 1 parsed, 0 incomplete, -1 malformed
+        bool decodeChunks(Connection& connection, bool& done);
+        void retryOrFail(std::size_t index, Op op, int result, std::vector<std::size_t>& finished);
+        void finish(std::size_t index, std::vector<std::size_t>& finished);
+        void fail(std::size_t index, std::string error, std::vector<std::size_t>& finished);
+        void closeSocket(Connection& connection);
+        static std::uint64_t tag(std::size_t index, Op op) { return (static_cast<std::uint64_t>(index) << 8) | static_cast<std::uint64_t>(op); }
+
+        std::string host_;
+        int port_;
+        std::string hostHeader_;
+        sockaddr_storage address_{};
+        unsigned addressLength_ = 0;
+        int connectTimeoutSeconds_ = 5;
+        int readTimeoutSeconds_ = 5;
+        Ring ring_;
+        std::vector<Connection> connections_;
+        std::vector<std::size_t> failedEarly_; // Requests that failed in start(), reported by the next poll()
+        std::vector<std::size_t> finished_; // Scratch for perform()
+        std::size_t active_ = 0;
+        bool broken_ = false; // The ring refused a submission; every request fails from then on
+    };
+
+    // Appends to one file through registered buffers; not thread-safe
+    class FileWriter {
+    public:
+        FileWriter() = default;
+        ~FileWriter();
+        FileWriter(const FileWriter&) = delete;
+        FileWriter& operator=(const FileWriter&) = delete;
+
+        // Open `path` for appending (after truncating it if asked) and set up the ring and buffers
+        bool open(const std::string& path, bool truncate, std::string& error);
+
+        // Copy bytes into the current buffer; full buffers are queued for writing. Does nothing
+        // once a submission has failed
+        void append(const char* data, std::size_t length);
+
+        // Write everything appended so far and wait for it; false if a write failed since the last flush
+        bool flush();
+
+        void close();
+
+    private:
+        struct Slot {
+            char* data = nullptr;
+            std::size_t filled = 0;
+            std::size_t written = 0; // Of `filled`, while in flight
+            std::uint64_t offset = 0; // File offset of data[0]
+            bool inFlight = false;
+        };
+
+        void queueWrite(std::size_t index);
+        void queueCurrent();
+        void waitForSlot();
+        void complete(std::size_t index, int result);
+
+        int fd_ = -1;
+        Ring ring_;
+        std::unique_ptr<char[]> block_; // Every slot's bytes, registered with the ring
+        std::vector<Slot> slots_;
+        std::size_t current_ = 0;
+        std::size_t inFlight_ = 0;
+        std::uint64_t offset_ = 0; // End of the file including queued writes
+        bool registered_ = false; // Plain writes when the kernel refuses to pin the buffers
+        bool failed_ = false;
+        bool dead_ = false; // The ring refused a submission; buffers may still be in use by the kernel, so appends are dropped
+    };
+
+} // namespace Uring
@@ -0,0 +1,100 @@
+/*
+ * Fetch check
+ * Fetches prices through Fetch::PriceFetcher from a running btc-mock-server, recording every
+ * response, and fails unless the fetch outcome and the recorded statuses match what the server
+ * was told to answer. Run by ctest through tests/with_mock_server.sh, in whichever HTTP backend
+ * the build uses (cpp-httplib, or io_uring with BTC_IO_URING).
+ *
+ * Usage: btc-fetch-check <base-url> <recording> [expected-status]
+ */
+
+#include <httplib.h> // For waiting until the server listens
+#include <chrono> // For the startup deadline
+#include <iostream> // For failure messages
+#include <string> // For arguments
+#include <thread> // For startup polling
+#include <vector> // For prices and exchanges
+
+#include "config.h" // For fetch settings
+#include "fetch.h" // For the fetcher under test
+#include "price.h" // For currency specs
+#include "replay.h" // For the recording
+#include "symbols.h" // For asset ids
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << "\n";
+            ++failures;
+        }
+    }
+
+    // Wait up to five seconds for the server to answer anything
+    bool waitForServer(const std::string& baseUrl) {
+        httplib::Client client(baseUrl);
+        client.set_connection_timeout(1);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (client.Get("/")) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        return false;
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <base-url> <recording> [expected-status]\n";
+        return 2;
+    }
+    const std::string baseUrl = argv[1];
+    const std::string recording = argv[2];
+    const int expectedStatus = argc > 3 ? std::stoi(argv[3]) : 200;
+    if (!waitForServer(baseUrl)) {
+        std::cerr << "FAILED: no server at " << baseUrl << "\n";
+        return 1;
+    }
+
+    Config::Settings config;
+    config.assets = { "bitcoin", "ethereum" };
+    config.assetIds = Symbols::intern(config.assets);
+    config.maxRetries = 2;
+    config.retryDelaySeconds = 0;
+    config.rateLimitDelaySeconds = 0;
+    const int fetches = 3; // The later ones reuse the kept-alive connection
+
+    {
+        Replay::Recorder recorder;
+        check(recorder.open(recording), "open " + recording);
+        Fetch::PriceFetcher fetcher(Fetch::Settings{ baseUrl, 1.0, &recorder });
+        const Pricing::CurrencySpec& usd = Pricing::currencySpec(config.currency);
+        std::vector<Pricing::Price> prices;
+        for (int i = 0; i < fetches; ++i) {
+            const bool fetched = fetcher.fetch(config, usd, prices);
+            if (expectedStatus == 200) {
+                check(fetched, "fetch " + std::to_string(i + 1) + " succeeds");
+                check(prices.size() == 2 && prices[0].valid() && prices[1].valid(), "fetch " + std::to_string(i + 1) + " returns both prices");
+            } else {
+                check(!fetched, "fetch " + std::to_string(i + 1) + " fails on HTTP " + std::to_string(expectedStatus));
+            }
+        }
+    }
+
+    // Every attempt got a response, so every attempt is recorded with the status the server sent
+    std::vector<Replay::Exchange> exchanges;
+    std::string error;
+    check(Replay::loadRecording(recording, exchanges, error), "load recording: " + error);
+    const std::size_t attempts = expectedStatus == 200 ? fetches : static_cast<std::size_t>(fetches * config.maxRetries);
+    check(exchanges.size() == attempts, "recorded " + std::to_string(exchanges.size()) + " exchanges, expected " + std::to_string(attempts));
+    for (const auto& exchange : exchanges) {
+        check(exchange.status == expectedStatus, "recorded status " + std::to_string(exchange.status));
+        check(expectedStatus != 200 || !exchange.body.empty(), "recorded body is empty");
+    }
+    return failures == 0 ? 0 : 1;
+}
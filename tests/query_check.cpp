@@ -0,0 +1,137 @@
+/*
+ * Query check
+ * Runs statements against a small TickStore whose blocks hold known, disjoint price ranges and
+ * fails unless the rows and the block pruning statistics match: parse errors, price literals
+ * with more decimals than the series scale, time literals, LAST, GROUP BY buckets that span
+ * blocks, and blocks that pass the index but are filtered down to no ticks. Run by ctest.
+ *
+ * Usage: btc-query-check
+ */
+
+#include <cstdint> // For timestamps and units
+#include <iostream> // For failure messages
+#include <string> // For statements
+#include <vector> // For ticks
+
+#include "query.h" // For the queries under test
+#include "symbols.h" // For the asset id
+#include "tickstore.h" // For the data
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << "\n";
+            ++failures;
+        }
+    }
+
+    // Tick i is at START_MS + i seconds with price 100 + i micro-units (scale 6), so blocks hold
+    // disjoint, increasing price ranges; three full blocks and a partial one
+    constexpr std::int64_t START_MS = 1699999200000; // 2023-11-14T22:00:00Z, on an hour boundary
+    constexpr std::int64_t BASE_UNITS = 100000000;
+    constexpr std::int64_t TICKS = 3 * static_cast<std::int64_t>(Ticks::BLOCK_TICKS) + 1588;
+    constexpr std::int64_t NOW_MS = START_MS + TICKS * 1000; // One second after the last tick
+
+    std::int64_t timeOf(std::int64_t i) { return START_MS + i * 1000; }
+
+    // Run `text` and check the number of rows, each row's count and the pruned blocks
+    Query::Result expect(const Ticks::TickStore& store, const std::string& text, const std::vector<std::int64_t>& counts, std::size_t pruned) {
+        Query::Statement statement;
+        Query::Result result;
+        std::string error;
+        if (!Query::parse(text, statement, error) || !Query::execute(statement, store, NOW_MS, result, error)) {
+            check(false, text + ": " + error);
+            return result;
+        }
+        check(result.rows.size() == counts.size(), text + ": " + std::to_string(result.rows.size()) + " rows, expected " + std::to_string(counts.size()));
+        for (std::size_t i = 0; i < counts.size() && i < result.rows.size(); ++i) {
+            check(result.rows[i].count == counts[i], text + ": row " + std::to_string(i) + " counts " + std::to_string(result.rows[i].count) + ", expected " + std::to_string(counts[i]));
+        }
+        check(result.stats.blocksPruned == pruned, text + ": pruned " + std::to_string(result.stats.blocksPruned) + " blocks, expected " + std::to_string(pruned));
+        return result;
+    }
+
+    void expectParseError(const std::string& text) {
+        Query::Statement statement;
+        std::string error;
+        check(!Query::parse(text, statement, error) && error.find("at position") != std::string::npos, text + ": parsed, or error without a position");
+    }
+
+} // namespace
+
+int main() {
+    const Symbols::Id asset = Symbols::intern("testcoin");
+    Ticks::TickStore store;
+    std::vector<Ticks::Tick> ticks;
+    for (std::int64_t i = 0; i < TICKS; ++i) {
+        ticks.push_back({ timeOf(i), BASE_UNITS + i });
+    }
+    store.insert(asset, 6, ticks);
+    const std::int64_t block = static_cast<std::int64_t>(Ticks::BLOCK_TICKS);
+
+    // Parser
+    expectParseError("SELECT median(price) FROM testcoin");
+    expectParseError("SELECT count(*) testcoin");
+    expectParseError("SELECT count(*) FROM testcoin LAST 0d");
+    expectParseError("SELECT count(*) FROM testcoin WHERE price > abc");
+    expectParseError("SELECT count(*) FROM testcoin WHERE time > '2023-13-01'");
+    expectParseError("SELECT count(*) FROM testcoin GROUP BY 1h GROUP BY 1m");
+    {
+        Query::Statement statement;
+        Query::Result result;
+        std::string error;
+        check(Query::parse("SELECT count(*) FROM nocoin", statement, error) && !Query::execute(statement, store, NOW_MS, result, error),
+              "unknown asset executed");
+    }
+
+    // Whole series, and block pruning on prices
+    expect(store, "SELECT count(*) FROM testcoin", { TICKS }, 0);
+    expect(store, "select COUNT(*) from testcoin where price >= 100.004096 and price < 100.008192", { block }, 3);
+
+    // Literals with more decimals than the scale compare against their exact value
+    expect(store, "SELECT count(*) FROM testcoin WHERE price > 100.0000005", { TICKS - 1 }, 0);
+    expect(store, "SELECT count(*) FROM testcoin WHERE price >= 100.0000005", { TICKS - 1 }, 0);
+    expect(store, "SELECT count(*) FROM testcoin WHERE price < 100.0000004", { 1 }, 3);
+    expect(store, "SELECT count(*) FROM testcoin WHERE price <= 100.0000014", { 2 }, 3);
+    expect(store, "SELECT count(*) FROM testcoin WHERE price = 100.0000005", { 0 }, 3);
+    expect(store, "SELECT count(*) FROM testcoin WHERE price = 100.000005", { 1 }, 3);
+    expect(store, "SELECT count(*) FROM testcoin WHERE price = 1.00000005e2", { 1 }, 3);
+    expect(store, "SELECT count(*) FROM testcoin WHERE price < 1.000000049e2", { 5 }, 3);
+    expect(store, "SELECT count(*) FROM testcoin WHERE price > -0.5", { TICKS }, 0);
+
+    // Time literals: quoted UTC dates and bare Unix milliseconds
+    expect(store, "SELECT count(*) FROM testcoin WHERE time >= '2023-11-14 23:00'", { TICKS - 3600 }, 0);
+    expect(store, "SELECT count(*) FROM testcoin WHERE time < '2023-11-14T22:30:00Z'", { 1800 }, 3);
+    expect(store, "SELECT count(*) FROM testcoin WHERE time = " + std::to_string(timeOf(5000)), { 1 }, 3);
+    expect(store, "SELECT count(*) FROM testcoin WHERE time > " + std::to_string(timeOf(TICKS - 1)), { 0 }, 4);
+
+    // LAST is relative to the execution time
+    expect(store, "SELECT count(*) FROM testcoin LAST 100s", { 100 }, 3);
+
+    // Hourly buckets; the last three each cross a block boundary (ticks 4096, 8192 and 12288)
+    const Query::Result hourly = expect(store, "SELECT first(price), last(price), min(price), max(price), sum(price) FROM testcoin GROUP BY 1h",
+                                        { 3600, 3600, 3600, TICKS - 3 * 3600 }, 0);
+    if (hourly.rows.size() == 4) {
+        const Query::Row& row = hourly.rows[1];
+        check(row.bucketMs == timeOf(3600), "second bucket starts at " + std::to_string(row.bucketMs));
+        check(row.first == BASE_UNITS + 3600 && row.last == BASE_UNITS + 7199, "second bucket first/last");
+        check(row.min == BASE_UNITS + 3600 && row.max == BASE_UNITS + 7199, "second bucket min/max");
+        check(row.sum == 3600 * BASE_UNITS + (3600 + 7199) * 3600 / 2, "second bucket sum");
+    }
+
+    // Blocks that pass the index but lose every tick to the filter: the first block overlaps both
+    // the time range and the price range, but no tick is in both
+    expect(store, "SELECT count(*) FROM testcoin WHERE time < " + std::to_string(timeOf(100)) + " AND price >= 100.004", { 0 }, 3);
+    expect(store, "SELECT count(*) FROM testcoin WHERE time < " + std::to_string(timeOf(100)) + " AND price >= 100.004 GROUP BY 1m", {}, 3);
+    expect(store, "SELECT count(*) FROM testcoin WHERE price >= 100.00409 AND time >= " + std::to_string(timeOf(3990)) + " AND time < " +
+                      std::to_string(timeOf(4090)) + " GROUP BY 1m",
+           {}, 3);
+    // A bucket spanning two blocks, filtered in the first and whole in the second
+    expect(store, "SELECT count(*) FROM testcoin WHERE price >= 100.00405 AND time >= " + std::to_string(timeOf(4000)) + " AND time < " +
+                      std::to_string(timeOf(4200)) + " GROUP BY 1h",
+           { 150 }, 2);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+/*
+ * Scan check
+ * Builds the structural index of hand-picked and randomized texts with every block classifier
+ * this build and CPU can run (AVX2, SSE2 and the portable table) and fails unless each matches
+ * a byte-by-byte reference: structural characters outside strings, both quotes of every string,
+ * the first character of every scalar, and whether the text ends inside a string. The cases cover
+ * escaped quotes, backslash runs ending on and crossing 64-byte block boundaries, and strings
+ * spanning several blocks. Run by ctest.
+ *
+ * Usage: btc-scan-check [random-texts]
+ */
+
+#include <cstdint> // For positions
+#include <iostream> // For failure messages
+#include <random> // For randomized texts
+#include <string> // For texts
+#include <string_view> // For the reference scanner
+#include <vector> // For positions
+
+#include "scan.h" // For the index under test
+
+namespace {
+
+    int failures = 0;
+
+    bool isOp(char c) {
+        return c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',';
+    }
+
+    bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    // One character at a time: an unescaped backslash escapes the next character (inside strings
+    // or not), and an escaped quote is an ordinary character
+    bool referenceIndex(std::string_view json, std::vector<std::uint32_t>& positions) {
+        positions.clear();
+        bool inString = false;
+        bool escapeNext = false;
+        bool inScalar = false;
+        for (std::size_t i = 0; i < json.size(); ++i) {
+            const char c = json[i];
+            const bool escaped = escapeNext;
+            escapeNext = !escaped && c == '\\';
+            if (c == '"' && !escaped) {
+                positions.push_back(static_cast<std::uint32_t>(i));
+                inString = !inString;
+                inScalar = false;
+            } else if (inString) {
+                inScalar = false;
+            } else if (isOp(c)) {
+                positions.push_back(static_cast<std::uint32_t>(i));
+                inScalar = false;
+            } else if (isSpace(c)) {
+                inScalar = false;
+            } else {
+                if (!inScalar) {
+                    positions.push_back(static_cast<std::uint32_t>(i));
+                }
+                inScalar = true;
+            }
+        }
+        return !inString;
+    }
+
+    void checkText(const std::string& json, const std::string& label) {
+        std::vector<std::uint32_t> expected;
+        const bool expectedOk = referenceIndex(json, expected);
+        Scan::StructuralIndex index;
+        for (const char* backend : Scan::backends()) {
+            const bool ok = index.build(json, backend);
+            if (ok != expectedOk || index.positions() != expected) {
+                std::cerr << "FAILED: " << backend << " on " << label << " (" << json.size() << " bytes): "
+                          << index.positions().size() << " positions, expected " << expected.size()
+                          << (ok != expectedOk ? ", wrong end-of-text state" : "") << "\n";
+                ++failures;
+            }
+        }
+    }
+
+    // Texts that put the interesting byte at every offset around the first block boundary
+    void checkBoundaries() {
+        for (int offset = 40; offset < 80; ++offset) {
+            const std::string pad(static_cast<std::size_t>(offset), ' ');
+            for (int run = 1; run <= 5; ++run) {
+                // A backslash run ending just before a quote: even runs leave the quote unescaped
+                const std::string slashes(static_cast<std::size_t>(run), '\\');
+                checkText("{\"a\":\"" + pad + slashes + "\"x\",\"b\":1}", "backslash run " + std::to_string(run) + " at " + std::to_string(offset));
+                // The same run outside a string, where it is part of a scalar
+                checkText("[" + pad + "1" + slashes + "\"2\",3]", "bare backslash run " + std::to_string(run) + " at " + std::to_string(offset));
+            }
+            checkText("{\"k\":\"" + pad + "\\\"{[:,]}\\\"\"," + pad + "\"n\":-1.5e3}", "escaped quotes at " + std::to_string(offset));
+            checkText("[" + pad + "true,false,null," + pad + "123]", "scalars at " + std::to_string(offset));
+        }
+        // One string spanning several blocks, with structural characters inside it
+        std::string longString = "{\"s\":\"";
+        for (int i = 0; i < 300; ++i) {
+            longString += "{[:,]} \\\\\\\""[i % 11]; // Escaped quotes only
+        }
+        checkText(longString + "\",\"t\":2}", "string spanning blocks");
+        checkText(longString, "text ending inside a string");
+        checkText(std::string(128, '\\') + "\"", "backslashes filling two blocks");
+        checkText(std::string(127, '\\') + "\"\"", "odd backslash run filling two blocks");
+        checkText("", "empty text");
+        checkText("{\"bitcoin\":{\"usd\":67187.12},\"ethereum\":{\"usd\":3521.5}}", "simple price body");
+    }
+
+    // Random texts over an alphabet weighted toward quotes and backslashes
+    void checkRandom(int count) {
+        static constexpr char ALPHABET[] = "\"\"\"\\\\\\{}[]:,  \t\nab1-.e";
+        std::mt19937 random(20240611);
+        std::uniform_int_distribution<std::size_t> length(0, 400);
+        std::uniform_int_distribution<std::size_t> pick(0, sizeof(ALPHABET) - 2);
+        std::string json;
+        for (int i = 0; i < count; ++i) {
+            json.resize(length(random));
+            for (char& c : json) {
+                c = ALPHABET[pick(random)];
+            }
+            checkText(json, "random text " + std::to_string(i));
+        }
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int randomTexts = argc > 1 ? std::stoi(argv[1]) : 20000;
+    std::cout << "Backends:";
+    for (const char* backend : Scan::backends()) {
+        std::cout << " " << backend;
+    }
+    std::cout << "\n";
+    checkBoundaries();
+    checkRandom(randomTexts);
+    return failures == 0 ? 0 : 1;
+}
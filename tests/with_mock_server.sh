@@ -0,0 +1,17 @@
+#!/bin/sh
+# Run a command while btc-mock-server listens on a port, then stop the server
+# Usage: with_mock_server.sh <btc-mock-server> <port> [server options...] -- <command> [arguments...]
+server=$1
+port=$2
+shift 2
+options=""
+while [ $# -gt 0 ] && [ "$1" != "--" ]; do
+    options="$options $1"
+    shift
+done
+shift
+# shellcheck disable=SC2086 # Options are split on purpose
+"$server" --port "$port" $options >/dev/null 2>&1 &
+pid=$!
+trap 'kill $pid 2>/dev/null' EXIT INT TERM
+"$@"
@@ -0,0 +1,295 @@
+/*
+ * Stage Benchmark
+ * Runs the tracker's stages in isolation on synthetic data, without a network or a
+ * terminal: parsing a /simple/price body, ingesting prices into the engine (candles,
+ * recent ticks, tick store), rendering a dashboard frame, querying the history, and
+ * a whole update with its scratch memory in a tick arena. Reports the latency
+ * percentiles of each stage per operation and the heap allocations it made; --check
+ * turns the tick stage's steady-state allocations into a pass/fail budget.
+ *
+ * License: MIT License
+ */
+
+#include <algorithm> // For std::max
+#include <atomic> // For the allocation counter
+#include <chrono> // For timing
+#include <cstdint> // For fixed-width integers
+#include <cstdlib> // For std::malloc and std::free
+#include <iomanip> // For formatted output
+#include <iostream> // For console output
+#include <new> // For the replaced allocation functions
+#include <string> // For bodies and frames
+#include <vector> // For asset lists and prices
+
+#include "arena.h" // For the tick stage's scratch memory
+#include "colors.h" // For status line colors
+#include "dashboard.h" // For the render stage
+#include "metrics.h" // For latency histograms
+#include "price.h" // For the parse stage
+#include "query.h" // For the query stage
+#include "schema.h" // For the parse stage's asset keys
+#include "symbols.h" // For the ingest stage's asset ids
+#include "timefmt.h" // For the tick stage's status line
+#include "tracker.h" // For the ingest stage
+
+// Command-line options
+struct Options {
+    int assets = 10; // Assets per update
+    int updates = 20000; // Updates per stage
+    std::string only; // Run a single stage ("parse", "ingest", "render", "query" or "tick")
+    bool check = false; // Fail when the tick stage exceeds TICK_ALLOCATION_BUDGET
+};
+
+// Heap allocations allowed per asset in a steady-state update (tick stage, second half of the run)
+// What remains is node churn of the engine's bounded deques: 1-second candle bars (~1/6 per
+// asset) and recent ticks (~1/32 per asset), plus the tick store's amortized chunk growth.
+constexpr double TICK_ALLOCATION_BUDGET = 0.25;
+
+// Global heap allocations so far, counted by the replaced operator new below
+std::atomic<std::uint64_t> heapAllocations{ 0 };
+
+void* operator new(std::size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size > 0 ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    const auto align = static_cast<std::size_t>(alignment);
+    if (void* pointer = std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+
+// Function to print command-line usage
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --assets <n>                Assets per update (default 10)\n"
+              << "  --updates <n>               Updates per stage (default 20000)\n"
+              << "  --stage <name>              Run only parse, ingest, render, query or tick\n"
+              << "  --check                     Exit with status 2 if a steady-state tick allocates over budget\n"
+              << "                              (runs the tick stage, so --stage must be omitted or tick)\n";
+}
+
+// Function to parse command-line arguments; returns false if they are invalid
+bool parseArguments(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--assets" && hasValue) {
+                options.assets = std::stoi(argv[++i]);
+            } else if (arg == "--updates" && hasValue) {
+                options.updates = std::stoi(argv[++i]);
+            } else if (arg == "--stage" && hasValue) {
+                options.only = argv[++i];
+            } else if (arg == "--check") {
+                options.check = true;
+            } else {
+                return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return options.assets > 0 && options.updates > 0 &&
+           (options.only.empty() || options.only == "parse" || options.only == "ingest" || options.only == "render" || options.only == "query" ||
+            options.only == "tick") &&
+           (!options.check || options.only.empty() || options.only == "tick"); // --check measures the tick stage
+}
+
+// Deterministic price walk, in micro-dollars
+std::int64_t syntheticUnits(int update, int asset) {
+    const std::int64_t base = 100000000000LL / (asset + 1);
+    return base + ((update * 7919LL + asset * 104729LL) % 2000001 - 1000000) * 1000;
+}
+
+// Function to print one latency line with percentiles in nanoseconds and heap allocations per operation
+void printLatency(const char* label, const Metrics::Histogram& histogram, double seconds, long long operations, std::uint64_t allocations) {
+    std::cout << std::left << std::setw(8) << label << std::right << std::fixed << std::setprecision(0)
+              << " p50 " << std::setw(9) << static_cast<double>(histogram.quantile(0.50)) << " ns"
+              << "  p99 " << std::setw(9) << static_cast<double>(histogram.quantile(0.99)) << " ns"
+              << "  max " << std::setw(10) << static_cast<double>(histogram.quantile(1.0)) << " ns"
+              << "  " << std::setprecision(1) << std::setw(12) << static_cast<double>(operations) / seconds << " ops/s"
+              << "  " << std::setprecision(3) << std::setw(8) << static_cast<double>(allocations) / operations << " allocs/op\n";
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    using Clock = std::chrono::steady_clock;
+    const Pricing::CurrencySpec& usd = Pricing::currencySpec("usd");
+    std::vector<std::string> assets;
+    for (int a = 0; a < options.assets; ++a) {
+        assets.push_back(a == 0 ? "bitcoin" : "asset-" + std::to_string(a));
+    }
+    const std::vector<Symbols::Id> assetIds = Symbols::intern(assets);
+    auto run = [&](const char* name) { return options.only.empty() || options.only == name; };
+
+    // Parse: one multi-asset body per update, as returned by /simple/price
+    if (run("parse")) {
+        std::vector<std::string> bodies;
+        for (int u = 0; u < 64; ++u) {
+            std::string body = "{";
+            for (int a = 0; a < options.assets; ++a) {
+                char price[Pricing::MAX_PRICE_CHARS];
+                const std::size_t length = Pricing::formatPrice(price, sizeof(price), Pricing::Price{ syntheticUnits(u, a), usd.scale }, 2, '\0');
+                body += (a > 0 ? ",\"" : "\"") + assets[static_cast<std::size_t>(a)] + "\":{\"usd\":" + std::string(price, length) + "}";
+            }
+            bodies.push_back(body + "}");
+        }
+        const Schema::KeySet assetKeys(assets);
+        Metrics::Histogram histogram;
+        std::vector<Pricing::Price> prices;
+        std::string error;
+        const std::uint64_t allocationsBefore = heapAllocations.load();
+        const auto start = Clock::now();
+        for (int u = 0; u < options.updates; ++u) {
+            const auto begin = Clock::now();
+            if (Pricing::extractSimplePrices(bodies[static_cast<std::size_t>(u) % bodies.size()], assetKeys, usd, prices, error) != Pricing::ExtractResult::Ok) {
+                std::cerr << "parse failed: " << error << "\n";
+                return 1;
+            }
+            histogram.record(Clock::now() - begin);
+        }
+        printLatency("parse", histogram, std::chrono::duration<double>(Clock::now() - start).count(), options.updates, heapAllocations.load() - allocationsBefore);
+    }
+
+    // Ingest: every asset's price into candles, recent ticks and the tick store, one second apart
+    Tracker::Engine engine("usd");
+    const std::int64_t startMs = 1700000000000LL;
+    if (run("ingest") || run("query")) {
+        Metrics::Histogram histogram;
+        const std::uint64_t allocationsBefore = heapAllocations.load();
+        const auto start = Clock::now();
+        for (int u = 0; u < options.updates; ++u) {
+            const auto begin = Clock::now();
+            for (int a = 0; a < options.assets; ++a) {
+                engine.ingest(assetIds[static_cast<std::size_t>(a)], startMs + u * 1000LL, Pricing::Price{ syntheticUnits(u, a), usd.scale });
+            }
+            histogram.record(Clock::now() - begin);
+        }
+        if (run("ingest")) {
+            printLatency("ingest", histogram, std::chrono::duration<double>(Clock::now() - start).count(), options.updates, heapAllocations.load() - allocationsBefore);
+        }
+    }
+
+    // Render: update every panel, then build the frame of escape sequences
+    if (run("render")) {
+        Dashboard::Screen screen("Bitcoin Price Tracker");
+        screen.setAssets(assets);
+        Metrics::Histogram histogram;
+        std::string frame;
+        const std::uint64_t allocationsBefore = heapAllocations.load();
+        const auto start = Clock::now();
+        for (int u = 0; u < options.updates; ++u) {
+            const auto begin = Clock::now();
+            for (int a = 0; a < options.assets; ++a) {
+                const Pricing::Price price{ syntheticUnits(u, a), usd.scale };
+                screen.updatePanel(static_cast<std::size_t>(a), price, Pricing::displayPrice(price, usd));
+            }
+            screen.plotBar(startMs + u * 60000LL, Pricing::Price{ syntheticUnits(u, 0), usd.scale }.toDouble()); // One bar per update
+            frame.clear();
+            screen.render(frame);
+            histogram.record(Clock::now() - begin);
+        }
+        printLatency("render", histogram, std::chrono::duration<double>(Clock::now() - start).count(), options.updates, heapAllocations.load() - allocationsBefore);
+    }
+
+    // Tick: one whole update as the tracker runs it, minus the network: parse, ingest, panels,
+    // status lines and the frame, with per-update text in a tick arena released at the end
+    if (run("tick")) {
+        Tracker::Engine tickEngine("usd");
+        Dashboard::Screen screen("Bitcoin Price Tracker");
+        screen.setAssets(assets);
+        const std::string body = [&] {
+            std::string text = "{";
+            for (int a = 0; a < options.assets; ++a) {
+                text += (a > 0 ? ",\"" : "\"") + assets[static_cast<std::size_t>(a)] + "\":{\"usd\":" + std::to_string(syntheticUnits(0, a) / 1000000) + ".5}";
+            }
+            return text + "}";
+        }();
+        const Schema::KeySet assetKeys(assets);
+        Arena::TickArena tickArena;
+        Metrics::Histogram histogram;
+        std::vector<Pricing::Price> prices;
+        std::string error;
+        std::string frame;
+        const int warmup = options.updates / 2; // Fills the bounded histories and grows the arena
+        std::uint64_t steadyBefore = 0;
+        const std::uint64_t allocationsBefore = heapAllocations.load();
+        const auto start = Clock::now();
+        for (int u = 0; u < options.updates; ++u) {
+            if (u == warmup) {
+                steadyBefore = heapAllocations.load();
+            }
+            const auto begin = Clock::now();
+            {
+                Arena::TickScope tickScope(tickArena);
+                if (Pricing::extractSimplePrices(body, assetKeys, usd, prices, error) != Pricing::ExtractResult::Ok) {
+                    std::cerr << "tick failed: " << error << "\n";
+                    return 1;
+                }
+                for (int a = 0; a < options.assets; ++a) {
+                    const auto index = static_cast<std::size_t>(a);
+                    tickEngine.ingest(assetIds[index], startMs + u * 1000LL, prices[index]);
+                    screen.updatePanel(index, prices[index], Pricing::displayPrice(prices[index], usd));
+                }
+                if (const Candles::Candle* bar = tickEngine.find(assetIds[0])->aggregator.current(Candles::Resolution::OneMinute)) {
+                    screen.plotBar(bar->openTime, bar->close.toDouble()); // The chart at the default 60 s poll interval
+                }
+                screen.setStatus(0, Dashboard::formatLine("Last Updated:", TimeFormat::localUS().view()), Colors::CYAN);
+                Arena::String nextUpdate("Next update in ");
+                nextUpdate += std::to_string(u % 60);
+                nextUpdate += " seconds...";
+                screen.setStatus(2, nextUpdate, Colors::YELLOW);
+                frame.clear();
+                screen.render(frame);
+            }
+            histogram.record(Clock::now() - begin);
+        }
+        printLatency("tick", histogram, std::chrono::duration<double>(Clock::now() - start).count(), options.updates, heapAllocations.load() - allocationsBefore);
+        const double steady = static_cast<double>(heapAllocations.load() - steadyBefore) / (options.updates - warmup);
+        const double budget = TICK_ALLOCATION_BUDGET * options.assets;
+        std::cout << "steady-state tick: " << std::setprecision(3) << steady << " allocs/update (budget " << budget << ")\n";
+        if (options.check && steady > budget) {
+            std::cerr << "tick allocations over budget\n";
+            return 2;
+        }
+    }
+
+    // Query: hourly aggregates over the last quarter of the ingested history
+    if (run("query")) {
+        Query::Statement statement;
+        std::string error;
+        Query::parse("SELECT avg(price), min(price), max(price), count(*) FROM bitcoin LAST " + std::to_string(options.updates / 4 + 1) + "s GROUP BY 1h",
+                     statement, error);
+        Metrics::Histogram histogram;
+        Query::Result result;
+        const int queries = std::max(1, options.updates / 100);
+        const std::uint64_t allocationsBefore = heapAllocations.load();
+        const auto start = Clock::now();
+        for (int q = 0; q < queries; ++q) {
+            const auto begin = Clock::now();
+            if (!Query::execute(statement, engine.ticks(), startMs + options.updates * 1000LL, result, error)) {
+                std::cerr << "query failed: " << error << "\n";
+                return 1;
+            }
+            histogram.record(Clock::now() - begin);
+        }
+        printLatency("query", histogram, std::chrono::duration<double>(Clock::now() - start).count(), queries, heapAllocations.load() - allocationsBefore);
+    }
+    return 0;
+}
@@ -0,0 +1,289 @@
+/*
+ * Load Generator
+ * Drives the fetch and parse path against a CoinGecko-compatible server (normally
+ * btc-mock-server) from several threads and reports sustained throughput and latency
+ * percentiles for the fetch and parse stages. With --uring (builds with BTC_IO_URING) one
+ * thread drives every connection through a single io_uring instead.
+ *
+ * License: MIT License
+ */
+
+#include <httplib.h> // For HTTP requests
+#include "json.h" // For /coins/markets parsing
+#include <atomic> // For shared counters
+#include <chrono> // For timing
+#include <iomanip> // For formatted output
+#include <iostream> // For console output
+#include <string> // For URLs
+#include <string_view> // For response bodies
+#include <thread> // For worker threads
+#include <vector> // For worker threads
+
+#include "buffers.h" // For pooled response bodies, as in the tracker
+#include "metrics.h" // For latency histograms
+#include "price.h" // For the tracker's price extraction
+#include "schema.h" // For the endpoint targets
+#if BTC_IO_URING
+#include "uring.h" // For --uring
+#endif
+
+// Command-line options
+struct Options {
+    std::string url = "http://127.0.0.1:8089";
+    int threads = 4;
+    int durationSeconds = 10;
+    int assets = 1; // Asset ids per /simple/price request
+    std::string endpoint = "simple"; // "simple" or "markets"
+    int perPage = 100; // Entries per /coins/markets request
+    bool uring = false; // One thread and one io_uring for all connections
+};
+
+// Totals shared by all workers
+struct Results {
+    Metrics::Histogram fetch; // Request sent to body received
+    Metrics::Histogram parse; // Body to extracted prices
+    std::atomic<unsigned long long> ok{ 0 };
+    std::atomic<unsigned long long> ticks{ 0 }; // Prices extracted
+    std::atomic<unsigned long long> rateLimited{ 0 };
+    std::atomic<unsigned long long> httpErrors{ 0 };
+    std::atomic<unsigned long long> connectErrors{ 0 };
+    std::atomic<unsigned long long> parseErrors{ 0 };
+    std::atomic<unsigned long long> bytes{ 0 };
+};
+
+// Function to print command-line usage
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --url <base>                Server base URL (default http://127.0.0.1:8089)\n"
+              << "  --threads <n>               Concurrent connections (default 4)\n"
+              << "  --duration <s>              Test duration in seconds (default 10)\n"
+              << "  --endpoint simple|markets   Endpoint to drive (default simple)\n"
+              << "  --assets <n>                Asset ids per /simple/price request (default 1)\n"
+              << "  --per-page <n>              Entries per /coins/markets request (default 100)\n"
+              << "  --uring                     Drive the connections from one thread through io_uring\n";
+}
+
+// Function to parse command-line arguments; returns false if they are invalid
+bool parseArguments(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--url" && hasValue) {
+                options.url = argv[++i];
+            } else if (arg == "--threads" && hasValue) {
+                options.threads = std::stoi(argv[++i]);
+            } else if (arg == "--duration" && hasValue) {
+                options.durationSeconds = std::stoi(argv[++i]);
+            } else if (arg == "--endpoint" && hasValue) {
+                options.endpoint = argv[++i];
+            } else if (arg == "--assets" && hasValue) {
+                options.assets = std::stoi(argv[++i]);
+            } else if (arg == "--per-page" && hasValue) {
+                options.perPage = std::stoi(argv[++i]);
+            } else if (arg == "--uring") {
+                options.uring = true;
+            } else {
+                return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return options.threads > 0 && options.durationSeconds > 0 && options.assets > 0 && options.perPage > 0
+           && (options.endpoint == "simple" || options.endpoint == "markets");
+}
+
+// Asset ids requested from /simple/price: "bitcoin", "asset-1", "asset-2", ...
+std::vector<std::string> assetIds(const Options& options) {
+    std::vector<std::string> ids{ "bitcoin" };
+    for (int i = 1; i < options.assets; ++i) {
+        ids.push_back("asset-" + std::to_string(i));
+    }
+    return ids;
+}
+
+// Function to build the request target for the chosen endpoint
+std::string buildTarget(const Options& options) {
+    if (options.endpoint == "markets") {
+        return Schema::CoinsMarkets::target("usd", options.perPage, 1);
+    }
+    std::string ids;
+    for (const auto& id : assetIds(options)) {
+        ids += (ids.empty() ? "" : ",") + id;
+    }
+    return Schema::SimplePrice::target(ids, "usd");
+}
+
+// Per-worker parse state, built once like the tracker's fetcher
+struct Parser {
+    Schema::KeySet assets; // Every requested id
+    std::vector<Pricing::Price> prices; // Reused across responses
+    std::string error;
+};
+
+// Function to extract prices from a body the same way the tracker does; returns the count or -1
+long long parseBody(const Options& options, std::string_view body, const Pricing::CurrencySpec& usd, Parser& parser) {
+    if (options.endpoint == "markets") {
+        const auto markets = nlohmann::json::parse(body, nullptr, false);
+        if (!markets.is_array()) {
+            return -1;
+        }
+        long long count = 0;
+        for (const auto& market : markets) {
+            count += Pricing::priceFromDouble(market.value("current_price", -1.0), usd.scale).valid() ? 1 : 0;
+        }
+        return count;
+    }
+    if (Pricing::extractSimplePrices(body, parser.assets, usd, parser.prices, parser.error) != Pricing::ExtractResult::Ok) {
+        return -1;
+    }
+    long long count = 0;
+    for (const auto& price : parser.prices) {
+        count += price.valid() ? 1 : 0;
+    }
+    return count;
+}
+
+// Function to count one response (status 0 for a connection failure) and time its parse
+void recordResponse(const Options& options, int status, const Buffers::Buffer& body, std::chrono::steady_clock::time_point start,
+                    const Pricing::CurrencySpec& usd, Parser& parser, Results& results) {
+    const auto fetched = std::chrono::steady_clock::now();
+    if (status == 0) {
+        ++results.connectErrors;
+        return;
+    }
+    results.fetch.record(fetched - start);
+    results.bytes += body.size();
+    if (status != 200) {
+        ++(status == 429 ? results.rateLimited : results.httpErrors);
+        return;
+    }
+    const long long extracted = parseBody(options, body.view(), usd, parser);
+    results.parse.record(std::chrono::steady_clock::now() - fetched);
+    if (extracted < 0) {
+        ++results.parseErrors;
+        return;
+    }
+    ++results.ok;
+    results.ticks += static_cast<unsigned long long>(extracted);
+}
+
+// Worker loop: one keep-alive connection issuing requests back to back until the deadline
+void runWorker(const Options& options, const std::string& target, std::chrono::steady_clock::time_point deadline, Results& results) {
+    httplib::Client client(options.url);
+    client.set_connection_timeout(5);
+    client.set_read_timeout(5);
+    client.set_keep_alive(true);
+    client.set_tcp_nodelay(true); // Avoid Nagle/delayed-ACK stalls skewing latency
+    const Pricing::CurrencySpec& usd = Pricing::currencySpec("usd");
+    Parser parser{ Schema::KeySet(assetIds(options)), {}, {} };
+    while (std::chrono::steady_clock::now() < deadline) {
+        const auto start = std::chrono::steady_clock::now();
+        Buffers::BufferPool::Lease body = Buffers::responsePool().acquire();
+        auto res = client.Get(target, [&body](const char* data, size_t length) {
+            body->append(data, length);
+            return true;
+        });
+        recordResponse(options, res ? res->status : 0, *body, start, usd, parser, results);
+    }
+}
+
+#if BTC_IO_URING
+// io_uring loop: every connection on one ring, each reissuing its request as soon as it finishes
+void runUringWorker(const Options& options, const std::string& target, std::chrono::steady_clock::time_point deadline, Results& results) {
+    std::string host;
+    int port = 0;
+    if (!Uring::parseHttpUrl(options.url, host, port)) {
+        std::cerr << "--uring needs an http://host[:port] URL\n";
+        return;
+    }
+    const auto connections = static_cast<std::size_t>(options.threads);
+    Uring::HttpClient client(host, port, connections);
+    std::string error;
+    if (!client.open(error)) {
+        std::cerr << "io_uring: " << error << "\n";
+        return;
+    }
+    const Pricing::CurrencySpec& usd = Pricing::currencySpec("usd");
+    Parser parser{ Schema::KeySet(assetIds(options)), {}, {} };
+    std::vector<Uring::Request> requests(connections);
+    std::vector<Buffers::BufferPool::Lease> bodies;
+    bodies.reserve(connections); // Requests point at the leased buffers
+    std::vector<std::chrono::steady_clock::time_point> starts(connections);
+    for (std::size_t i = 0; i < connections; ++i) {
+        bodies.push_back(Buffers::responsePool().acquire());
+        requests[i].target = target;
+        requests[i].body = &*bodies[i];
+        starts[i] = std::chrono::steady_clock::now();
+        client.start(i, requests[i]);
+    }
+    std::vector<std::size_t> finished;
+    while (client.active() > 0) {
+        finished.clear();
+        client.poll(finished);
+        for (std::size_t i : finished) {
+            recordResponse(options, requests[i].status, *bodies[i], starts[i], usd, parser, results);
+            bodies[i]->clear();
+            if (std::chrono::steady_clock::now() < deadline) {
+                starts[i] = std::chrono::steady_clock::now();
+                client.start(i, requests[i]);
+            } else {
+                client.disconnect(i); // Frees the server worker for connections still waiting
+            }
+        }
+    }
+}
+#endif
+
+// Function to print one latency line with percentiles in microseconds
+void printLatency(const char* label, const Metrics::Histogram& histogram) {
+    auto us = [&histogram](double q) { return static_cast<double>(histogram.quantile(q)) / 1000.0; };
+    std::cout << std::left << std::setw(8) << label << std::right << std::fixed << std::setprecision(1)
+              << " p50 " << std::setw(9) << us(0.50) << " us"
+              << "  p90 " << std::setw(9) << us(0.90) << " us"
+              << "  p99 " << std::setw(9) << us(0.99) << " us"
+              << "  p99.9 " << std::setw(9) << us(0.999) << " us"
+              << "  max " << std::setw(9) << us(1.0) << " us\n";
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const std::string target = buildTarget(options);
+    Results results;
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + std::chrono::seconds(options.durationSeconds);
+    std::vector<std::thread> workers;
+    if (options.uring) {
+#if BTC_IO_URING
+        workers.emplace_back(runUringWorker, std::cref(options), std::cref(target), deadline, std::ref(results));
+#else
+        std::cerr << "--uring: this build has no io_uring support (configure with -DBTC_IO_URING=ON)\n";
+        return 1;
+#endif
+    }
+    for (int i = 0; !options.uring && i < options.threads; ++i) {
+        workers.emplace_back(runWorker, std::cref(options), std::cref(target), deadline, std::ref(results));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Target:       " << options.url << target << "\n"
+              << "Threads:      " << options.threads << (options.uring ? " connections on io_uring" : "") << ", duration " << std::fixed << std::setprecision(2) << elapsed << " s\n"
+              << "Responses:    " << results.ok << " ok, " << results.rateLimited << " rate limited, "
+              << results.httpErrors << " HTTP errors, " << results.connectErrors << " connect errors, "
+              << results.parseErrors << " parse errors\n"
+              << "Throughput:   " << std::setprecision(1) << static_cast<double>(results.ok) / elapsed << " req/s, "
+              << static_cast<double>(results.ticks) / elapsed << " ticks/s, "
+              << static_cast<double>(results.bytes) / elapsed / (1024.0 * 1024.0) << " MiB/s\n";
+    printLatency("fetch", results.fetch);
+    printLatency("parse", results.parse);
+    return 0;
+}
@@ -0,0 +1,300 @@
+/*
+ * CoinGecko Mock Server
+ * Stand-in for the parts of the CoinGecko API the tracker uses, for throughput testing.
+ * Serves /api/v3/simple/price, /api/v3/coins/markets and /api/v3/coins/{id}/market_chart/range
+ * with configurable latency, error and rate-limit injection, and payload size.
+ *
+ * License: MIT License
+ */
+
+#include <httplib.h> // For the HTTP server
+#include <atomic> // For request counters
+#include <chrono> // For latency injection
+#include <cstdint> // For range timestamps
+#include <cmath> // For the latency distributions
+#include <csignal> // For Ctrl+C handling
+#include <iostream> // For console output
+#include <random> // For latency, errors and prices
+#include <sstream> // For splitting query lists
+#include <string> // For payload building
+#include <thread> // For sleep functionality
+#include <vector> // For id lists
+
+// Latency distribution applied before every response
+struct LatencyModel {
+    enum class Kind { Fixed, Uniform, LogNormal } kind = Kind::Fixed;
+    double a = 0.0; // Fixed: ms; Uniform: min ms; LogNormal: median ms
+    double b = 0.0; // Uniform: max ms; LogNormal: sigma
+
+    double sampleMs(std::mt19937_64& rng) const {
+        switch (kind) {
+            case Kind::Fixed: return a;
+            case Kind::Uniform: return std::uniform_real_distribution<double>(a, b)(rng);
+            case Kind::LogNormal: return std::lognormal_distribution<double>(std::log(a > 0.0 ? a : 1e-3), b)(rng);
+        }
+        return 0.0;
+    }
+};
+
+// Command-line options
+struct Options {
+    std::string address = "127.0.0.1";
+    int port = 8089;
+    LatencyModel latency;
+    double errorRate = 0.0; // Probability of answering 500
+    double rateLimitRate = 0.0; // Probability of answering 429
+    int marketsCount = 100; // Default per_page for /coins/markets
+    int padBytes = 0; // Extra description bytes per market entry
+    int threads = 8; // Server worker threads
+};
+
+// Global flag to stop the server on Ctrl+C
+httplib::Server* runningServer = nullptr;
+
+void signalHandler(int) {
+    if (runningServer) {
+        runningServer->stop();
+    }
+}
+
+// Function to parse a latency spec: "fixed:MS", "uniform:MIN:MAX" or "lognormal:MEDIAN:SIGMA"
+bool parseLatency(const std::string& spec, LatencyModel& model) {
+    std::vector<std::string> parts;
+    std::stringstream stream(spec);
+    for (std::string part; std::getline(stream, part, ':');) {
+        parts.push_back(part);
+    }
+    if (parts.size() == 2 && parts[0] == "fixed") {
+        model = { LatencyModel::Kind::Fixed, std::stod(parts[1]), 0.0 };
+    } else if (parts.size() == 3 && parts[0] == "uniform") {
+        model = { LatencyModel::Kind::Uniform, std::stod(parts[1]), std::stod(parts[2]) };
+    } else if (parts.size() == 3 && parts[0] == "lognormal") {
+        model = { LatencyModel::Kind::LogNormal, std::stod(parts[1]), std::stod(parts[2]) };
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Function to split a comma-separated query value
+std::vector<std::string> splitList(const std::string& value) {
+    std::vector<std::string> items;
+    std::stringstream stream(value);
+    for (std::string item; std::getline(stream, item, ',');) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+// Deterministic pseudo price for an asset: a slow sine drift plus per-request noise
+double mockPrice(const std::string& id, std::mt19937_64& rng) {
+    const double base = 10.0 + static_cast<double>(std::hash<std::string>{}(id) % 100000);
+    const double seconds = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+    return base * (1.0 + 0.01 * std::sin(seconds / 600.0)) + std::normal_distribution<double>(0.0, base * 0.0005)(rng);
+}
+
+// Deterministic historical price, so overlapping range requests agree
+double historicalPrice(const std::string& id, std::int64_t seconds) {
+    const double base = 10.0 + static_cast<double>(std::hash<std::string>{}(id) % 100000);
+    const double t = static_cast<double>(seconds);
+    return base * (1.0 + 0.05 * std::sin(t / 604800.0) + 0.01 * std::sin(t / 3600.0));
+}
+
+// Per-worker random generator
+std::mt19937_64& threadRng() {
+    thread_local std::mt19937_64 rng(std::random_device{}());
+    return rng;
+}
+
+// Apply latency and fault injection; returns false if the request was answered with an error
+bool injectFaults(const Options& options, httplib::Response& res) {
+    auto& rng = threadRng();
+    const double delay = options.latency.sampleMs(rng);
+    if (delay > 0.0) {
+        std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(delay));
+    }
+    const double roll = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+    if (roll < options.rateLimitRate) {
+        res.status = 429;
+        res.set_content(R"({"status":{"error_code":429,"error_message":"You've exceeded the Rate Limit."}})", "application/json");
+        return false;
+    }
+    if (roll < options.rateLimitRate + options.errorRate) {
+        res.status = 500;
+        res.set_content(R"({"error":"internal server error"})", "application/json");
+        return false;
+    }
+    return true;
+}
+
+// Function to print command-line usage
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --address <addr>            Listen address (default 127.0.0.1)\n"
+              << "  --port <port>               Listen port (default 8089)\n"
+              << "  --latency <spec>            fixed:MS | uniform:MIN:MAX | lognormal:MEDIAN:SIGMA (default fixed:0)\n"
+              << "  --error-rate <p>            Fraction of requests answered with 500 (default 0)\n"
+              << "  --rate-limit-rate <p>       Fraction of requests answered with 429 (default 0)\n"
+              << "  --markets <n>               Default entries per /coins/markets page (default 100)\n"
+              << "  --pad-bytes <n>             Extra description bytes per market entry (default 0)\n"
+              << "  --threads <n>               Server worker threads (default 8)\n";
+}
+
+// Function to parse command-line arguments; returns false if they are invalid
+bool parseArguments(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--address" && hasValue) {
+                options.address = argv[++i];
+            } else if (arg == "--port" && hasValue) {
+                options.port = std::stoi(argv[++i]);
+            } else if (arg == "--latency" && hasValue) {
+                if (!parseLatency(argv[++i], options.latency)) {
+                    return false;
+                }
+            } else if (arg == "--error-rate" && hasValue) {
+                options.errorRate = std::stod(argv[++i]);
+            } else if (arg == "--rate-limit-rate" && hasValue) {
+                options.rateLimitRate = std::stod(argv[++i]);
+            } else if (arg == "--markets" && hasValue) {
+                options.marketsCount = std::stoi(argv[++i]);
+            } else if (arg == "--pad-bytes" && hasValue) {
+                options.padBytes = std::stoi(argv[++i]);
+            } else if (arg == "--threads" && hasValue) {
+                options.threads = std::stoi(argv[++i]);
+            } else {
+                return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return options.threads > 0 && options.marketsCount >= 0 && options.padBytes >= 0;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    httplib::Server server;
+    server.new_task_queue = [&options] { return new httplib::ThreadPool(static_cast<size_t>(options.threads)); };
+    server.set_tcp_nodelay(true);
+    std::atomic<unsigned long long> served{ 0 };
+
+    // {"bitcoin":{"usd":108013.42,"eur":...},...}
+    server.Get("/api/v3/simple/price", [&](const httplib::Request& req, httplib::Response& res) {
+        ++served;
+        if (!injectFaults(options, res)) {
+            return;
+        }
+        const auto ids = splitList(req.get_param_value("ids"));
+        const auto currencies = splitList(req.get_param_value("vs_currencies"));
+        std::string body = "{";
+        char number[32];
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            body += (i ? ",\"" : "\"") + ids[i] + "\":{";
+            for (std::size_t c = 0; c < currencies.size(); ++c) {
+                std::snprintf(number, sizeof(number), "%.2f", mockPrice(ids[i] + currencies[c], threadRng()));
+                body += (c ? ",\"" : "\"") + currencies[c] + "\":" + number;
+            }
+            body += "}";
+        }
+        body += "}";
+        res.set_content(body, "application/json");
+    });
+
+    // [{"id":"coin-0","symbol":"c0","name":"Coin 0","current_price":...},...]
+    server.Get("/api/v3/coins/markets", [&](const httplib::Request& req, httplib::Response& res) {
+        ++served;
+        if (!injectFaults(options, res)) {
+            return;
+        }
+        int perPage = options.marketsCount;
+        int page = 1;
+        try {
+            if (req.has_param("per_page")) { perPage = std::stoi(req.get_param_value("per_page")); }
+            if (req.has_param("page")) { page = std::stoi(req.get_param_value("page")); }
+        } catch (const std::exception&) {
+            res.status = 400;
+            return;
+        }
+        const std::string padding(static_cast<std::size_t>(options.padBytes), 'x');
+        std::string body = "[";
+        body.reserve(static_cast<std::size_t>(perPage) * (320 + padding.size()));
+        char entry[512];
+        for (int i = 0; i < perPage; ++i) {
+            const int rank = (page - 1) * perPage + i + 1;
+            const std::string id = "coin-" + std::to_string(rank);
+            const double price = mockPrice(id, threadRng());
+            std::snprintf(entry, sizeof(entry),
+                          "%s{\"id\":\"%s\",\"symbol\":\"c%d\",\"name\":\"Coin %d\",\"current_price\":%.6f,"
+                          "\"market_cap\":%.0f,\"market_cap_rank\":%d,\"total_volume\":%.0f,\"high_24h\":%.6f,"
+                          "\"low_24h\":%.6f,\"price_change_percentage_24h\":%.4f,\"last_updated\":\"2025-07-05T10:59:00.000Z\"",
+                          i ? "," : "", id.c_str(), rank, rank, price, price * 1.9e7, rank, price * 4.2e5,
+                          price * 1.02, price * 0.98, std::sin(rank) * 3.0);
+            body += entry;
+            if (!padding.empty()) {
+                body += ",\"description\":\"" + padding + "\"";
+            }
+            body += "}";
+        }
+        body += "]";
+        res.set_content(body, "application/json");
+    });
+
+    // {"prices":[[ms,price],...],"market_caps":[...],"total_volumes":[...]}
+    // Granularity follows CoinGecko: 5 minutes up to 1 day, hourly up to 90 days, daily beyond
+    server.Get(R"(/api/v3/coins/([^/]+)/market_chart/range)", [&](const httplib::Request& req, httplib::Response& res) {
+        ++served;
+        if (!injectFaults(options, res)) {
+            return;
+        }
+        std::int64_t from = 0;
+        std::int64_t to = 0;
+        try {
+            from = std::stoll(req.get_param_value("from"));
+            to = std::stoll(req.get_param_value("to"));
+        } catch (const std::exception&) {
+            res.status = 400;
+            return;
+        }
+        const std::string id = req.matches[1].str() + req.get_param_value("vs_currency");
+        const std::int64_t step = to - from <= 86400 ? 300 : (to - from <= 90 * 86400 ? 3600 : 86400);
+        std::string prices;
+        std::string caps;
+        std::string volumes;
+        char entry[96];
+        for (std::int64_t t = (from + step - 1) / step * step; t <= to; t += step) {
+            const double price = historicalPrice(id, t);
+            const char* comma = prices.empty() ? "" : ",";
+            std::snprintf(entry, sizeof(entry), "%s[%lld,%.8f]", comma, static_cast<long long>(t) * 1000, price);
+            prices += entry;
+            std::snprintf(entry, sizeof(entry), "%s[%lld,%.0f]", comma, static_cast<long long>(t) * 1000, price * 1.9e7);
+            caps += entry;
+            std::snprintf(entry, sizeof(entry), "%s[%lld,%.0f]", comma, static_cast<long long>(t) * 1000, price * 4.2e5);
+            volumes += entry;
+        }
+        res.set_content("{\"prices\":[" + prices + "],\"market_caps\":[" + caps + "],\"total_volumes\":[" + volumes + "]}", "application/json");
+    });
+
+    server.Get("/api/v3/ping", [](const httplib::Request&, httplib::Response& res) {
+        res.set_content(R"({"gecko_says":"(V3) To the Moon!"})", "application/json");
+    });
+
+    runningServer = &server;
+    std::signal(SIGINT, signalHandler);
+    std::cout << "CoinGecko mock listening on http://" << options.address << ":" << options.port << " (Ctrl+C to stop)\n";
+    if (!server.listen(options.address, options.port)) {
+        std::cerr << "Error: cannot listen on " << options.address << ":" << options.port << std::endl;
+        return 1;
+    }
+    std::cout << "Served " << served.load() << " requests\n";
+    return 0;
+}